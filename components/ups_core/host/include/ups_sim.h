@@ -0,0 +1,61 @@
+#pragma once
+
+// 主机模拟设备栈：代替 TinyUSB 实现 ups_port.h，并以主机视角发起请求。
+// 只用于 Linux 主机构建，不进入固件。
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 复位模拟器并初始化 ups_core（模拟上电，未枚举）
+void ups_sim_reset(void);
+
+// 模拟枚举完成/断开
+void ups_sim_mount(void);
+void ups_sim_unmount(void);
+
+// 模拟总线挂起/恢复：挂起期间中断IN端点不可用
+void ups_sim_suspend(bool remote_wakeup_en);
+void ups_sim_resume(void);
+
+// 模拟市电检测输入（1 有市电，0 断开，-1 没有输入，恢复60秒模拟切换），变化时投递 UPS_EVENT_AC_GPIO
+void ups_sim_ac_sense(int present);
+
+// 设备发出的远程唤醒次数及最近一次的时刻
+uint32_t ups_sim_remote_wakeups(uint32_t* last_ms);
+
+// 模拟状态任务启动：此后 ups_port_event_wake() 才记下任务通知（与固件写入任务句柄相同）
+void ups_sim_event_start(void);
+
+// 取走任务通知（ulTaskNotifyTake），之前没有通知时返回 false（任务继续阻塞）
+bool ups_sim_event_notify_take(void);
+
+// 模拟时钟（关机编排定时器在到期时刻准时触发）
+void ups_sim_advance_ms(uint32_t ms);
+
+// 实例的负载输出状态及最近一次切换的时刻
+bool ups_sim_output(uint8_t instance, uint32_t* changed_ms);
+
+// 控制传输 GET_REPORT：与 TinyUSB 相同，wLength > 1 时首字节为 Report ID，
+// 返回值为主机收到的总字节数（0 表示 STALL）
+uint16_t ups_sim_get_report(uint8_t report_id, uint8_t report_type, uint8_t* buffer, uint16_t wlength);
+
+// 控制传输 SET_REPORT：buffer 首字节为 Report ID，与 TinyUSB 一样去掉后再交给回调
+void ups_sim_set_report(uint8_t report_id, uint8_t report_type, uint8_t const* buffer, uint16_t wlength);
+
+// 主机轮询中断IN端点：取走一个报告（首字节为 Report ID）并触发完成回调，
+// 端点无数据或总线挂起时返回 0
+uint16_t ups_sim_poll_interrupt(uint8_t* buffer, uint16_t buflen);
+
+// 生成的报告描述符
+const uint8_t* ups_sim_report_descriptor(uint16_t* len);
+
+// 打开/关闭 ups_core 日志输出（压测时关闭）
+void ups_sim_set_log(bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
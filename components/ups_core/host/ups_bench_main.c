@@ -0,0 +1,14 @@
+#include <stdlib.h>
+#include "ups_sim.h"
+#include "ups_bench.h"
+
+// 主机基准测试：ups_bench [轮数]
+int main(int argc, char** argv) {
+    uint32_t rounds = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 100000;
+
+    ups_sim_set_log(false);
+    ups_sim_reset();
+    ups_sim_mount();
+    ups_bench_run(rounds);
+    return 0;
+}
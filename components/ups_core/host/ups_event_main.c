@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ups_port.h"
+#include "ups_sim.h"
+#include "ups_report.h"
+#include "ups_hid.h"
+#include "ups_battery.h"
+#include "ups_event.h"
+#include "ups_state.h"
+
+// 事件驱动调度检查：ups_event_check [小时]
+// 同一段模拟时间（默认2小时，AC 每60秒翻转）分别用三种方式驱动状态任务：
+//   fixed：原来的主循环，100Hz 采样，每2秒或有变化时更新；
+//   event：只在有事件时运行 ups_state_dispatch()，定时器每 UPS_STATE_PUBLISH_MS 投递一次 UPS_EVENT_TICK。
+//          状态任务按固件的方式运行：先取事件，集合为空才阻塞，阻塞后只有任务通知才能唤醒；
+//   early：同 event，但 ADC、存储任务和 USB 回调在状态任务启动（写入句柄）前就投递了事件，这些唤醒被丢弃。
+// 主机每毫秒轮询中断端点，并在规定时刻枚举、写入和取消 DelayBeforeShutdown。
+// 输出两种方式的唤醒次数、状态任务占用的CPU时间、写入到 ShutdownRequested 可读的延迟，以及结束时的电池状态。
+// ups_state 的全局变量没有复位接口，每种方式在单独的子进程中从上电开始运行。
+// event 的唤醒次数不到 fixed 的1/10、延迟不大于 fixed、AC 切换次数相同、剩余容量相差不超过1%，
+// 且 early 与 event 的唤醒次数和结果相同时返回0
+
+#define MOUNT_MS     1234
+#define SET_MS       300007
+#define CANCEL_MS    330011
+
+#define BIT_REQUESTED (1u << 10)
+
+typedef enum {
+    RUN_FIXED,
+    RUN_EVENT,
+    RUN_EARLY,
+} run_mode_t;
+
+static const char* const run_names[] = { "fixed", "event", "early" };
+
+typedef struct {
+    uint32_t wakeups;
+    uint64_t busy_ns;
+    uint32_t set_to_status_ms;
+    uint32_t ac_changes;
+    uint8_t capacity;
+    uint32_t remaining_mah;
+} run_result_t;
+
+static void set_delay(uint8_t report_id, int16_t seconds) {
+    uint8_t buf[3] = { report_id, (uint8_t)seconds, (uint8_t)((uint16_t)seconds >> 8) };
+    ups_sim_set_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+}
+
+static uint16_t get_status(void) {
+    uint8_t buf[3] = { 0 };
+    ups_sim_get_report(HID_PD_PRESENTSTATUS, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+    return (uint16_t)(buf[1] | buf[2] << 8);
+}
+
+// 与 ups_event_esp.c 的 state_task 相同：阻塞中的任务只有收到通知才运行，
+// 运行时反复取事件处理，集合为空才回到阻塞
+static void state_task_run(run_result_t* r, bool* blocked, uint32_t c0) {
+    if (*blocked && !ups_sim_event_notify_take()) {
+        return;
+    }
+    *blocked = false;
+    for (;;) {
+        uint32_t events = ups_event_take();
+        if (events == 0) {
+            *blocked = !ups_sim_event_notify_take();
+            if (*blocked) {
+                return;
+            }
+            continue;
+        }
+        ups_state_dispatch(events);
+        r->wakeups++;
+        r->busy_ns += ups_port_cycles() - c0;
+    }
+}
+
+static void run(run_mode_t mode, uint32_t duration_ms, run_result_t* r) {
+    uint32_t ticks = UPS_BATTERY_SAMPLE_HZ * 2 - 1;
+    uint32_t status_ms = 0;
+    bool ac = true;
+    bool blocked = false;
+    uint8_t buf[1 + UPS_REPORT_MAX_LEN];
+
+    ups_sim_reset();
+    *r = (run_result_t){ 0 };
+    if (mode == RUN_EARLY) {
+        // 状态任务启动前：ADC 数据块、持久化参数加载完成、枚举完成
+        ups_event_post(UPS_EVENT_SAMPLE);
+        ups_event_post(UPS_EVENT_STORE);
+        ups_event_post(UPS_EVENT_USB);
+    }
+    if (mode != RUN_FIXED) {
+        ups_sim_event_start();
+        ups_event_post(UPS_EVENT_TICK);     // 任务启动时先发布一次
+    }
+
+    for (uint32_t t = 1; t <= duration_ms; t++) {
+        ups_sim_advance_ms(1);
+
+        if (t == MOUNT_MS) {
+            ups_sim_mount();
+        } else if (t == SET_MS) {
+            set_delay(HID_PD_DELAYBE4SHUTDOWN, 60);
+        } else if (t == CANCEL_MS) {
+            set_delay(HID_PD_DELAYBE4SHUTDOWN, -1);
+        }
+
+        uint32_t c0 = ups_port_cycles();
+        if (mode != RUN_FIXED) {
+            if (t % UPS_STATE_PUBLISH_MS == 0) {
+                ups_event_post(UPS_EVENT_TICK);
+            }
+            state_task_run(r, &blocked, c0);
+        } else if (t % (1000 / UPS_BATTERY_SAMPLE_HZ) == 0) {
+            bool urgent = ups_state_sample();
+            if (urgent || ++ticks >= UPS_BATTERY_SAMPLE_HZ * 2) {
+                ups_state_update();
+                ticks = 0;
+            }
+            r->wakeups++;
+            r->busy_ns += ups_port_cycles() - c0;
+        }
+
+        // 主机侧
+        if (t >= MOUNT_MS) {
+            ups_sim_poll_interrupt(buf, sizeof(buf));
+        }
+        if (t >= SET_MS && status_ms == 0 && (get_status() & BIT_REQUESTED)) {
+            status_ms = t;
+        }
+        if (UPS.ACPresent != ac) {
+            ac = UPS.ACPresent;
+            r->ac_changes++;
+        }
+    }
+
+    ups_battery_status_t battery;
+    ups_battery_get_status(0, &battery);
+    r->set_to_status_ms = status_ms - SET_MS;
+    r->capacity = battery.remaining_capacity;
+    r->remaining_mah = battery.remaining_mah;
+}
+
+static void print_result(const char* name, const run_result_t* r, uint32_t hours) {
+    printf("%-6s %8u wakeups/h  %8.1f ms cpu/h  set->status %3u ms  %3u ac changes  capacity %3u%% (%u mAh)\n",
+           name, (unsigned)(r->wakeups / hours), r->busy_ns / 1e6 / hours, (unsigned)r->set_to_status_ms,
+           (unsigned)r->ac_changes, r->capacity, (unsigned)r->remaining_mah);
+}
+
+// 在子进程中运行，结果经管道带回；事件驱动方式同时输出各类事件的投递到发布延迟（模拟时钟，同一毫秒内处理为0）
+static bool run_child(run_mode_t mode, uint32_t duration_ms, run_result_t* r) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        run(mode, duration_ms, r);
+        for (int e = 0; mode == RUN_EVENT && e < UPS_EVENT_COUNT; e++) {
+            ups_event_stats_t stats;
+            ups_event_get_stats((ups_event_t)e, &stats);
+            if (stats.count != 0) {
+                printf("  %-8s %6u published, event->publish mean %u us, max %u us\n",
+                       ups_event_name((ups_event_t)e), (unsigned)stats.count,
+                       (unsigned)(stats.total_us / stats.count), (unsigned)stats.max_us);
+            }
+        }
+        fflush(stdout);
+        _exit(write(fds[1], r, sizeof(*r)) == (ssize_t)sizeof(*r) ? 0 : 1);
+    }
+    close(fds[1]);
+    bool ok = pid > 0 && read(fds[0], r, sizeof(*r)) == (ssize_t)sizeof(*r);
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t hours = argc > 1 ? (uint32_t)atoi(argv[1]) : 2;
+    if (hours == 0) {
+        hours = 1;
+    }
+    ups_sim_set_log(false);
+
+    run_result_t results[3];
+    for (int m = RUN_FIXED; m <= RUN_EARLY; m++) {
+        if (!run_child((run_mode_t)m, hours * 3600000, &results[m])) {
+            printf("FAIL\n");
+            return 1;
+        }
+    }
+    for (int m = RUN_FIXED; m <= RUN_EARLY; m++) {
+        print_result(run_names[m], &results[m], hours);
+    }
+    const run_result_t fixed = results[RUN_FIXED], event = results[RUN_EVENT], early = results[RUN_EARLY];
+
+    int diff = (int)event.capacity - (int)fixed.capacity;
+    bool ok = event.wakeups * 10 < fixed.wakeups &&
+              event.set_to_status_ms <= fixed.set_to_status_ms &&
+              diff >= -1 && diff <= 1 && event.ac_changes == fixed.ac_changes &&
+              early.wakeups == event.wakeups && early.ac_changes == event.ac_changes &&
+              early.set_to_status_ms == event.set_to_status_ms && early.capacity == event.capacity;
+    printf("%s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "ups_sim.h"
+#include "ups_battery.h"
+#include "ups_history.h"
+#include "ups_journal.h"
+#include "ups_export.h"
+
+// 遥测导出工具（Linux）：
+//   ups_export decode <文件|->                解码导出流，历史点和事件日志按 CSV 输出
+//   ups_export capture <tty> [H|J|A] [输出文件] 向 CDC 控制台（/dev/ttyACM*）发送 export 命令，接收并解码
+//   ups_export check [输出文件]               合成历史和事件日志，导出后解码逐项核对，输出压缩率和编码速度
+
+// ==================== 解码 ====================
+
+typedef struct {
+    void (*point)(void* ctx, uint8_t tier, uint32_t period_s, uint32_t index, const ups_history_point_t* p);
+    void (*record)(void* ctx, const ups_journal_record_t* r);
+    void* ctx;
+} decode_sink_t;
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    const uint8_t* section;
+    int error;
+} decode_t;
+
+static uint8_t decode_byte(decode_t* d) {
+    if (d->p >= d->end) {
+        d->error = 1;
+        return 0;
+    }
+    return *d->p++;
+}
+
+static uint32_t decode_varint(decode_t* d) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35 && !d->error; shift += 7) {
+        uint8_t b = decode_byte(d);
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return v;
+        }
+    }
+    d->error = 1;
+    return 0;
+}
+
+static int32_t decode_zigzag(decode_t* d) {
+    uint32_t v = decode_varint(d);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// 段结束：核对从段类型字节到结束标记的 CRC
+static void decode_crc(decode_t* d) {
+    uint16_t crc = ups_journal_crc16(d->section, (size_t)(d->p - d->section));
+    uint16_t got = decode_byte(d);
+    got |= (uint16_t)decode_byte(d) << 8;
+    if (!d->error && got != crc) {
+        fprintf(stderr, "section '%c' CRC mismatch\n", *d->section);
+        d->error = 1;
+    }
+}
+
+static void decode_history(decode_t* d, const decode_sink_t* sink) {
+    uint8_t tier = decode_byte(d);
+    uint32_t period = decode_varint(d);
+    uint32_t index = decode_varint(d) - 1;
+    ups_history_point_t p = { 0 };
+
+    while (!d->error) {
+        uint32_t step = decode_varint(d);
+        if (step == 0) {
+            break;
+        }
+        index += step;
+        p.battery_mv_mean = (uint16_t)(p.battery_mv_mean + decode_zigzag(d));
+        p.battery_mv_min = (uint16_t)(p.battery_mv_mean - decode_varint(d));
+        p.battery_mv_max = (uint16_t)(p.battery_mv_mean + decode_varint(d));
+        p.load_ma_mean = (uint16_t)(p.load_ma_mean + decode_zigzag(d));
+        p.load_ma_min = (uint16_t)(p.load_ma_mean - decode_varint(d));
+        p.load_ma_max = (uint16_t)(p.load_ma_mean + decode_varint(d));
+        p.battery_ma_mean = (int16_t)(p.battery_ma_mean + decode_zigzag(d));
+        p.mains_dv_mean = (uint16_t)(p.mains_dv_mean + decode_zigzag(d));
+        p.status ^= (uint16_t)decode_varint(d);
+        if (!d->error && sink->point) {
+            sink->point(sink->ctx, tier, period, index, &p);
+        }
+    }
+    decode_crc(d);
+}
+
+static void decode_journal(decode_t* d, const decode_sink_t* sink) {
+    ups_journal_record_t r = { 0 };
+
+    while (!d->error) {
+        uint32_t step = decode_varint(d);
+        if (step == 0) {
+            break;
+        }
+        r.seq += step;
+        r.time_ms += (uint32_t)decode_zigzag(d);
+        r.event = decode_byte(d);
+        r.detail = decode_byte(d);
+        r.status ^= (uint16_t)decode_varint(d);
+        r.battery_mv = (uint16_t)(r.battery_mv + decode_zigzag(d));
+        if (!d->error && sink->record) {
+            sink->record(sink->ctx, &r);
+        }
+    }
+    decode_crc(d);
+}
+
+// 返回 0 表示完整解码到结束标记
+static int export_decode(const uint8_t* buf, size_t len, const decode_sink_t* sink) {
+    decode_t d = { buf, buf + len, buf, 0 };
+
+    if (len < 7 || memcmp(buf, "UPSX", 4) != 0 || buf[4] != UPS_EXPORT_VERSION) {
+        fprintf(stderr, "not an export stream (version %u expected)\n", UPS_EXPORT_VERSION);
+        return 1;
+    }
+    d.p = buf + 7;
+    while (!d.error) {
+        d.section = d.p;
+        uint8_t type = decode_byte(&d);
+        if (type == 'H') {
+            decode_history(&d, sink);
+        } else if (type == 'J') {
+            decode_journal(&d, sink);
+        } else if (type == 'E') {
+            return 0;
+        } else {
+            d.error = 1;
+        }
+    }
+    fprintf(stderr, "stream truncated or corrupt at byte %u\n", (unsigned)(d.section - buf));
+    return 1;
+}
+
+// ==================== decode / capture ====================
+
+static void print_point(void* ctx, uint8_t tier, uint32_t period_s, uint32_t index, const ups_history_point_t* p) {
+    (void)ctx;
+    printf("H,%u,%llu,%u,%u,%u,%u,%u,%u,%d,%u,0x%04X\n", tier, (unsigned long long)index * period_s,
+           p->battery_mv_min, p->battery_mv_mean, p->battery_mv_max, p->load_ma_min, p->load_ma_mean,
+           p->load_ma_max, p->battery_ma_mean, p->mains_dv_mean, p->status);
+}
+
+static void print_record(void* ctx, const ups_journal_record_t* r) {
+    char line[112];
+    (void)ctx;
+    ups_journal_format(r, line, sizeof(line));
+    printf("J,%s\n", line);
+}
+
+static const decode_sink_t print_sink = { print_point, print_record, NULL };
+
+static int export_print(const uint8_t* buf, size_t len) {
+    printf("# H,tier,start_s,mv_min,mv_mean,mv_max,load_min,load_mean,load_max,battery_ma,mains_dv,status\n");
+    return export_decode(buf, len, &print_sink);
+}
+
+static uint8_t* read_all(FILE* file, size_t* len) {
+    size_t cap = 1 << 16;
+    uint8_t* buf = malloc(cap);
+    *len = 0;
+    size_t n;
+    while ((n = fread(buf + *len, 1, cap - *len, file)) > 0) {
+        *len += n;
+        if (*len == cap) {
+            buf = realloc(buf, cap *= 2);
+        }
+    }
+    return buf;
+}
+
+static int cmd_decode(const char* path) {
+    FILE* file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    size_t len;
+    uint8_t* buf = read_all(file, &len);
+    if (file != stdin) {
+        fclose(file);
+    }
+    int ret = export_print(buf, len);
+    free(buf);
+    return ret;
+}
+
+// CDC-ACM 按原始模式打开，先发送 Ctrl-C 清掉控制台的残留输入和输出并丢弃回应，
+// 再发送 export 命令，接收到 0.5 秒内没有新数据为止
+static int cmd_capture(const char* tty, uint8_t command, const char* out) {
+    int fd = open(tty, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(tty);
+        return 1;
+    }
+    struct termios t;
+    tcgetattr(fd, &t);
+    cfmakeraw(&t);
+    t.c_cc[VMIN] = 0;
+    t.c_cc[VTIME] = 5;
+    tcsetattr(fd, TCSANOW, &t);
+    char request[16];
+    int request_len = snprintf(request, sizeof(request), "export %c\r", command);
+    uint8_t discard[256];
+    if (write(fd, "\003", 1) != 1) {
+        perror("write");
+        close(fd);
+        return 1;
+    }
+    while (read(fd, discard, sizeof(discard)) > 0) {
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    t1 = t0;
+    if (write(fd, request, (size_t)request_len) != request_len) {
+        perror("write");
+        close(fd);
+        return 1;
+    }
+    size_t cap = 1 << 16, len = 0;
+    uint8_t* buf = malloc(cap);
+    ssize_t n;
+    while ((n = read(fd, buf + len, cap - len)) > 0) {
+        len += (size_t)n;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (len == cap) {
+            buf = realloc(buf, cap *= 2);
+        }
+    }
+    close(fd);
+
+    double s = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (len == 0) {
+        fprintf(stderr, "no data from %s\n", tty);
+        free(buf);
+        return 1;
+    }
+    fprintf(stderr, "%u bytes in %.3f s (%.0f KB/s)\n", (unsigned)len, s, len / s / 1024);
+    if (out != NULL) {
+        FILE* file = fopen(out, "wb");
+        if (file == NULL || fwrite(buf, 1, len, file) != len) {
+            perror(out);
+        }
+        if (file != NULL) {
+            fclose(file);
+        }
+    }
+    uint8_t* start = memmem(buf, len, "UPSX", 4);
+    int ret = start != NULL ? export_print(start, len - (size_t)(start - buf)) : export_print(buf, len);
+    free(buf);
+    return ret;
+}
+
+// ==================== check ====================
+
+#define CHECK_SECTORS 8
+
+static uint8_t check_flash_mem[CHECK_SECTORS * UPS_JOURNAL_SECTOR_SIZE];
+
+static bool check_read(uint32_t offset, void* buffer, uint32_t len) {
+    memcpy(buffer, check_flash_mem + offset, len);
+    return true;
+}
+
+static bool check_write(uint32_t offset, const void* data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        check_flash_mem[offset + i] &= ((const uint8_t*)data)[i];
+    }
+    return true;
+}
+
+static bool check_erase(uint32_t offset) {
+    memset(check_flash_mem + offset, 0xFF, UPS_JOURNAL_SECTOR_SIZE);
+    return true;
+}
+
+static const ups_journal_flash_t check_flash = {
+    .size = sizeof(check_flash_mem),
+    .read = check_read,
+    .write = check_write,
+    .erase_sector = check_erase,
+};
+
+typedef struct {
+    uint32_t points;
+    uint32_t records;
+    uint32_t errors;
+} check_t;
+
+static void check_point(void* ctx, uint8_t tier, uint32_t period_s, uint32_t index, const ups_history_point_t* p) {
+    check_t* c = ctx;
+    ups_history_point_t want;
+    (void)period_s;
+    if (!ups_history_get((ups_history_tier_t)tier, index, &want) || memcmp(&want, p, sizeof(want)) != 0) {
+        if (c->errors++ < 5) {
+            printf("FAIL tier %u point %u\n", tier, (unsigned)index);
+        }
+    }
+    c->points++;
+}
+
+static void check_record(void* ctx, const ups_journal_record_t* r) {
+    check_t* c = ctx;
+    ups_journal_cursor_t cursor;
+    ups_journal_record_t want;
+    bool found = false;
+    // 逐条核对：按序号在闪存中查找（记录数少，线性查找即可）
+    ups_journal_begin(&cursor);
+    while (ups_journal_next(&cursor, &want)) {
+        if (want.seq == r->seq) {
+            found = want.time_ms == r->time_ms && want.event == r->event && want.detail == r->detail &&
+                    want.status == r->status && want.battery_mv == r->battery_mv;
+            break;
+        }
+    }
+    if (!found && c->errors++ < 5) {
+        printf("FAIL journal record %u\n", (unsigned)r->seq);
+    }
+    c->records++;
+}
+
+static int cmd_check(const char* out) {
+    ups_history_sample_t s;
+    uint32_t samples = 2 * 86400 * UPS_BATTERY_SAMPLE_HZ;
+
+    // 两天的合成采样：电压缓慢放电/充电、负载随机波动，偶尔断电
+    ups_sim_set_log(false);
+    ups_history_init();
+    srand(1);
+    for (uint32_t n = 0; n < samples; n++) {
+        uint32_t t = n / UPS_BATTERY_SAMPLE_HZ;
+        bool outage = t % 7200 < 600;
+        s.battery_mv = (uint16_t)(outage ? 12800 - (int)(t % 7200) : 13500 + rand() % 20);
+        s.battery_ma = (int16_t)(outage ? -1500 - rand() % 200 : 200);
+        s.load_ma = (uint16_t)(1500 + rand() % 200);
+        s.mains_dv = (uint16_t)(outage ? 0 : 2295 + rand() % 10);
+        s.status = outage ? 0x0012 : 0x000D;
+        ups_history_sample(&s);
+    }
+
+    // 事件日志：写满后绕回
+    memset(check_flash_mem, 0xFF, sizeof(check_flash_mem));
+    ups_journal_init();
+    ups_journal_mount(&check_flash);
+    for (uint32_t i = 0; i < 3000; i++) {
+        ups_sim_advance_ms(1000 + rand() % 60000);
+        ups_journal_post(UPS_JOURNAL_STATUS, (uint8_t)(2 | (i & 1 ? UPS_JOURNAL_STATUS_SET : 0)),
+                         (uint16_t)(i & 1 ? 0x000D : 0x0012), (uint16_t)(12000 + rand() % 1500));
+        ups_journal_flush();
+    }
+
+    // 导出（随机块长，模拟 USB FIFO 可用空间变化）
+    ups_export_t x;
+    size_t cap = 1 << 20, len = 0, n;
+    uint8_t* buf = malloc(cap);
+    struct timespec t0, t1;
+    ups_export_begin(&x, ups_export_command(UPS_EXPORT_CMD_ALL));
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while ((n = ups_export_read(&x, buf + len, 1 + rand() % 512)) > 0) {
+        len += n;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double us = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+
+    check_t c = { 0 };
+    decode_sink_t sink = { check_point, check_record, &c };
+    int ret = export_decode(buf, len, &sink);
+
+    uint32_t expect_points = 0;
+    for (int t = 0; t < UPS_HISTORY_TIERS; t++) {
+        expect_points += ups_history_count((ups_history_tier_t)t);
+    }
+    uint32_t expect_records = ups_journal_next_seq() - 1 < ups_journal_capacity() ? ups_journal_next_seq() - 1 : 0;
+    if (c.points != expect_points || (expect_records && c.records != expect_records) || c.records == 0) {
+        printf("FAIL %u points (expected %u), %u records\n", (unsigned)c.points, (unsigned)expect_points,
+               (unsigned)c.records);
+        c.errors++;
+    }
+    size_t raw = c.points * sizeof(ups_history_point_t) + c.records * sizeof(ups_journal_record_t);
+    printf("%u points + %u records: %u bytes (raw %u, %.2fx), encode %.0f us (%.1f ns/byte)\n",
+           (unsigned)c.points, (unsigned)c.records, (unsigned)len, (unsigned)raw, (double)raw / len, us,
+           us * 1000 / len);
+    printf("%s\n", ret || c.errors ? "FAIL" : "ok");
+    if (out != NULL) {
+        FILE* file = fopen(out, "wb");
+        if (file == NULL || fwrite(buf, 1, len, file) != len) {
+            perror(out);
+        }
+        if (file != NULL) {
+            fclose(file);
+        }
+    }
+    free(buf);
+    return ret || c.errors ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "decode") == 0) {
+        return cmd_decode(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "capture") == 0) {
+        uint8_t command = argc > 3 ? (uint8_t)argv[3][0] : UPS_EXPORT_CMD_ALL;
+        if (ups_export_command(command) == 0) {
+            fprintf(stderr, "command must be H, J or A\n");
+            return 1;
+        }
+        return cmd_capture(argv[2], command, argc > 4 ? argv[4] : NULL);
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check(argc > 2 ? argv[2] : NULL);
+    }
+    fprintf(stderr, "usage: %s decode <file|->\n"
+                    "       %s capture <tty> [H|J|A] [out.bin]\n"
+                    "       %s check [out.bin]\n", argv[0], argv[0], argv[0]);
+    return 1;
+}
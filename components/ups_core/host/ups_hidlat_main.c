@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <linux/hidraw.h>
+#include "ups_report.h"
+
+// CDC 满负载下的 HID 延迟（Linux，连接真实设备）：
+//   ups_hidlat <hidraw> <tty> [轮数] [报告ID]
+// 先在 CDC 空闲时连续读 Feature 报告（GET_REPORT 控制传输，默认 RemainingCapacity），
+// 再让控制台 flood 输出并由另一线程全速读取 CDC，同时重复同样的读取。
+// 输出两种情况下往返延迟的 p50/p99/max 和负载期间的 CDC 吞吐；
+// 负载下 p99 比空闲时多出 2ms（两个 USB 帧）以上时返回非零
+
+#define FLOOD_KB     16384          // 远多于测量期间能发送的量，测完后用 Ctrl-C 停止
+#define MARGIN_US    2000
+
+static atomic_bool reader_stop;
+static atomic_ulong reader_bytes;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// 返回 p99，出错返回 UINT32_MAX
+static uint32_t measure(int hid, uint8_t report_id, uint32_t rounds, const char* name) {
+    uint32_t* lat = malloc(rounds * sizeof(uint32_t));
+    uint8_t buf[64];
+
+    for (uint32_t i = 0; i < rounds; i++) {
+        buf[0] = report_id;
+        uint64_t t0 = now_us();
+        if (ioctl(hid, HIDIOCGFEATURE(sizeof(buf)), buf) < 0) {
+            perror("HIDIOCGFEATURE");
+            free(lat);
+            return UINT32_MAX;
+        }
+        lat[i] = (uint32_t)(now_us() - t0);
+    }
+    qsort(lat, rounds, sizeof(uint32_t), cmp_u32);
+    uint32_t p99 = lat[rounds * 99 / 100];
+    printf("%-6s %6u reads  p50 %5u us  p99 %5u us  max %6u us\n", name, (unsigned)rounds,
+           (unsigned)lat[rounds / 2], (unsigned)p99, (unsigned)lat[rounds - 1]);
+    free(lat);
+    return p99;
+}
+
+static void* reader(void* arg) {
+    int fd = *(int*)arg;
+    uint8_t buf[4096];
+    ssize_t n;
+    while (!atomic_load(&reader_stop)) {
+        n = read(fd, buf, sizeof(buf));
+        if (n > 0) {
+            atomic_fetch_add(&reader_bytes, (unsigned long)n);
+        }
+    }
+    return NULL;
+}
+
+static void tty_drain(int fd) {
+    uint8_t buf[4096];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <hidraw> <tty> [rounds] [report_id]\n", argv[0]);
+        return 1;
+    }
+    uint32_t rounds = argc > 3 ? (uint32_t)atoi(argv[3]) : 2000;
+    uint8_t report_id = argc > 4 ? (uint8_t)strtoul(argv[4], NULL, 0) : HID_PD_REMAININGCAPACITY;
+    if (rounds < 100) {
+        rounds = 100;
+    }
+
+    int hid = open(argv[1], O_RDWR);
+    if (hid < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    int tty = open(argv[2], O_RDWR | O_NOCTTY);
+    if (tty < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    struct termios t;
+    tcgetattr(tty, &t);
+    cfmakeraw(&t);
+    t.c_cc[VMIN] = 0;
+    t.c_cc[VTIME] = 2;
+    tcsetattr(tty, TCSANOW, &t);
+
+    // 控制台回到空闲
+    if (write(tty, "\003", 1) != 1) {
+        perror("write");
+        return 1;
+    }
+    tty_drain(tty);
+
+    uint32_t idle = measure(hid, report_id, rounds, "idle");
+
+    char cmd[32];
+    int cmd_len = snprintf(cmd, sizeof(cmd), "flood %u\r", FLOOD_KB);
+    pthread_t thread;
+    pthread_create(&thread, NULL, reader, &tty);
+    if (write(tty, cmd, (size_t)cmd_len) != cmd_len) {
+        perror("write");
+        return 1;
+    }
+    usleep(200000);                 // 等 CDC 达到满速
+    unsigned long bytes0 = atomic_load(&reader_bytes);
+    uint64_t t0 = now_us();
+    uint32_t loaded = measure(hid, report_id, rounds, "cdc");
+    double s = (now_us() - t0) / 1e6;
+    unsigned long bytes = atomic_load(&reader_bytes) - bytes0;
+
+    if (write(tty, "\003", 1) != 1) {
+        perror("write");
+    }
+    atomic_store(&reader_stop, true);
+    pthread_join(thread, NULL);
+    tty_drain(tty);
+    close(tty);
+    close(hid);
+
+    printf("cdc load: %lu bytes in %.2f s (%.0f KB/s)\n", bytes, s, bytes / s / 1024);
+    if (idle == UINT32_MAX || loaded == UINT32_MAX || bytes == 0) {
+        printf("FAIL\n");
+        return 1;
+    }
+    bool ok = loaded <= idle + MARGIN_US;
+    printf("%s: p99 under CDC load %+d us vs idle\n", ok ? "ok" : "FAIL", (int)loaded - (int)idle);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ups_battery.h"
+#include "ups_history.h"
+
+// 遥测历史检查：ups_history_check [天数]
+// 按 UPS_BATTERY_SAMPLE_HZ 输入确定性的合成采样（默认31天，各级环形缓冲都会绕回），
+// 再用原始采样逐点重新计算 min/max/mean 与各级缓冲比较；任何不一致返回非零。
+// 输出内存占用和每个采样的平均插入时间
+
+#define HZ UPS_BATTERY_SAMPLE_HZ
+
+// 合成采样：电压带尖峰、负载阶梯、电流充放电往复、市电小幅波动
+static void history_synth(uint64_t n, ups_history_sample_t* s) {
+    s->battery_mv = (uint16_t)(12000 + (n * 7919) % 1000 + (n % 4999 == 0 ? 1500 : 0));
+    s->battery_ma = (int16_t)((int64_t)(n % 3000) - 1500);
+    s->load_ma = (uint16_t)(1000 + (n / 37) % 500);
+    s->mains_dv = (uint16_t)(2300 + n % 7);
+    s->status = (uint16_t)(n / HZ);
+}
+
+static int64_t history_round(int64_t sum, int64_t n) {
+    return sum >= 0 ? (sum + n / 2) / n : (sum - n / 2) / n;
+}
+
+// 用原始采样重新计算第 index 个点
+static void history_expect(uint32_t period_s, uint32_t index, ups_history_point_t* p) {
+    uint64_t first = (uint64_t)index * period_s * HZ;
+    uint64_t count = (uint64_t)period_s * HZ;
+    int64_t mv = 0, load = 0, ma = 0, mains = 0;
+    ups_history_sample_t s;
+
+    p->battery_mv_min = p->load_ma_min = UINT16_MAX;
+    p->battery_mv_max = p->load_ma_max = 0;
+    p->status = 0;
+    for (uint64_t n = first; n < first + count; n++) {
+        history_synth(n, &s);
+        mv += s.battery_mv;
+        load += s.load_ma;
+        ma += s.battery_ma;
+        mains += s.mains_dv;
+        if (s.battery_mv < p->battery_mv_min) p->battery_mv_min = s.battery_mv;
+        if (s.battery_mv > p->battery_mv_max) p->battery_mv_max = s.battery_mv;
+        if (s.load_ma < p->load_ma_min) p->load_ma_min = s.load_ma;
+        if (s.load_ma > p->load_ma_max) p->load_ma_max = s.load_ma;
+        p->status = s.status;
+    }
+    p->battery_mv_mean = (uint16_t)history_round(mv, count);
+    p->load_ma_mean = (uint16_t)history_round(load, count);
+    p->battery_ma_mean = (int16_t)history_round(ma, count);
+    p->mains_dv_mean = (uint16_t)history_round(mains, count);
+}
+
+static int history_equal(const ups_history_point_t* a, const ups_history_point_t* b) {
+    return a->battery_mv_min == b->battery_mv_min && a->battery_mv_max == b->battery_mv_max &&
+           a->battery_mv_mean == b->battery_mv_mean && a->load_ma_min == b->load_ma_min &&
+           a->load_ma_max == b->load_ma_max && a->load_ma_mean == b->load_ma_mean &&
+           a->battery_ma_mean == b->battery_ma_mean && a->mains_dv_mean == b->mains_dv_mean &&
+           a->status == b->status;
+}
+
+// 检查一级：可读点数、越界读取，以及每 step 个点中的一个（和最新的点）
+static int history_check_tier(ups_history_tier_t tier, uint64_t samples, uint32_t points, uint32_t step) {
+    uint32_t period = ups_history_period_s(tier);
+    uint32_t written = ups_history_written(tier);
+    uint32_t count = ups_history_count(tier);
+    uint32_t expect_written = (uint32_t)(samples / ((uint64_t)period * HZ));
+    uint32_t expect_count = expect_written < points ? expect_written : points;
+    int errors = 0;
+    ups_history_point_t got, want;
+
+    if (written != expect_written || count != expect_count) {
+        printf("FAIL tier %us: written %u count %u, expected %u %u\n", (unsigned)period,
+               (unsigned)written, (unsigned)count, (unsigned)expect_written, (unsigned)expect_count);
+        return 1;
+    }
+    if (ups_history_get(tier, written, &got) || (written > count && ups_history_get(tier, written - count - 1, &got))) {
+        printf("FAIL tier %us: out-of-range read succeeded\n", (unsigned)period);
+        errors++;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index = written - count + i;
+        if (i % step != 0 && i != count - 1) {
+            continue;
+        }
+        history_expect(period, index, &want);
+        if (!ups_history_get(tier, index, &got) || !history_equal(&got, &want)) {
+            if (errors++ < 5) {
+                printf("FAIL tier %us point %u: mv %u/%u/%u load %u/%u/%u, expected mv %u/%u/%u load %u/%u/%u\n",
+                       (unsigned)period, (unsigned)index, got.battery_mv_min, got.battery_mv_mean, got.battery_mv_max,
+                       got.load_ma_min, got.load_ma_mean, got.load_ma_max, want.battery_mv_min, want.battery_mv_mean,
+                       want.battery_mv_max, want.load_ma_min, want.load_ma_mean, want.load_ma_max);
+            }
+        }
+    }
+    printf("tier %5us: %4u points, %u written, %s\n", (unsigned)period, (unsigned)count, (unsigned)written,
+           errors ? "FAIL" : "ok");
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    uint32_t days = argc > 1 ? (uint32_t)atoi(argv[1]) : 31;
+    uint64_t samples = (uint64_t)days * 86400 * HZ;
+    ups_history_sample_t s;
+    struct timespec t0, t1;
+
+    ups_history_init();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint64_t n = 0; n < samples; n++) {
+        history_synth(n, &s);
+        ups_history_sample(&s);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ns = samples ? ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / samples : 0;
+
+    printf("memory: %u bytes (%u-byte points), %u days at %u Hz, %.1f ns/sample (incl. synth)\n",
+           (unsigned)UPS_HISTORY_BYTES, (unsigned)sizeof(ups_history_point_t), (unsigned)days, HZ, ns);
+
+    int errors = 0;
+    errors += history_check_tier(UPS_HISTORY_1S, samples, UPS_HISTORY_1S_POINTS, 1);
+    errors += history_check_tier(UPS_HISTORY_1MIN, samples, UPS_HISTORY_1MIN_POINTS, 1);
+    errors += history_check_tier(UPS_HISTORY_15MIN, samples, UPS_HISTORY_15MIN_POINTS, 16);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include "ups_port.h"
+#include "ups_sim.h"
+#include "ups_report.h"
+#include "ups_report_schema.h"
+#include "ups_hid.h"
+#include "ups_event.h"
+#include "ups_state.h"
+
+// 多实例检查：ups_instance_check（用 UPS_INSTANCE_COUNT=2 构建的 ups_core_multi）
+//   descriptor：每个实例一个 UPS 应用集合，实例1的报告ID为实例0的加 0x40，没有重复；
+//   values：市电断开放电10分钟，两个实例的电量和运行时间按各自的负载独立变化；
+//   shutdown：只给实例1写 DelayBeforeShutdown，到时只关闭实例1的输出和状态位；
+//   interrupt：枚举后中断端点推送两个实例的 PresentStatus，之后变化的报告也带各自的ID。
+// 全部符合时返回0
+
+#define HOST_POLL_MS        10
+#define DISCHARGE_MS        600000
+#define SHUTDOWN_DELAY_S    20
+
+#define BIT_SHUTDOWN_REQUESTED  (1u << 10)
+#define BIT_SHUTDOWN_IMMINENT   (1u << 11)
+
+static int errors;
+
+static void expect(const char* what, bool ok) {
+    printf("%-46s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        errors++;
+    }
+}
+
+// 主机读到的每个报告ID
+static uint32_t interrupt_seen[256];
+
+// 推进时钟并运行状态任务，枚举后按 bInterval 轮询中断端点
+static void run_ms(uint32_t ms) {
+    uint8_t buf[1 + UPS_REPORT_MAX_LEN];
+
+    for (uint32_t i = 0; i < ms; i++) {
+        ups_sim_advance_ms(1);
+        uint32_t now = ups_port_millis();
+        if (now % UPS_STATE_PUBLISH_MS == 0) {
+            ups_event_post(UPS_EVENT_TICK);
+        }
+        uint32_t events = ups_event_take();
+        if (events != 0) {
+            ups_state_dispatch(events);
+        }
+        if (now % HOST_POLL_MS == 0) {
+            while (ups_sim_poll_interrupt(buf, sizeof(buf)) != 0) {
+                interrupt_seen[buf[0]]++;
+            }
+        }
+    }
+}
+
+static uint32_t get_value(uint8_t report_id) {
+    uint8_t buf[1 + UPS_REPORT_MAX_LEN] = { 0 };
+    uint16_t len = ups_sim_get_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+    return len < 2 ? UINT32_MAX : buf[1] | (len > 2 ? (uint32_t)buf[2] << 8 : 0);
+}
+
+static void set_delay(uint8_t report_id, int16_t seconds) {
+    uint8_t buf[3] = { report_id, (uint8_t)seconds, (uint8_t)((uint16_t)seconds >> 8) };
+    ups_sim_set_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+}
+
+// 按短项格式遍历描述符：统计应用集合，记录 REPORT_ID
+static void check_descriptor(void) {
+    uint16_t len;
+    const uint8_t* desc = ups_sim_report_descriptor(&len);
+    uint8_t ids[256] = { 0 };
+    unsigned collections = 0, depth = 0;
+    bool duplicate = false;
+    uint16_t i_end = 0;
+
+    for (uint16_t i = 0; i < len;) {
+        uint8_t prefix = desc[i];
+        uint8_t size = (prefix & 3) == 3 ? 4 : (prefix & 3);
+        uint8_t data = i + 1 < len ? desc[i + 1] : 0;
+        if (prefix == 0xA1) {
+            collections += depth == 0 && data == 0x01;
+            depth++;
+        } else if (prefix == 0xC0) {
+            depth--;
+        } else if (prefix == 0x85) {
+            duplicate |= ids[data] != 0;
+            ids[data]++;
+        }
+        i += 1 + size;
+        i_end = i;
+    }
+
+    bool shifted = true;
+    unsigned per_instance = 0;
+    for (unsigned id = 1; id <= UPS_REPORT_ID_MAX; id++) {
+        per_instance += ids[id] != 0;
+        shifted &= (ids[id] != 0) == (ids[UPS_INSTANCE_REPORT_ID(1, id)] != 0);
+        shifted &= ids[UPS_INSTANCE_REPORT_ID(2, id)] == 0;
+    }
+    printf("descriptor %u bytes (%u per instance), %u application collections, %u report IDs each\n",
+           len, len / UPS_INSTANCE_COUNT, collections, per_instance);
+    expect("descriptor: length matches UPS_HID_REPORT_DESCRIPTOR_LEN", len == UPS_HID_REPORT_DESCRIPTOR_LEN);
+    expect("descriptor: items parse to the end", i_end == len);
+    expect("descriptor: one application collection each", collections == UPS_INSTANCE_COUNT && depth == 0);
+    expect("descriptor: instance 1 IDs = instance 0 + 0x40", shifted && per_instance > 0);
+    expect("descriptor: no duplicate IDs", !duplicate);
+    expect("descriptor: out-of-range instance not served",
+           get_value(UPS_INSTANCE_REPORT_ID(2, HID_PD_REMAININGCAPACITY)) == UINT32_MAX);
+}
+
+int main(void) {
+    ups_sim_set_log(false);
+    _Static_assert(UPS_INSTANCE_COUNT == 2, "build with UPS_INSTANCE_COUNT=2");
+
+    ups_sim_reset();
+    check_descriptor();
+
+    // 枚举：两个实例的 PresentStatus 都送达
+    ups_sim_ac_sense(1);
+    run_ms(1000);
+    ups_sim_mount();
+    run_ms(100);
+    expect("interrupt: both PresentStatus after mount",
+           interrupt_seen[HID_PD_PRESENTSTATUS] == 1 &&
+           interrupt_seen[UPS_INSTANCE_REPORT_ID(1, HID_PD_PRESENTSTATUS)] == 1);
+
+    // 放电：实例1负载减半，电量下降更慢、运行时间更长
+    uint32_t cap0 = get_value(HID_PD_REMAININGCAPACITY);
+    uint32_t cap1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_REMAININGCAPACITY));
+    ups_sim_ac_sense(0);
+    run_ms(DISCHARGE_MS);
+    uint32_t end0 = get_value(HID_PD_REMAININGCAPACITY);
+    uint32_t end1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_REMAININGCAPACITY));
+    uint32_t run0 = get_value(HID_PD_RUNTIMETOEMPTY);
+    uint32_t run1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_RUNTIMETOEMPTY));
+    printf("discharge %u s: capacity %u%% -> %u%% / %u%% -> %u%%, runtime %u s / %u s\n",
+           DISCHARGE_MS / 1000, (unsigned)cap0, (unsigned)end0, (unsigned)cap1, (unsigned)end1,
+           (unsigned)run0, (unsigned)run1);
+    expect("values: both instances discharge", end0 < cap0 && end1 < cap1);
+    expect("values: independent capacity and runtime", cap0 - end0 > cap1 - end1 && run1 > run0);
+    expect("interrupt: instance 1 capacity pushed",
+           interrupt_seen[UPS_INSTANCE_REPORT_ID(1, HID_PD_REMAININGCAPACITY)] > 0 &&
+           interrupt_seen[HID_PD_REMAININGCAPACITY] > 0);
+
+    // 关机：只影响实例1
+    set_delay(UPS_INSTANCE_REPORT_ID(1, HID_PD_DELAYBE4SHUTDOWN), SHUTDOWN_DELAY_S);
+    run_ms(1000);
+    uint32_t status0 = get_value(HID_PD_PRESENTSTATUS);
+    uint32_t status1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_PRESENTSTATUS));
+    uint32_t delay0 = get_value(HID_PD_DELAYBE4SHUTDOWN);
+    uint32_t delay1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_DELAYBE4SHUTDOWN));
+    expect("shutdown: countdown only on instance 1", delay0 == 0xFFFF && delay1 == SHUTDOWN_DELAY_S - 1);
+    expect("shutdown: ShutdownRequested only on instance 1",
+           !(status0 & BIT_SHUTDOWN_REQUESTED) && (status1 & BIT_SHUTDOWN_REQUESTED));
+    run_ms(SHUTDOWN_DELAY_S * 1000);
+    status0 = get_value(HID_PD_PRESENTSTATUS);
+    status1 = get_value(UPS_INSTANCE_REPORT_ID(1, HID_PD_PRESENTSTATUS));
+    expect("shutdown: only output 1 off", ups_sim_output(0, NULL) && !ups_sim_output(1, NULL));
+    expect("shutdown: ShutdownImminent only on instance 1",
+           !(status0 & BIT_SHUTDOWN_IMMINENT) && (status1 & BIT_SHUTDOWN_IMMINENT));
+
+    // 市电恢复后实例1的输出重新打开
+    ups_sim_ac_sense(1);
+    run_ms(1000);
+    expect("shutdown: output 1 back on with AC", ups_sim_output(0, NULL) && ups_sim_output(1, NULL));
+
+    printf("instance state %u bytes, report image %u bytes per instance\n",
+           (unsigned)sizeof(ups_instance_state_t), (unsigned)sizeof(ups_report_image_t));
+    printf("%s\n", errors == 0 ? "ok" : "FAIL");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ups_sim.h"
+#include "ups_journal.h"
+
+// 事件日志掉电检查：ups_journal_check [轮数] [扇区数]
+// 在内存模拟的 NOR 闪存上反复追加事件，每轮在随机的闪存操作处“掉电”
+// （正在写的记录只写入一部分，正在擦除的扇区只擦除一部分），然后重新挂载并核对：
+// 已确认写入的记录全部按序号连续读回且内容一致、下一个序号紧接其后、保留的记录数不少于容量。
+// 掉电时正在写的记录可能恰好完整（缺的字节本来就是 0xFF），此时它也应当完整读回。
+// 输出挂载时读取的字节数和各扇区擦除次数的分布。任何不一致返回非零
+
+#define DEFAULT_SECTORS 48
+
+static uint8_t* flash_mem;
+static uint32_t flash_size;
+static uint32_t* flash_erases;
+static long flash_ops_left;             // 距离掉电的闪存操作数，负数表示不掉电
+static bool flash_off;
+static uint64_t flash_read_bytes;
+
+static bool flash_cut(void) {
+    if (flash_off) {
+        return true;
+    }
+    if (flash_ops_left == 0) {
+        flash_off = true;
+        return true;
+    }
+    if (flash_ops_left > 0) {
+        flash_ops_left--;
+    }
+    return false;
+}
+
+static bool flash_read(uint32_t offset, void* buffer, uint32_t len) {
+    if (flash_off || offset + len > flash_size) {
+        return false;
+    }
+    memcpy(buffer, flash_mem + offset, len);
+    flash_read_bytes += len;
+    return true;
+}
+
+// NOR 写入只能把1改成0；掉电时只写入前一部分字节
+static bool flash_write(uint32_t offset, const void* data, uint32_t len) {
+    const uint8_t* p = data;
+    if (flash_off || offset + len > flash_size) {
+        return false;
+    }
+    bool cut = flash_cut();
+    uint32_t n = cut ? (uint32_t)rand() % len : len;
+    for (uint32_t i = 0; i < n; i++) {
+        flash_mem[offset + i] &= p[i];
+    }
+    return !cut;
+}
+
+static bool flash_erase(uint32_t offset) {
+    if (flash_off || offset % UPS_JOURNAL_SECTOR_SIZE != 0 || offset >= flash_size) {
+        return false;
+    }
+    bool cut = flash_cut();
+    uint32_t n = cut ? (uint32_t)rand() % UPS_JOURNAL_SECTOR_SIZE : UPS_JOURNAL_SECTOR_SIZE;
+    memset(flash_mem + offset, 0xFF, n);
+    flash_erases[offset / UPS_JOURNAL_SECTOR_SIZE]++;
+    return !cut;
+}
+
+static const ups_journal_flash_t sim_flash = {
+    .read = flash_read,
+    .write = flash_write,
+    .erase_sector = flash_erase,
+};
+
+int main(int argc, char** argv) {
+    uint32_t rounds = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000;
+    uint32_t sectors = argc > 2 ? (uint32_t)atoi(argv[2]) : DEFAULT_SECTORS;
+    ups_journal_flash_t flash = sim_flash;
+    int errors = 0;
+
+    flash_size = flash.size = sectors * UPS_JOURNAL_SECTOR_SIZE;
+    flash_mem = malloc(flash_size);
+    flash_erases = calloc(sectors, sizeof(uint32_t));
+    // 第一次使用的分区内容任意
+    for (uint32_t i = 0; i < flash_size; i++) {
+        flash_mem[i] = (uint8_t)rand();
+    }
+
+    // 每个确认写入的序号对应的内容（battery_mv 字段存放投递序号的低16位）
+    uint32_t max_seq = rounds * 2000 + 1;
+    uint16_t* acked = calloc(max_seq + 1, sizeof(uint16_t));
+    uint32_t acked_last = 0;
+    uint32_t posted = 0;
+    uint64_t mount_bytes_max = 0;
+
+    ups_sim_set_log(false);
+    srand(1);
+    for (uint32_t round = 0; round < rounds && !errors; round++) {
+        // 上电：挂载并核对
+        flash_off = false;
+        flash_ops_left = -1;
+        flash_read_bytes = 0;
+        ups_journal_init();
+        if (!ups_journal_mount(&flash)) {
+            printf("FAIL round %u: mount\n", (unsigned)round);
+            errors++;
+            break;
+        }
+        // 只统计分区整体写过一遍之后（初始的随机内容不再参与）
+        if (acked_last > ups_journal_capacity() + UPS_JOURNAL_SECTOR_SIZE / UPS_JOURNAL_RECORD_SIZE &&
+            flash_read_bytes > mount_bytes_max) {
+            mount_bytes_max = flash_read_bytes;
+        }
+        // 掉电时正在写的记录完整写入：按已确认处理
+        if (ups_journal_next_seq() == acked_last + 2 && acked_last + 1 <= max_seq) {
+            acked[++acked_last] = (uint16_t)(posted - 1);
+        }
+        if (ups_journal_next_seq() != acked_last + 1) {
+            printf("FAIL round %u: next seq %u, last acked %u\n", (unsigned)round,
+                   (unsigned)ups_journal_next_seq(), (unsigned)acked_last);
+            errors++;
+        }
+
+        ups_journal_cursor_t cursor;
+        ups_journal_record_t r;
+        uint32_t count = 0, first = 0, prev = 0;
+        ups_journal_begin(&cursor);
+        while (ups_journal_next(&cursor, &r)) {
+            if (count++ == 0) {
+                first = r.seq;
+            } else if (r.seq != prev + 1) {
+                printf("FAIL round %u: gap %u -> %u\n", (unsigned)round, (unsigned)prev, (unsigned)r.seq);
+                errors++;
+            }
+            if (r.seq > acked_last || r.battery_mv != acked[r.seq]) {
+                printf("FAIL round %u: seq %u content %u, expected %u\n", (unsigned)round, (unsigned)r.seq,
+                       r.battery_mv, acked[r.seq < max_seq ? r.seq : 0]);
+                errors++;
+            }
+            prev = r.seq;
+        }
+        uint32_t keep = ups_journal_capacity() - UPS_JOURNAL_SECTOR_SIZE / UPS_JOURNAL_RECORD_SIZE;
+        if (acked_last != 0 && (prev != acked_last || count < (acked_last < keep ? acked_last : keep))) {
+            printf("FAIL round %u: read %u..%u (%u records), last acked %u\n", (unsigned)round,
+                   (unsigned)first, (unsigned)prev, (unsigned)count, (unsigned)acked_last);
+            errors++;
+        }
+
+        // 运行到随机的闪存操作处掉电
+        flash_ops_left = rand() % 1500;
+        while (!flash_off) {
+            ups_journal_post(UPS_JOURNAL_STATUS, (uint8_t)(posted & 0x8F), 0, (uint16_t)posted);
+            posted++;
+            if (ups_journal_flush()) {
+                acked_last = ups_journal_next_seq() - 1;
+                if (acked_last <= max_seq) {
+                    acked[acked_last] = (uint16_t)(posted - 1);
+                }
+            }
+        }
+    }
+
+    uint32_t emin = UINT32_MAX, emax = 0;
+    for (uint32_t s = 0; s < sectors; s++) {
+        if (flash_erases[s] < emin) emin = flash_erases[s];
+        if (flash_erases[s] > emax) emax = flash_erases[s];
+    }
+    printf("%u rounds, %u records acked, %u sectors (%u records kept)\n", (unsigned)rounds, (unsigned)acked_last,
+           (unsigned)sectors, (unsigned)ups_journal_capacity());
+    printf("mount: max %llu bytes read; erases per sector: min %u max %u\n",
+           (unsigned long long)mount_bytes_max, (unsigned)emin, (unsigned)emax);
+    printf("%s\n", errors ? "FAIL" : "ok");
+
+    free(acked);
+    free(flash_erases);
+    free(flash_mem);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ups_sim.h"
+#include "ups_dsp.h"
+#include "ups_mains.h"
+
+// 市电检测回放：ups_mains_check [波形.csv 采样率Hz [事件ms]]
+// 不给文件时运行合成场景（各相位停电、欠压、过压、恢复、频率偏移），输出每个场景的检测延迟，
+// 超过半个周期的判为失败。给文件时逐行读取瞬时电压（V，多列时取最后一列），
+// 输出每次状态变化的时间，给出事件时间时输出检测延迟。
+// 样本先经与 ups_sense.c 相同的 10Hz 高通，再按固件的块大小交给 ups_mains_process()
+
+#define CHECK_RATE_HZ       5000        // 与固件默认相同：20kHz 四通道
+#define CHECK_BLOCK         32          // 每帧每通道样本数
+#define CHECK_HIGHPASS_HZ   10
+#define CHECK_FULL_SCALE_CV 40000       // Q15 满量程对应 400V
+#define CHECK_MAX_SAMPLES   (CHECK_RATE_HZ * 4)
+
+static const ups_mains_config_t mains_config = {
+    .nominal_cv = 0,
+    .nominal_hz = 0,
+    .outage_pct = 50,
+    .brownout_pct = 80,
+    .surge_pct = 115,
+    .frequency_tol_pct = 5,
+    .recover_half_cycles = 4,
+};
+
+static const char* state_names[] = { "unknown", "normal", "brownout", "surge", "outage" };
+
+static int16_t wave[CHECK_MAX_SAMPLES];
+
+static void mains_start(uint32_t rate_hz) {
+    ups_mains_init(&mains_config);
+    ups_mains_set_input(rate_hz, (int32_t)((int64_t)CHECK_FULL_SCALE_CV * 65536 / 32768));
+}
+
+static int16_t volts_to_q15(double volts) {
+    double q = volts * 100.0 * 32768.0 / CHECK_FULL_SCALE_CV;
+    return (int16_t)(q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+}
+
+// 按块送入，记录每次状态变化（样本序号），返回变化次数
+static uint32_t mains_run(int16_t* samples, uint32_t count, uint32_t rate_hz,
+                          uint32_t* change_sample, ups_mains_state_t* change_state, uint32_t max_changes) {
+    ups_dsp_biquad_t highpass;
+    ups_mains_status_t status;
+    uint32_t events = 0, changes = 0;
+
+    ups_dsp_biquad_highpass(&highpass, CHECK_HIGHPASS_HZ, rate_hz);
+    for (uint32_t offset = 0; offset < count; offset += CHECK_BLOCK) {
+        uint32_t n = count - offset < CHECK_BLOCK ? count - offset : CHECK_BLOCK;
+        ups_dsp_biquad_process(&highpass, &samples[offset], &samples[offset], n);
+        ups_mains_process(&samples[offset], n);
+        if (ups_mains_latest(&status) && status.events != events) {
+            events = status.events;
+            if (changes < max_changes) {
+                change_sample[changes] = status.event_sample;
+                change_state[changes] = status.state;
+                changes++;
+            }
+        }
+    }
+    return changes;
+}
+
+typedef struct {
+    const char* name;
+    double volts;           // 标称有效值
+    double hz;
+    double phase_deg;       // 事件发生时的相位
+    double after_scale;     // 事件后幅值比例（0 为停电）
+    double after_hz;        // 事件后频率
+    double restore_ms;      // >0 时在事件后此时间恢复，测量恢复延迟
+    ups_mains_state_t expect;
+} mains_scenario_t;
+
+static const mains_scenario_t scenarios[] = {
+    { "outage@0",      230, 50,   0, 0.0,  50, 0,   UPS_MAINS_OUTAGE },
+    { "outage@45",     230, 50,  45, 0.0,  50, 0,   UPS_MAINS_OUTAGE },
+    { "outage@90",     230, 50,  90, 0.0,  50, 0,   UPS_MAINS_OUTAGE },
+    { "outage@135",    230, 50, 135, 0.0,  50, 0,   UPS_MAINS_OUTAGE },
+    { "outage60@90",   120, 60,  90, 0.0,  60, 0,   UPS_MAINS_OUTAGE },
+    { "outage60@160",  120, 60, 160, 0.0,  60, 0,   UPS_MAINS_OUTAGE },
+    { "brownout70",    230, 50,  20, 0.7,  50, 0,   UPS_MAINS_BROWNOUT },
+    { "brownout60",    120, 60, 100, 0.7,  60, 0,   UPS_MAINS_BROWNOUT },
+    { "surge130",      230, 50,  60, 1.3,  50, 0,   UPS_MAINS_SURGE },
+    { "outage+return", 230, 50,  90, 0.0,  50, 300, UPS_MAINS_OUTAGE },
+    { "freq53",        230, 50,   0, 1.0,  53, 0,   UPS_MAINS_NORMAL },
+};
+
+// 合成波形：3% 三次谐波和 ±0.5% 噪声，事件前1秒正常
+static uint32_t scenario_build(const mains_scenario_t* s, uint32_t* event_sample, uint32_t* restore_sample) {
+    uint32_t count = CHECK_RATE_HZ * 2;
+    double peak = s->volts * sqrt(2.0);
+    double phase = 0;
+    uint32_t seed = 12345;
+    uint32_t event = 0;
+
+    // 事件放在1秒后、指定相位处
+    for (uint32_t i = CHECK_RATE_HZ; i < count; i++) {
+        double p = fmod(2 * M_PI * s->hz * i / CHECK_RATE_HZ, 2 * M_PI) * 180 / M_PI;
+        if (fabs(p - s->phase_deg) < 180.0 * s->hz / CHECK_RATE_HZ) {
+            event = i;
+            break;
+        }
+    }
+    *event_sample = event;
+    *restore_sample = s->restore_ms > 0 ? event + (uint32_t)(s->restore_ms * CHECK_RATE_HZ / 1000) : count;
+
+    for (uint32_t i = 0; i < count; i++) {
+        bool after = i >= event && i < *restore_sample;
+        double scale = after ? s->after_scale : 1.0;
+        double hz = after ? s->after_hz : s->hz;
+        seed = seed * 1103515245u + 12345u;
+        double noise = ((double)(seed >> 16 & 0x7FFF) / 32768.0 - 0.5) * 0.01 * peak;
+        double v = scale * peak * (sin(phase) + 0.03 * sin(3 * phase)) + noise;
+        phase += 2 * M_PI * hz / CHECK_RATE_HZ;
+        // 直流偏置由高通去掉，这里直接给交流量再叠加固定偏置
+        wave[i] = volts_to_q15(v + 5.0);
+    }
+    return count;
+}
+
+static int run_scenarios(void) {
+    int failed = 0;
+
+    printf("%-14s %-9s %10s %10s %8s\n", "scenario", "detected", "latency", "limit", "result");
+    for (uint32_t k = 0; k < sizeof(scenarios) / sizeof(scenarios[0]); k++) {
+        const mains_scenario_t* s = &scenarios[k];
+        uint32_t event, restore, change_sample[16];
+        ups_mains_state_t change_state[16];
+        uint32_t count = scenario_build(s, &event, &restore);
+
+        mains_start(CHECK_RATE_HZ);
+        uint32_t changes = mains_run(wave, count, CHECK_RATE_HZ, change_sample, change_state, 16);
+
+        ups_mains_status_t status;
+        ups_mains_latest(&status);
+        double limit_ms = 500.0 / s->hz;
+        bool ok;
+
+        if (s->expect == UPS_MAINS_NORMAL) {
+            // 频率偏移：电压正常但频率不合格
+            ok = status.state == UPS_MAINS_NORMAL && !status.frequency_ok;
+            printf("%-14s %-9s %7.2fHz %10s %8s\n", s->name, state_names[status.state],
+                   status.frequency_chz / 100.0, "-", ok ? "ok" : "FAIL");
+            failed += !ok;
+            continue;
+        }
+
+        // 事件前应已锁定为正常且没有误报
+        const char* detected = "none";
+        double latency_ms = -1;
+        ok = changes >= 1 && change_state[0] == UPS_MAINS_NORMAL && change_sample[0] < event;
+        for (uint32_t c = 1; c < changes; c++) {
+            if (change_sample[c] < event) {
+                ok = false;
+            } else if (latency_ms < 0) {
+                detected = state_names[change_state[c]];
+                latency_ms = (change_sample[c] - event) * 1000.0 / CHECK_RATE_HZ;
+                ok = ok && change_state[c] == s->expect && latency_ms <= limit_ms;
+            }
+        }
+        ok = ok && latency_ms >= 0;
+        printf("%-14s %-9s %8.2fms %8.2fms %8s\n", s->name, detected, latency_ms, limit_ms, ok ? "ok" : "FAIL");
+        failed += !ok;
+
+        if (s->restore_ms > 0) {
+            double back_ms = -1;
+            for (uint32_t c = 0; c < changes; c++) {
+                if (change_sample[c] >= restore && change_state[c] == UPS_MAINS_NORMAL) {
+                    back_ms = (change_sample[c] - restore) * 1000.0 / CHECK_RATE_HZ;
+                    break;
+                }
+            }
+            printf("%-14s %-9s %8.2fms %10s %8s\n", "  restore", back_ms >= 0 ? "normal" : "none", back_ms, "-",
+                   back_ms >= 0 ? "ok" : "FAIL");
+            failed += back_ms < 0;
+        }
+    }
+    printf("nominal: auto-detected per scenario, %u Hz sampling, %u-sample blocks\n",
+           CHECK_RATE_HZ, CHECK_BLOCK);
+    return failed ? 1 : 0;
+}
+
+static int run_file(const char* path, uint32_t rate_hz, double event_ms) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    char line[128];
+    uint32_t count = 0;
+    while (count < CHECK_MAX_SAMPLES && fgets(line, sizeof(line), file)) {
+        char* last = strrchr(line, ',');
+        char* end;
+        double v = strtod(last ? last + 1 : line, &end);
+        if (end != (last ? last + 1 : line)) {
+            wave[count++] = volts_to_q15(v);
+        }
+    }
+    fclose(file);
+
+    uint32_t change_sample[64];
+    ups_mains_state_t change_state[64];
+    mains_start(rate_hz);
+    uint32_t changes = mains_run(wave, count, rate_hz, change_sample, change_state, 64);
+
+    for (uint32_t c = 0; c < changes; c++) {
+        double t_ms = change_sample[c] * 1000.0 / rate_hz;
+        printf("%10.2fms  %s", t_ms, state_names[change_state[c]]);
+        if (event_ms >= 0 && t_ms >= event_ms) {
+            printf("  (+%.2fms)", t_ms - event_ms);
+            event_ms = -1;
+        }
+        printf("\n");
+    }
+    ups_mains_status_t status;
+    if (ups_mains_latest(&status)) {
+        printf("samples=%u rms=%.2fV freq=%.2fHz nominal=%.0fV/%uHz\n", (unsigned)count, status.rms_cv / 100.0,
+               status.frequency_chz / 100.0, status.nominal_cv / 100.0, status.nominal_hz);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    ups_sim_set_log(false);
+    if (argc > 2) {
+        return run_file(argv[1], (uint32_t)strtoul(argv[2], NULL, 0), argc > 3 ? atof(argv[3]) : -1);
+    }
+    if (argc > 1) {
+        fprintf(stderr, "usage: ups_mains_check [wave.csv rate_hz [event_ms]]\n");
+        return 1;
+    }
+    return run_scenarios();
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ups_port.h"
+#include "ups_sim.h"
+#include "ups_battery.h"
+#include "ups_runtime.h"
+#include "ups_store.h"
+
+// 电池模型回放：ups_replay <曲线.csv> [设计容量mAh] [初始电量%] [输出间隔秒]
+// 曲线每行为 "时间ms,电流mA,电压mV[,负载mA]"（充电电流为正），# 开头的行忽略。
+// 没有负载列时放电电流即负载，充电期间沿用最近的负载值。
+// 记录的采样按零阶保持重采样到 UPS_BATTERY_SAMPLE_HZ 后送入模型，
+// 每个输出间隔打印一行模型状态（CSV）。按 ups_state.c 的持久化参数每2秒提交一次学习结果，
+// 结束时在 stderr 输出闪存写入次数。
+// 曲线中可以带期望值（见 host/data/sla_7ah_cycle.csv），任何一项超出容差或没有回放到时返回非零：
+//   #expect,时间s,剩余容量%,容差,充满容量%,容差      （"-" 表示该项不检查）
+//   #expect_resistance,内阻mOhm,容差               （回放结束时检查）
+
+#define REPLAY_MAX_EXPECT 32
+
+typedef struct {
+    uint32_t time_s;
+    int remaining, remaining_tol;   // -1 不检查
+    int full, full_tol;
+    bool checked;
+} replay_expect_t;
+
+static replay_expect_t replay_expects[REPLAY_MAX_EXPECT];
+static unsigned replay_expect_count;
+static int replay_resistance = -1, replay_resistance_tol;
+static unsigned replay_failures;
+
+static int replay_field(const char* field) {
+    return strcmp(field, "-") == 0 ? -1 : atoi(field);
+}
+
+// 解析 "#expect..." 行，不是期望行返回 false
+static bool replay_parse_expect(const char* line) {
+    char a[16], b[16], c[16], d[16];
+    unsigned long time_s;
+    int value, tol;
+
+    if (sscanf(line, "#expect_resistance,%d,%d", &value, &tol) == 2) {
+        replay_resistance = value;
+        replay_resistance_tol = tol;
+        return true;
+    }
+    if (sscanf(line, "#expect,%lu,%15[^,],%15[^,],%15[^,],%15[^,\r\n]", &time_s, a, b, c, d) != 5) {
+        return false;
+    }
+    if (replay_expect_count == REPLAY_MAX_EXPECT) {
+        fprintf(stderr, "too many #expect lines\n");
+        replay_failures++;
+        return true;
+    }
+    replay_expects[replay_expect_count++] = (replay_expect_t){
+        .time_s = (uint32_t)time_s,
+        .remaining = replay_field(a), .remaining_tol = atoi(b),
+        .full = replay_field(c), .full_tol = atoi(d),
+    };
+    return true;
+}
+
+static bool replay_within(int got, int want, int tol) {
+    return want < 0 || (got >= want - tol && got <= want + tol);
+}
+
+static void replay_check(uint64_t sample) {
+    for (unsigned i = 0; i < replay_expect_count; i++) {
+        replay_expect_t* e = &replay_expects[i];
+        if (e->checked || (uint64_t)e->time_s * UPS_BATTERY_SAMPLE_HZ != sample) {
+            continue;
+        }
+        ups_battery_status_t s;
+        ups_battery_get_status(0, &s);
+        bool ok = replay_within(s.remaining_capacity, e->remaining, e->remaining_tol) &&
+                  replay_within(s.full_charge_capacity, e->full, e->full_tol);
+        fprintf(stderr, "expect %6us: remaining %3u%% (want %d±%d)  full %3u%% (want %d±%d)  %s\n",
+                (unsigned)e->time_s, s.remaining_capacity, e->remaining, e->remaining_tol,
+                s.full_charge_capacity, e->full, e->full_tol, ok ? "ok" : "FAIL");
+        replay_failures += !ok;
+        e->checked = true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s curve.csv [design_mah] [initial_percent] [interval_s]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "r");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    ups_battery_config_t config = {
+        .design_capacity_mah = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 7000,
+        .full_voltage_mv = 13600,
+        .taper_current_ma = 100,
+        .empty_voltage_mv = 10500,
+        .charge_efficiency = 95,
+    };
+    ups_runtime_config_t runtime_config = {
+        .tau_fast_ms = 120000,
+        .tau_slow_ms = 600000,
+        .rated_current_ma = (uint16_t)(config.design_capacity_mah / 20),
+        .peukert_x100 = 120,
+        .derate_table = NULL,
+        .initial_load_ma = 1500,
+    };
+    uint8_t initial_percent = argc > 3 ? (uint8_t)atoi(argv[3]) : 100;
+    uint32_t interval = (argc > 4 ? (uint32_t)atoi(argv[4]) : 10) * UPS_BATTERY_SAMPLE_HZ;
+    ups_store_config_t store_config = {
+        .design_capacity_mah = config.design_capacity_mah,
+        .capacity_step_pct = 1,
+        .resistance_step_pct = 5,
+        .min_interval_ms = 10 * 60 * 1000,
+        .max_interval_ms = 6 * 60 * 60 * 1000,
+    };
+    ups_store_data_t stored;
+
+    ups_sim_set_log(true);
+    ups_battery_init(0, &config, initial_percent);
+    ups_runtime_init(&runtime_config);
+    ups_store_init(&store_config);
+    ups_store_loaded(NULL);
+    ups_store_take_loaded(&stored);
+
+    printf("time_s,remaining_pct,remaining_mah,full_pct,load_ma,runtime_s,avg_tte_s,avg_ttf_s,fully_charged,fully_discharged\n");
+
+    char line[128];
+    uint64_t sample = 0;
+    int32_t current_ma = 0;
+    uint16_t voltage_mv = 0;
+    uint32_t load_ma = runtime_config.initial_load_ma;
+    bool have_sample = false;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long time_ms;
+        long current, voltage, load;
+        if (line[0] == '#') {
+            replay_parse_expect(line);
+            continue;
+        }
+        int fields = sscanf(line, "%lu,%ld,%ld,%ld", &time_ms, &current, &voltage, &load);
+        if (fields < 3) {
+            continue;
+        }
+
+        // 用上一个采样值补齐到本行时间
+        uint64_t target = (uint64_t)time_ms * UPS_BATTERY_SAMPLE_HZ / 1000;
+        while (have_sample && sample < target) {
+            ups_battery_sample(0, current_ma, voltage_mv);
+            ups_runtime_sample(0, load_ma);
+            ups_sim_advance_ms(1000 / UPS_BATTERY_SAMPLE_HZ);
+            replay_check(++sample);
+            if (sample % (2 * UPS_BATTERY_SAMPLE_HZ) == 0) {
+                ups_battery_status_t s;
+                uint32_t seq;
+                ups_battery_get_status(0, &s);
+                stored = (ups_store_data_t){
+                    .full_charge_mah = s.full_charge_mah,
+                    .cycle_count = s.cycle_count,
+                    .resistance_mohm = s.resistance_mohm,
+                };
+                ups_store_update(&stored, s.fully_discharged, ups_port_millis());
+                while (ups_store_pending(&stored, &seq)) {
+                    ups_store_done(seq, true);
+                }
+            }
+            if (sample % interval == 0) {
+                ups_battery_status_t s;
+                uint16_t runtime, avg_runtime;
+                ups_battery_get_status(0, &s);
+                ups_runtime_estimate(0, s.remaining_mah, s.full_charge_mah, &runtime, &avg_runtime);
+                printf("%llu,%u,%u,%u,%u,%u,%u,%u,%d,%d\n",
+                       (unsigned long long)(sample / UPS_BATTERY_SAMPLE_HZ),
+                       s.remaining_capacity, (unsigned)s.remaining_mah, s.full_charge_capacity,
+                       (unsigned)ups_runtime_load_ma(0), runtime, avg_runtime, s.avg_time_to_full,
+                       s.fully_charged, s.fully_discharged);
+            }
+        }
+        if (!have_sample) {
+            sample = target;
+            have_sample = true;
+        }
+        current_ma = (int32_t)current;
+        voltage_mv = (uint16_t)voltage;
+        if (fields == 4) {
+            load_ma = (uint32_t)load;
+        } else if (current < 0) {
+            load_ma = (uint32_t)-current;
+        }
+    }
+
+    fclose(file);
+
+    ups_battery_status_t s;
+    ups_battery_get_status(0, &s);
+    fprintf(stderr, "store: %u commits over %llu s, %u cycles, %u mOhm\n", (unsigned)ups_store_commits(),
+            (unsigned long long)(sample / UPS_BATTERY_SAMPLE_HZ), s.cycle_count, s.resistance_mohm);
+
+    for (unsigned i = 0; i < replay_expect_count; i++) {
+        if (!replay_expects[i].checked) {
+            fprintf(stderr, "expect %6us: not reached  FAIL\n", (unsigned)replay_expects[i].time_s);
+            replay_failures++;
+        }
+    }
+    if (replay_resistance >= 0) {
+        bool ok = replay_within(s.resistance_mohm, replay_resistance, replay_resistance_tol);
+        fprintf(stderr, "expect resistance: %u mOhm (want %d±%d)  %s\n", s.resistance_mohm,
+                replay_resistance, replay_resistance_tol, ok ? "ok" : "FAIL");
+        replay_failures += !ok;
+    }
+    return replay_failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ups_sim.h"
+#include "ups_battery.h"
+#include "ups_runtime.h"
+
+// 运行时间估算校验：ups_runtime_check [Peukert指数×100]
+// 用合成负载曲线驱动一个按 Peukert 定律放电的“真实”电池，
+// 每分钟末记录 RunTimeToEmpty/AverageTimeToEmpty，放空后与实际剩余时间对比。
+// 停电前负载已在市电上运行30分钟（平滑值已收敛）；负载变化后 5 个时间常数内的估算
+// （EMA 系数取2的幂，实际时间常数最多大 41%）和最后5分钟的估算不计入。
+// 剩余不到30分钟时误差按绝对值 / 30分钟计，整数舍入和折算表插值造成的几十秒偏差
+// 在接近放空时不会被放大成很大的相对误差。
+// 任何一项平均或最大相对误差超出该负载曲线的上限时返回非零；
+// 放空前来不及收敛（没有可比较的点）的项只打印 n/a，不算失败
+
+#define DESIGN_MAH   7000
+#define RATED_MA     (DESIGN_MAH / 20)
+#define MAX_MINUTES  (24 * 60)
+#define TAU_FAST_S   120
+#define TAU_SLOW_S   600
+#define PREROLL_S    (30 * 60)
+#define ERROR_FLOOR_S (30 * 60)     // 剩余不到30分钟时按绝对误差 / 30分钟计
+
+typedef uint32_t (*load_profile_t)(uint32_t second);
+
+// 空闲NAS：恒定小负载
+static uint32_t profile_idle(uint32_t second) {
+    (void)second;
+    return 800;
+}
+
+// 满载：恒定大负载
+static uint32_t profile_heavy(uint32_t second) {
+    (void)second;
+    return 4000;
+}
+
+// 磁盘校验：基础负载上每分钟有20秒的突发
+static uint32_t profile_scrub(uint32_t second) {
+    return second % 60 < 20 ? 3500 : 1200;
+}
+
+// 负载阶跃：空闲1小时后开始校验
+static uint32_t profile_step(uint32_t second) {
+    return second < 3600 ? 800 : 3500;
+}
+
+// settle_s：最后一次负载变化（放电开始后的秒数）；误差上限为 % ，依次为 fast 平均/最大、avg 平均/最大。
+// scrub 在每分钟同一相位（突发后40秒）取样，是平滑值偏离平均负载最大的时刻
+static const struct {
+    const char* name;
+    load_profile_t load;
+    uint32_t settle_s;
+    double fast_mean, fast_worst, avg_mean, avg_worst;
+} profiles[] = {
+    { "idle",  profile_idle,  0,    2, 4, 2, 4 },
+    { "heavy", profile_heavy, 0,    2, 4, 2, 4 },
+    { "scrub", profile_scrub, 0,    12, 15, 5, 8 },
+    { "step",  profile_step,  3600, 3, 5, 3, 5 },
+};
+
+static uint16_t predicted_fast[MAX_MINUTES];
+static uint16_t predicted_slow[MAX_MINUTES];
+
+// 返回超出上限的项数
+static int runtime_report(const char* name, const char* which, const uint16_t* predicted, uint32_t minutes,
+                          uint32_t empty_s, uint32_t from_s, double mean_limit, double worst_limit) {
+    double sum = 0, worst = 0;
+    uint32_t count = 0, early = 0;
+
+    for (uint32_t m = 0; m < minutes; m++) {
+        double actual = (double)empty_s - (m + 1) * 60.0;
+        if ((m + 1) * 60 < from_s) {
+            continue;
+        }
+        if (actual < 300) {
+            break;
+        }
+        double error = (predicted[m] - actual) / (actual > ERROR_FLOOR_S ? actual : ERROR_FLOOR_S);
+        sum += fabs(error);
+        worst = fabs(error) > fabs(worst) ? error : worst;
+        early += error < 0;
+        count++;
+    }
+    if (count == 0) {
+        printf("%-6s %-5s empty=%6us  n/a (empties before the estimate settles)\n", name, which, (unsigned)empty_s);
+        return 0;
+    }
+    double mean = 100 * sum / count;
+    bool ok = mean <= mean_limit && fabs(100 * worst) <= worst_limit;
+    printf("%-6s %-5s empty=%6us  mean=%5.1f%% (<=%g)  worst=%+6.1f%% (<=%g)  early=%u/%u  %s\n",
+           name, which, (unsigned)empty_s, mean, mean_limit, 100 * worst, worst_limit, early, count,
+           ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    uint16_t peukert_x100 = argc > 1 ? (uint16_t)atoi(argv[1]) : 120;
+    double exponent = (peukert_x100 - 100) / 100.0;
+
+    ups_battery_config_t battery_config = {
+        .design_capacity_mah = DESIGN_MAH,
+        .full_voltage_mv = 13600,
+        .taper_current_ma = 100,
+        .empty_voltage_mv = 0,              // 放空由下面的“真实”电池判定
+        .charge_efficiency = 95,
+    };
+    ups_runtime_config_t runtime_config = {
+        .tau_fast_ms = TAU_FAST_S * 1000,
+        .tau_slow_ms = TAU_SLOW_S * 1000,
+        .rated_current_ma = RATED_MA,
+        .peukert_x100 = peukert_x100,
+        .derate_table = NULL,
+        .initial_load_ma = 1500,
+    };
+
+    int failures = 0;
+
+    ups_sim_set_log(false);
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        ups_battery_init(0, &battery_config, 100);
+        ups_runtime_init(&runtime_config);
+
+        // 市电供电期间电池保持充满，负载已在运行
+        for (uint32_t t = 0; t < PREROLL_S * UPS_BATTERY_SAMPLE_HZ; t++) {
+            ups_runtime_sample(0, profiles[p].load(0));
+        }
+        uint16_t unused_fast, unused_slow;
+        ups_runtime_estimate(0, DESIGN_MAH, DESIGN_MAH, &unused_fast, &unused_slow);
+
+        // 真实电池：以额定电流折算的已用电量
+        double used = 0, capacity = DESIGN_MAH * 3600.0 * UPS_BATTERY_SAMPLE_HZ;
+        uint32_t sample = 0, minutes = 0;
+
+        while (used < capacity && minutes < MAX_MINUTES) {
+            uint32_t load = profiles[p].load(sample / UPS_BATTERY_SAMPLE_HZ);
+            double rate = load > RATED_MA ? pow((double)load / RATED_MA, exponent) : 1.0;
+            used += load * rate;
+
+            ups_battery_sample(0, -(int32_t)load, 12000);
+            ups_runtime_sample(0, load);
+
+            if (++sample % (60 * UPS_BATTERY_SAMPLE_HZ) == 0) {
+                ups_battery_status_t s;
+                ups_battery_get_status(0, &s);
+                ups_runtime_estimate(0, s.remaining_mah, s.full_charge_mah,
+                                     &predicted_fast[minutes], &predicted_slow[minutes]);
+                minutes++;
+            }
+        }
+
+        uint32_t empty_s = sample / UPS_BATTERY_SAMPLE_HZ;
+        failures += runtime_report(profiles[p].name, "fast", predicted_fast, minutes, empty_s,
+                                   profiles[p].settle_s + 5 * TAU_FAST_S, profiles[p].fast_mean, profiles[p].fast_worst);
+        failures += runtime_report(profiles[p].name, "avg", predicted_slow, minutes, empty_s,
+                                   profiles[p].settle_s + 5 * TAU_SLOW_S, profiles[p].avg_mean, profiles[p].avg_worst);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "ups_sim.h"
+#include "ups_sense.h"
+#include "ups_mains.h"
+
+// 采集流水线主机样本源：ups_sense [样本文件] [块字节数]
+// 样本文件为固件 ADC DMA 输出的原始转储（每个采样4字节，TYPE2格式）。
+// 不给文件或文件为 "-" 时合成1秒 20kHz 的四通道数据（50Hz 市电正弦）。
+// 逐块调用 ups_sense_process()，输出结果和每个采样的处理时间
+
+#define SYNTH_RATE_HZ   20000
+#define SYNTH_SAMPLES   SYNTH_RATE_HZ
+
+// 与 main/ups_adc_esp.c 默认值相同：ADC 满量程约 3100mV，电池分压 1/6，
+// 电流检测 100mV/A 且以 1650mV 为零点
+#define ADC_MV_Q16(mv_per_count_x1000) ((int32_t)((mv_per_count_x1000) * 65536LL / 1000))
+
+static const ups_sense_config_t sense_config = {
+    .adc_channel = { 0, 1, 2, 3 },
+    .offset_raw = { 0, 2180, 2180, 0 },
+    .gain_q16 = {
+        ADC_MV_Q16(3100 * 6 * 1000 / 4095),        // mV
+        ADC_MV_Q16(3100 * 10 * 1000 / 4095),       // mA
+        ADC_MV_Q16(3100 * 10 * 1000 / 4095),       // mA
+        ADC_MV_Q16(3100 * 1000 / 4095),            // mV（检测端）
+    },
+    .channel_rate_hz = SYNTH_RATE_HZ / UPS_SENSE_CHANNELS,
+    .ac_line_ratio = 430,                          // 检测端约 535mV 对应 230V
+};
+
+// 与 ups_state.c 相同的市电判定参数
+static const ups_mains_config_t mains_config = {
+    .outage_pct = 50,
+    .brownout_pct = 80,
+    .surge_pct = 115,
+    .frequency_tol_pct = 5,
+    .recover_half_cycles = 4,
+};
+
+static void sense_put(uint8_t* p, uint8_t channel, uint32_t raw) {
+    uint32_t word = (raw & 0x0FFF) | ((uint32_t)channel << 13);
+    p[0] = (uint8_t)word;
+    p[1] = (uint8_t)(word >> 8);
+    p[2] = (uint8_t)(word >> 16);
+    p[3] = (uint8_t)(word >> 24);
+}
+
+static uint8_t* sense_synthesize(uint32_t* len) {
+    uint8_t* data = malloc(SYNTH_SAMPLES * UPS_SENSE_SAMPLE_BYTES);
+    for (uint32_t i = 0; i < SYNTH_SAMPLES; i++) {
+        uint8_t channel = i % 4;
+        double t = (double)i / SYNTH_RATE_HZ;
+        uint32_t raw;
+        switch (channel) {
+            case 0:  raw = 2650; break;                                       // 约12.0V
+            case 1:  raw = 2180 - 198; break;                                 // 约-1.5A
+            case 2:  raw = 2180 + 198; break;                                 // 约1.5A
+            default: raw = (uint32_t)(2048 + 1000 * sin(2 * M_PI * 50 * t)); break;
+        }
+        sense_put(&data[i * UPS_SENSE_SAMPLE_BYTES], channel, raw);
+    }
+    *len = SYNTH_SAMPLES * UPS_SENSE_SAMPLE_BYTES;
+    return data;
+}
+
+static uint8_t* sense_load(const char* path, uint32_t* len) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = malloc(size > 0 ? (size_t)size : 1);
+    *len = (uint32_t)fread(data, 1, (size_t)size, file);
+    fclose(file);
+    return data;
+}
+
+static uint64_t sense_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+    uint32_t len;
+    uint8_t* data = argc > 1 && strcmp(argv[1], "-") != 0 ? sense_load(argv[1], &len) : sense_synthesize(&len);
+    uint32_t block = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 1024;
+    if (data == NULL) {
+        return 1;
+    }
+    if (len < UPS_SENSE_SAMPLE_BYTES) {
+        fprintf(stderr, "no samples\n");
+        free(data);
+        return 1;
+    }
+    block -= block % UPS_SENSE_SAMPLE_BYTES;
+
+    ups_sim_set_log(false);
+    ups_mains_init(&mains_config);
+    ups_sense_init(&sense_config);
+
+    uint64_t start = sense_now_ns();
+    for (uint32_t offset = 0; offset < len; offset += block) {
+        ups_sense_process(data + offset, len - offset < block ? len - offset : block);
+    }
+    uint64_t elapsed = sense_now_ns() - start;
+
+    ups_sense_reading_t r;
+    if (ups_sense_latest(&r)) {
+        printf("blocks=%u battery=%umV %dmA load=%umA ac_rms=%umV\n",
+               (unsigned)r.blocks, r.battery_mv, (int)r.battery_ma, (unsigned)r.load_ma, (unsigned)r.ac_rms_mv);
+    }
+    ups_mains_status_t m;
+    if (ups_mains_latest(&m)) {
+        printf("mains: state=%d rms=%.2fV freq=%.2fHz nominal=%.0fV/%uHz\n", (int)m.state, m.rms_cv / 100.0,
+               m.frequency_chz / 100.0, m.nominal_cv / 100.0, m.nominal_hz);
+    }
+    printf("samples=%u  %.2f ns/sample\n", len / UPS_SENSE_SAMPLE_BYTES,
+           (double)elapsed / (len / UPS_SENSE_SAMPLE_BYTES));
+
+    free(data);
+    return 0;
+}
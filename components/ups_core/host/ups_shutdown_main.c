@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ups_port.h"
+#include "ups_sim.h"
+#include "ups_report.h"
+#include "ups_hid.h"
+#include "ups_battery.h"
+#include "ups_shutdown.h"
+#include "ups_state.h"
+
+// 关机/重启编排检查：ups_shutdown_check
+// 在模拟设备上按主机的方式写 DelayBeforeShutdown / DelayBeforeReboot（SET_REPORT）并读回（GET_REPORT），
+// 状态任务按固件节奏运行（100Hz 采样，2秒或有变化时更新）。没有市电检测时 AC 每60秒翻转一次。
+// 核对：倒计时读数、ShutdownRequested/ShutdownImminent 的置位时刻、输出关闭和恢复的时刻、取消和重新写入。
+// 输出各项实际时刻与预期的偏差，任何一项超出一个采样周期返回非零
+
+#define TICK_MS (1000 / UPS_BATTERY_SAMPLE_HZ)
+
+#define BIT_REQUESTED (1u << 10)
+#define BIT_IMMINENT  (1u << 11)
+
+static uint32_t now_ms;
+static uint32_t update_ticks;
+static int errors;
+
+// 最近一次变化的时刻
+static uint32_t output_changed_ms;
+static uint32_t requested_changed_ms;
+static uint32_t imminent_changed_ms;
+static uint32_t ac_changed_ms;
+static uint16_t last_status;
+static bool last_ac = true;
+
+static uint16_t get_status(void) {
+    uint8_t buf[3] = { 0 };
+    ups_sim_get_report(HID_PD_PRESENTSTATUS, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+    return (uint16_t)(buf[1] | buf[2] << 8);
+}
+
+static int16_t get_delay(uint8_t report_id) {
+    uint8_t buf[3] = { 0 };
+    ups_sim_get_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+    return (int16_t)(buf[1] | buf[2] << 8);
+}
+
+static void set_delay(uint8_t report_id, int16_t seconds) {
+    uint8_t buf[3] = { report_id, (uint8_t)seconds, (uint8_t)((uint16_t)seconds >> 8) };
+    ups_sim_set_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+}
+
+// 按固件主循环运行到 until 时刻，记录各状态的变化时刻
+static void run_until(uint32_t until) {
+    while ((int32_t)(until - now_ms) > 0) {
+        ups_sim_advance_ms(TICK_MS);
+        now_ms += TICK_MS;
+        bool urgent = ups_state_sample();
+        if (urgent || ++update_ticks >= UPS_BATTERY_SAMPLE_HZ * 2) {
+            ups_state_update();
+            update_ticks = 0;
+        }
+
+        uint32_t changed;
+        ups_sim_output(0, &changed);
+        output_changed_ms = changed;
+        uint16_t status = get_status();
+        if ((status ^ last_status) & BIT_REQUESTED) {
+            requested_changed_ms = now_ms;
+        }
+        if ((status ^ last_status) & BIT_IMMINENT) {
+            imminent_changed_ms = now_ms;
+        }
+        last_status = status;
+        if (UPS.ACPresent != last_ac) {
+            last_ac = UPS.ACPresent;
+            ac_changed_ms = now_ms;
+        }
+    }
+}
+
+static void expect_time(const char* what, uint32_t actual, uint32_t expected, uint32_t tolerance) {
+    int32_t diff = (int32_t)(actual - expected);
+    bool ok = diff >= 0 && diff <= (int32_t)tolerance;
+    printf("%-36s at %7u ms (expected %7u, %+d ms) %s\n", what, (unsigned)actual, (unsigned)expected, (int)diff,
+           ok ? "ok" : "FAIL");
+    if (!ok) {
+        errors++;
+    }
+}
+
+static void expect(const char* what, bool ok) {
+    printf("%-36s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        errors++;
+    }
+}
+
+// 等到 AC 处于指定状态
+static void run_until_ac(bool present) {
+    while (UPS.ACPresent != present) {
+        run_until(now_ms + TICK_MS);
+    }
+}
+
+int main(void) {
+    ups_sim_set_log(false);
+    ups_sim_reset();
+    ups_sim_mount();
+    last_status = get_status();
+
+    // 1. 关机倒计时：读数、状态位、到时关闭输出；AC 在位时保持关闭，市电断开再恢复后打开
+    run_until(1000);
+    expect("idle DelayBeforeShutdown == -1", get_delay(HID_PD_DELAYBE4SHUTDOWN) == -1);
+    set_delay(HID_PD_DELAYBE4SHUTDOWN, 10);
+    run_until(1000 + TICK_MS);
+    expect_time("shutdown: ShutdownRequested set", requested_changed_ms, 1000, TICK_MS);
+    run_until(4500);
+    expect("shutdown: reads 7 s at 3.5 s", get_delay(HID_PD_DELAYBE4SHUTDOWN) == 7);
+    run_until(11000 - TICK_MS);
+    expect_time("shutdown: ShutdownImminent set", imminent_changed_ms, 11000 - UPS_SHUTDOWN_IMMINENT_MS, TICK_MS);
+    expect("shutdown: output on before deadline", ups_sim_output(0, NULL));
+    run_until(11000 + TICK_MS);
+    expect_time("shutdown: output off", output_changed_ms, 11000, 0);
+    expect("shutdown: output off", !ups_sim_output(0, NULL));
+    expect_time("shutdown: ShutdownRequested cleared", requested_changed_ms, 11000, TICK_MS);
+    run_until(30000);
+    expect("shutdown: reads -1 after expiry", get_delay(HID_PD_DELAYBE4SHUTDOWN) == -1);
+    expect("shutdown: stays off with AC present", !ups_sim_output(0, NULL) && UPS.ACPresent);
+    run_until_ac(false);
+    run_until_ac(true);
+    run_until(now_ms + TICK_MS);
+    expect_time("shutdown: output on when AC returns", output_changed_ms, ac_changed_ms, TICK_MS);
+    expect_time("shutdown: ShutdownImminent cleared", imminent_changed_ms, ac_changed_ms, TICK_MS);
+
+    // 2. 重启：到时关闭，关闭时间过后打开
+    uint32_t t = now_ms + 1000;
+    run_until(t);
+    set_delay(HID_PD_DELAYBE4REBOOT, 5);
+    run_until(t + 5000 + TICK_MS);
+    expect_time("reboot: output off", output_changed_ms, t + 5000, 0);
+    run_until(t + 5000 + UPS_SHUTDOWN_REBOOT_OFF_MS + TICK_MS);
+    expect("reboot: output on again", ups_sim_output(0, NULL));
+    expect_time("reboot: output on", output_changed_ms, t + 5000 + UPS_SHUTDOWN_REBOOT_OFF_MS, 0);
+
+    // 3. 取消：写 -1 后读数、状态位恢复，输出不动
+    t = now_ms + 1000;
+    run_until(t);
+    set_delay(HID_PD_DELAYBE4SHUTDOWN, 30);
+    run_until(t + 10000);
+    set_delay(HID_PD_DELAYBE4SHUTDOWN, -1);
+    run_until(t + 10000 + TICK_MS);
+    expect("cancel: reads -1", get_delay(HID_PD_DELAYBE4SHUTDOWN) == -1);
+    expect_time("cancel: ShutdownRequested cleared", requested_changed_ms, t + 10000, TICK_MS);
+    run_until(t + 40000);
+    expect("cancel: output stays on", ups_sim_output(0, NULL) && output_changed_ms < t);
+
+    // 4. 重启时没有市电：关闭时间过后等市电恢复
+    run_until_ac(false);
+    t = now_ms;
+    set_delay(HID_PD_DELAYBE4REBOOT, 1);
+    run_until(t + 1000 + UPS_SHUTDOWN_REBOOT_OFF_MS + TICK_MS);
+    expect("reboot on battery: waits for AC", !ups_sim_output(0, NULL) && !UPS.ACPresent);
+    run_until_ac(true);
+    run_until(now_ms + TICK_MS);
+    expect_time("reboot on battery: output on with AC", output_changed_ms, ac_changed_ms, TICK_MS);
+
+    // 5. 倒计时中重新写入：以最后一次写入为准
+    t = now_ms + 1000;
+    run_until(t);
+    set_delay(HID_PD_DELAYBE4SHUTDOWN, 20);
+    run_until(t + 5000);
+    set_delay(HID_PD_DELAYBE4SHUTDOWN, 8);
+    run_until(t + 5000 + 8000 + TICK_MS);
+    expect_time("rewrite: output off", output_changed_ms, t + 5000 + 8000, 0);
+
+    printf("%s\n", errors ? "FAIL" : "ok");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+#include <string.h>
+#include <time.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_report_schema.h"
+#include "ups_hid.h"
+#include "ups_state.h"
+#include "ups_shutdown.h"
+#include "ups_event.h"
+#include "ups_sim.h"
+
+bool ups_port_log_enabled = true;
+
+static uint32_t sim_millis = 0;
+static bool sim_mounted = false;
+
+// 总线挂起和远程唤醒
+static bool sim_suspended = false;
+static bool sim_remote_wakeup_en = false;
+static uint32_t sim_remote_wakeups = 0;
+static uint32_t sim_remote_wakeup_ms = 0;
+
+// 市电检测输入：-1 为没有（ACPresent 按60秒模拟切换）
+static int sim_ac_sense = -1;
+
+// 中断IN端点：与 TinyUSB 一样同一时刻只有一个未完成传输
+static bool sim_in_busy = false;
+static uint8_t sim_in_buf[1 + UPS_REPORT_MAX_LEN];
+static uint16_t sim_in_len = 0;
+
+// 关机编排定时器和负载输出
+static bool sim_timer_armed = false;
+static uint32_t sim_timer_at = 0;
+static bool sim_output[UPS_INSTANCE_COUNT];
+static uint32_t sim_output_ms[UPS_INSTANCE_COUNT];
+
+// 状态任务的任务通知（不用 ups_sim_event_start 的工具自己轮询 ups_event_take()）
+static bool sim_event_task = false;
+static bool sim_event_notified = false;
+
+// ==================== ups_port.h 实现 ====================
+
+uint32_t ups_port_millis(void) {
+    return sim_millis;
+}
+
+uint32_t ups_port_micros(void) {
+    return sim_millis * 1000;
+}
+
+uint32_t ups_port_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+uint32_t ups_port_cycles_per_us(void) {
+    return 1000;
+}
+
+const char* ups_port_cycles_unit(void) {
+    return "ns";
+}
+
+bool ups_port_hid_mounted(void) {
+    return sim_mounted;
+}
+
+bool ups_port_hid_ready(void) {
+    return sim_mounted && !sim_suspended && !sim_in_busy;
+}
+
+bool ups_port_hid_send(uint8_t report_id, const void* data, uint16_t len) {
+    if (!ups_port_hid_ready() || len > UPS_REPORT_MAX_LEN) {
+        return false;
+    }
+    sim_in_buf[0] = report_id;
+    memcpy(&sim_in_buf[1], data, len);
+    sim_in_len = len + 1;
+    sim_in_busy = true;
+    return true;
+}
+
+// 与 tud_remote_wakeup() 相同：只有挂起且主机允许时才发出
+bool ups_port_hid_remote_wakeup(void) {
+    if (!sim_suspended || !sim_remote_wakeup_en) {
+        return false;
+    }
+    sim_remote_wakeups++;
+    sim_remote_wakeup_ms = sim_millis;
+    return true;
+}
+
+void ups_port_output_set(uint8_t instance, bool on) {
+    sim_output[instance] = on;
+    sim_output_ms[instance] = sim_millis;
+}
+
+void ups_port_shutdown_timer(uint32_t delay_ms) {
+    sim_timer_armed = delay_ms != UINT32_MAX;
+    sim_timer_at = sim_millis + delay_ms;
+}
+
+// 单线程模拟：直接运行回调
+void ups_port_shutdown_kick(void) {
+    ups_shutdown_timer();
+}
+
+// 没有闪存：快照留在暂存区，由主机工具用 ups_store_pending() 取走
+void ups_port_store_kick(void) {
+}
+
+// 模拟状态任务的任务通知：任务启动（写入句柄）前的唤醒丢弃，之后累积到被取走
+void ups_port_event_wake(void) {
+    if (sim_event_task) {
+        sim_event_notified = true;
+    }
+}
+
+// 没有电源管理
+bool ups_port_power(ups_port_power_t* power) {
+    (void)power;
+    return false;
+}
+
+// 没有设置市电检测输入时 ACPresent 按60秒模拟切换
+bool ups_port_ac_sense(bool* present) {
+    if (sim_ac_sense < 0) {
+        return false;
+    }
+    *present = sim_ac_sense != 0;
+    return true;
+}
+
+// ==================== 主机侧操作 ====================
+
+void ups_sim_reset(void) {
+    sim_millis = 0;
+    sim_mounted = false;
+    sim_suspended = false;
+    sim_remote_wakeups = 0;
+    sim_in_busy = false;
+    sim_in_len = 0;
+    sim_timer_armed = false;
+    sim_ac_sense = -1;
+    sim_event_task = false;
+    sim_event_notified = false;
+    ups_state_init();
+}
+
+void ups_sim_event_start(void) {
+    sim_event_task = true;
+}
+
+bool ups_sim_event_notify_take(void) {
+    bool notified = sim_event_notified;
+    sim_event_notified = false;
+    return notified;
+}
+
+void ups_sim_mount(void) {
+    sim_mounted = true;
+    sim_in_busy = false;
+    ups_hid_mount();
+}
+
+void ups_sim_unmount(void) {
+    sim_mounted = false;
+    sim_suspended = false;
+    sim_in_busy = false;
+    ups_hid_unmount();
+}
+
+void ups_sim_suspend(bool remote_wakeup_en) {
+    sim_suspended = true;
+    sim_remote_wakeup_en = remote_wakeup_en;
+    ups_hid_suspend(remote_wakeup_en);
+}
+
+void ups_sim_resume(void) {
+    sim_suspended = false;
+    ups_hid_resume();
+}
+
+// 与固件的 GPIO 中断相同：电平变化时投递 UPS_EVENT_AC_GPIO
+void ups_sim_ac_sense(int present) {
+    bool changed = sim_ac_sense != present;
+    sim_ac_sense = present;
+    if (changed && present >= 0) {
+        ups_event_post(UPS_EVENT_AC_GPIO);
+    }
+}
+
+uint32_t ups_sim_remote_wakeups(uint32_t* last_ms) {
+    if (last_ms != NULL) {
+        *last_ms = sim_remote_wakeup_ms;
+    }
+    return sim_remote_wakeups;
+}
+
+// 时钟推进到定时器到期时刻时准时运行回调
+void ups_sim_advance_ms(uint32_t ms) {
+    uint32_t target = sim_millis + ms;
+    while (sim_timer_armed && (int32_t)(target - sim_timer_at) >= 0) {
+        sim_millis = sim_timer_at;
+        sim_timer_armed = false;
+        ups_shutdown_timer();
+    }
+    sim_millis = target;
+}
+
+bool ups_sim_output(uint8_t instance, uint32_t* changed_ms) {
+    if (changed_ms != NULL) {
+        *changed_ms = sim_output_ms[instance];
+    }
+    return sim_output[instance];
+}
+
+uint16_t ups_sim_get_report(uint8_t report_id, uint8_t report_type, uint8_t* buffer, uint16_t wlength) {
+    uint16_t xferlen = 0;
+    if (report_id != 0 && wlength > 1) {
+        *buffer++ = report_id;
+        wlength--;
+        xferlen++;
+    }
+
+    uint16_t len = ups_hid_get_report(0, report_id, report_type, buffer, wlength);
+    return len == 0 ? 0 : xferlen + len;
+}
+
+void ups_sim_set_report(uint8_t report_id, uint8_t report_type, uint8_t const* buffer, uint16_t wlength) {
+    if (report_id != 0 && wlength > 1 && buffer[0] == report_id) {
+        buffer++;
+        wlength--;
+    }
+    ups_hid_set_report(0, report_id, report_type, buffer, wlength);
+}
+
+uint16_t ups_sim_poll_interrupt(uint8_t* buffer, uint16_t buflen) {
+    if (!sim_in_busy || sim_suspended) {
+        return 0;
+    }
+
+    uint16_t len = sim_in_len < buflen ? sim_in_len : buflen;
+    memcpy(buffer, sim_in_buf, len);
+    sim_in_busy = false;
+    ups_hid_report_complete(0);
+    return len;
+}
+
+const uint8_t* ups_sim_report_descriptor(uint16_t* len) {
+    return ups_report_descriptor(len);
+}
+
+void ups_sim_set_log(bool enabled) {
+    ups_port_log_enabled = enabled;
+}
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ups_port.h"
+#include "ups_sim.h"
+#include "ups_report.h"
+#include "ups_hid.h"
+#include "ups_battery.h"
+#include "ups_event.h"
+#include "ups_state.h"
+
+// 挂起期间的远程唤醒检查：ups_wakeup_check
+// 主机枚举后挂起总线（允许或不允许远程唤醒），挂起期间依次制造电源事件：
+//   ac_loss：市电检测输入断开；
+//   low_batt：市电断开后放电到剩余容量限制以下；
+//   imminent：市电断开时写 DelayBeforeShutdown，倒计时进入最后5秒；
+//   ac_return：市电恢复（不需要唤醒主机）；
+//   no_rwk：主机不允许远程唤醒，市电断开后主机自己恢复总线。
+// 状态任务按事件驱动方式运行（定时器每 UPS_STATE_PUBLISH_MS 投递 UPS_EVENT_TICK）。
+// 主机看到远程唤醒后按 USB 规范驱动恢复信号 20ms 再恢复总线，之后等待 10ms 恢复期，每 10ms（bInterval）轮询中断端点。
+// 输出事件到远程唤醒、到总线恢复、到主机收到 PresentStatus 的时间，以及设备自己统计的事件到报告延迟。
+// 每个场景在单独的子进程中从上电开始运行。唤醒次数和首个报告的状态位符合预期、事件到报告不超过
+// 恢复时间加一个轮询周期和一个采样周期时返回0
+
+#define HOST_RESUME_MS      20      // 主机驱动恢复信号（TDRSMDN）
+#define HOST_RECOVERY_MS    10      // 恢复后到第一次传输（TRSMRCY）
+#define HOST_POLL_MS        10      // 中断端点 bInterval
+#define LATENCY_LIMIT_MS    (HOST_RESUME_MS + HOST_RECOVERY_MS + HOST_POLL_MS + 1000 / UPS_BATTERY_SAMPLE_HZ)
+
+#define MOUNT_MS            1000
+#define PREPARE_MS          3000    // 挂起前的准备（市电断开、写倒计时）
+#define SUSPEND_MS          10000
+#define EVENT_MS            15007   // 市电输入变化时刻
+#define HOST_RESUME_AT_MS   30000   // no_rwk：主机自己恢复总线
+#define RUN_MS              600000
+
+#define BIT_AC_PRESENT      (1u << 2)
+#define BIT_BELOW_LIMIT     (1u << 4)
+#define BIT_IMMINENT        (1u << 11)
+
+typedef enum {
+    SCENARIO_AC_LOSS,
+    SCENARIO_LOW_BATT,
+    SCENARIO_IMMINENT,
+    SCENARIO_AC_RETURN,
+    SCENARIO_NO_RWK,
+    SCENARIO_COUNT,
+} scenario_t;
+
+static const char* const scenario_names[SCENARIO_COUNT] = {
+    "ac_loss", "low_batt", "imminent", "ac_return", "no_rwk",
+};
+
+typedef struct {
+    uint32_t wakeups;
+    uint32_t event_ms;          // 状态位变化（主机应该知道）的时刻，0 为没有发生
+    uint32_t wakeup_ms;         // 第一次远程唤醒
+    uint32_t resume_ms;         // 总线恢复
+    uint32_t report_ms;         // 恢复后主机收到第一个 PresentStatus
+    uint16_t report_status;
+    ups_hid_wakeup_stats_t device;
+} run_result_t;
+
+// 场景等待的状态位变化：置位的位，或清零的 ACPresent
+static uint16_t watched_bits(scenario_t s, uint16_t status) {
+    switch (s) {
+        case SCENARIO_LOW_BATT:  return status & BIT_BELOW_LIMIT;
+        case SCENARIO_IMMINENT:  return status & BIT_IMMINENT;
+        case SCENARIO_AC_RETURN: return status & BIT_AC_PRESENT;
+        default:                 return ~status & BIT_AC_PRESENT;
+    }
+}
+
+static void set_delay(uint8_t report_id, int16_t seconds) {
+    uint8_t buf[3] = { report_id, (uint8_t)seconds, (uint8_t)((uint16_t)seconds >> 8) };
+    ups_sim_set_report(report_id, UPS_HID_REPORT_TYPE_FEATURE, buf, sizeof(buf));
+}
+
+static void run(scenario_t s, run_result_t* r) {
+    uint8_t buf[1 + UPS_REPORT_MAX_LEN];
+    bool suspended = false;
+    uint32_t resume_at = 0, poll_from = 0;
+    uint32_t wakeups_seen = 0;
+    uint16_t watched_before = 0;
+
+    ups_sim_reset();
+    *r = (run_result_t){ 0 };
+    ups_sim_ac_sense(1);
+    ups_event_post(UPS_EVENT_TICK);
+
+    for (uint32_t t = 1; t <= RUN_MS; t++) {
+        ups_sim_advance_ms(1);
+
+        // 脚本
+        if (t == MOUNT_MS) {
+            ups_sim_mount();
+            poll_from = t;
+        } else if (t == PREPARE_MS && s != SCENARIO_AC_LOSS && s != SCENARIO_NO_RWK) {
+            ups_sim_ac_sense(0);
+        } else if (t == PREPARE_MS + 2000 && s == SCENARIO_LOW_BATT) {
+            ups_instances[0].remaining_capacity_limit = ups_instances[0].remaining_capacity - 1;
+        } else if (t == PREPARE_MS + 2000 && s == SCENARIO_IMMINENT) {
+            set_delay(HID_PD_DELAYBE4SHUTDOWN, 30);
+        } else if (t == SUSPEND_MS) {
+            ups_sim_suspend(s != SCENARIO_NO_RWK);
+            suspended = true;
+            watched_before = watched_bits(s, PresentStatus_to_uint16(&UPS));
+        } else if (t == EVENT_MS && (s == SCENARIO_AC_LOSS || s == SCENARIO_NO_RWK)) {
+            ups_sim_ac_sense(0);
+        } else if (t == EVENT_MS && s == SCENARIO_AC_RETURN) {
+            ups_sim_ac_sense(1);
+        } else if (t == HOST_RESUME_AT_MS && s == SCENARIO_NO_RWK) {
+            resume_at = t;
+        }
+
+        // 状态任务
+        if (t % UPS_STATE_PUBLISH_MS == 0) {
+            ups_event_post(UPS_EVENT_TICK);
+        }
+        uint32_t events = ups_event_take();
+        if (events != 0) {
+            ups_state_dispatch(events);
+        }
+        if (suspended && r->event_ms == 0 &&
+            (watched_bits(s, PresentStatus_to_uint16(&UPS)) & ~watched_before)) {
+            r->event_ms = t;
+        }
+
+        // 主机：远程唤醒后驱动恢复信号，恢复期之后按 bInterval 轮询
+        uint32_t wakeup_ms;
+        uint32_t wakeups = ups_sim_remote_wakeups(&wakeup_ms);
+        if (wakeups != wakeups_seen) {
+            wakeups_seen = wakeups;
+            if (r->wakeup_ms == 0) {
+                r->wakeup_ms = wakeup_ms;
+            }
+            if (suspended && resume_at == 0) {
+                resume_at = t + HOST_RESUME_MS;
+            }
+        }
+        if (suspended && resume_at != 0 && t == resume_at) {
+            ups_sim_resume();
+            suspended = false;
+            r->resume_ms = t;
+            poll_from = t + HOST_RECOVERY_MS;
+        }
+        if (!suspended && poll_from != 0 && t >= poll_from && (t - poll_from) % HOST_POLL_MS == 0) {
+            uint16_t len = ups_sim_poll_interrupt(buf, sizeof(buf));
+            if (len >= 3 && buf[0] == HID_PD_PRESENTSTATUS && r->resume_ms != 0 && r->report_ms == 0) {
+                r->report_ms = t;
+                r->report_status = (uint16_t)(buf[1] | buf[2] << 8);
+            }
+        }
+        if (r->report_ms != 0 || (s == SCENARIO_AC_RETURN && t > EVENT_MS + 10000)) {
+            break;
+        }
+    }
+    r->wakeups = wakeups_seen;
+    ups_hid_get_wakeup_stats(&r->device);
+}
+
+static bool run_child(scenario_t s, run_result_t* r) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        run(s, r);
+        _exit(write(fds[1], r, sizeof(*r)) == (ssize_t)sizeof(*r) ? 0 : 1);
+    }
+    close(fds[1]);
+    bool ok = pid > 0 && read(fds[0], r, sizeof(*r)) == (ssize_t)sizeof(*r);
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+    }
+    return ok;
+}
+
+static uint32_t since(uint32_t at, uint32_t from) {
+    return at != 0 && from != 0 ? at - from : 0;
+}
+
+int main(void) {
+    int errors = 0;
+    ups_sim_set_log(false);
+
+    printf("%-10s %7s %8s %13s %13s %13s %13s %7s\n", "scenario", "wakeups", "event_s",
+           "->wakeup ms", "->resume ms", "->report ms", "device ms", "status");
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        scenario_t s = (scenario_t)i;
+        run_result_t r;
+        if (!run_child(s, &r)) {
+            printf("%-10s FAIL (child)\n", scenario_names[s]);
+            errors++;
+            continue;
+        }
+        printf("%-10s %7u %8.3f %13u %13u %13u %13u  0x%04x\n", scenario_names[s], (unsigned)r.wakeups,
+               r.event_ms / 1000.0, (unsigned)since(r.wakeup_ms, r.event_ms),
+               (unsigned)since(r.resume_ms, r.event_ms), (unsigned)since(r.report_ms, r.event_ms),
+               r.device.reported ? (unsigned)(r.device.last_us / 1000) : 0, r.report_status);
+
+        bool ok;
+        switch (s) {
+            case SCENARIO_AC_RETURN:
+                ok = r.event_ms != 0 && r.wakeups == 0 && r.resume_ms == 0;
+                break;
+            case SCENARIO_NO_RWK:
+                // 主机自己恢复后，挂起期间积累的报告在恢复期之后的第一次轮询中送达
+                ok = r.event_ms != 0 && r.wakeups == 0 && r.resume_ms == HOST_RESUME_AT_MS &&
+                     r.report_ms == r.resume_ms + HOST_RECOVERY_MS && !(r.report_status & BIT_AC_PRESENT);
+                break;
+            default:
+                ok = r.event_ms != 0 && r.wakeups == 1 && r.report_ms != 0 &&
+                     (watched_bits(s, r.report_status) != 0) &&
+                     since(r.report_ms, r.event_ms) <= LATENCY_LIMIT_MS &&
+                     r.device.reported == 1 && r.device.last_us / 1000 == since(r.report_ms, r.event_ms);
+                break;
+        }
+        if (!ok) {
+            printf("  FAIL\n");
+            errors++;
+        }
+    }
+    printf("%s\n", errors == 0 ? "ok" : "FAIL");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// 电池模型：库仑计数估算剩余电量，在充满/放空端点重新学习充满容量，
+// 统计等效循环次数，并在负载阶跃时按 ΔV/ΔI 估算内阻。放电运行时间由 ups_runtime 按剩余电量估算。
+// 采样路径只有整数加法与比较，除法都放在 ups_battery_get_status() 中。
+// 每个实例（ups_instance.h）一个独立的模型，instance 不检查范围
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 采样频率（Hz），ups_battery_sample() 必须按此固定频率调用
+#define UPS_BATTERY_SAMPLE_HZ 100
+
+typedef struct {
+    uint32_t design_capacity_mah;   // 设计容量（mAh）
+    uint16_t full_voltage_mv;       // 充满判定：电池电压不低于此值
+    uint16_t taper_current_ma;      // 充满判定：充电电流降到此值以下
+    uint16_t empty_voltage_mv;      // 放空判定：带载电压不高于此值
+    uint8_t charge_efficiency;      // 充电效率（%），充电方向积分时折算
+} ups_battery_config_t;
+
+typedef struct {
+    uint8_t remaining_capacity;     // 剩余容量（%，相对充满容量）
+    uint8_t full_charge_capacity;   // 充满容量（%，相对设计容量）
+    uint16_t avg_time_to_full;      // 按最近1分钟平均充电电流估算（秒）
+    uint32_t remaining_mah;
+    uint32_t full_charge_mah;
+    uint16_t cycle_count;           // 等效循环次数（累计放出一个充满容量计一次）
+    uint16_t resistance_mohm;       // 内阻估算（mΩ），0 表示尚未测得
+    bool fully_charged;
+    bool fully_discharged;
+} ups_battery_status_t;
+
+// 初始化模型，initial_percent 为上电时假定的剩余容量
+void ups_battery_init(uint8_t instance, const ups_battery_config_t* config, uint8_t initial_percent);
+
+// 恢复持久化的学习结果（充满容量、循环次数、内阻），超出范围的值忽略
+void ups_battery_restore(uint8_t instance, uint32_t full_charge_mah, uint16_t cycle_count, uint16_t resistance_mohm);
+
+// 输入一个采样：电池电流（mA，充电为正、放电为负）和电池电压（mV）
+void ups_battery_sample(uint8_t instance, int32_t current_ma, uint16_t voltage_mv);
+
+// 计算并返回当前状态（包含除法，按发布频率调用即可）
+void ups_battery_get_status(uint8_t instance, ups_battery_status_t* status);
+
+#ifdef __cplusplus
+}
+#endif
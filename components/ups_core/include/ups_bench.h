@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 单个负载组合的统计结果，延迟单位为纳秒
+typedef struct {
+    const char* name;
+    uint32_t calls;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+    uint32_t calls_per_sec;
+} ups_bench_result_t;
+
+// 依次运行全部负载组合和DSP内核，每项 rounds 轮，结果逐行打印
+void ups_bench_run(uint32_t rounds);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+// 启动计时：记录各启动阶段第一次到达的时间（自应用启动的微秒数），
+// 衡量从上电到主机读到第一份有效报告的时间。任何任务（包括USB回调）都可以打点，
+// 已记录过的阶段只需一次原子读
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    UPS_BOOT_APP_START = 0,         // 进入 app_main
+    UPS_BOOT_USB_INSTALLED,         // TinyUSB 驱动安装完成，可以开始枚举
+    UPS_BOOT_NVS_READY,             // NVS 初始化完成（后台任务）
+    UPS_BOOT_FIRST_SAMPLE,          // 第一份ADC实测数据
+    UPS_BOOT_FIRST_PUBLISH,         // 第一次用实测数据发布报告表
+    UPS_BOOT_MOUNTED,               // 主机枚举完成
+    UPS_BOOT_FIRST_GET_REPORT,      // 第一次 GET_REPORT
+    UPS_BOOT_FIRST_VALID_REPORT,    // 第一次在实测数据发布之后的 GET_REPORT
+    UPS_BOOT_STAGES,
+} ups_boot_stage_t;
+
+// 从应用启动到第一份有效报告的预算（毫秒），不含二级引导程序时间
+#define UPS_BOOT_BUDGET_MS 500
+
+// 记录阶段到达时间，只保留第一次
+void ups_boot_mark(ups_boot_stage_t stage);
+
+// GET_REPORT 路径调用：记录第一次请求，以及实测数据发布后的第一次请求
+void ups_boot_report_served(void);
+
+// 阶段到达时间（微秒），尚未到达返回 false
+bool ups_boot_time_us(ups_boot_stage_t stage, uint32_t* time_us);
+
+// 各阶段都已到达
+bool ups_boot_complete(void);
+
+// 格式化为一行：各阶段毫秒数，未到达的显示 "-"
+int ups_boot_format(char* buffer, size_t buflen);
+
+#ifdef __cplusplus
+}
+#endif
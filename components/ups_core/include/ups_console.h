@@ -0,0 +1,56 @@
+#pragma once
+
+// 控制台：USB CDC 上的文本命令行（固件为 main/ups_console_esp.c）。
+// 输入逐字节送入，回车执行；输出为拉取式，调用者按发送 FIFO 的空余取字节，
+// 长输出（事件日志、导出流）逐条生成，不需要整份缓冲。命令：
+//   help                 命令列表
+//   status               当前报告快照、持久化和事件日志计数、各类事件的投递到发布延迟
+//   boot                 启动各阶段时间
+//   power                调频范围、总线挂起和 light sleep 时间、挂起期间的定时器唤醒延迟、
+//                        远程唤醒后事件到总线恢复和到主机收到报告的延迟
+//   journal              电源事件日志（文本）
+//   export H|J|A         二进制导出流（ups_export.h），结束后不输出提示符
+//   flood <KB>           输出指定 KB 的填充行，用于测量 CDC 满负载时的 HID 延迟
+// 执行期间收到 Ctrl-C 中止当前输出
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ups_export.h"
+#include "ups_journal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_CONSOLE_LINE_MAX 64
+#define UPS_CONSOLE_TEXT_MAX 128        // 单次生成的输出（一行或一段）
+#define UPS_CONSOLE_PROMPT   "> "
+
+typedef struct {
+    char line[UPS_CONSOLE_LINE_MAX];
+    uint8_t line_len;
+    uint8_t mode;                       // 当前输出来源
+    uint8_t step;
+    uint32_t remaining;                 // flood：剩余字节
+    ups_journal_cursor_t cursor;
+    ups_export_t export;
+    char text[UPS_CONSOLE_TEXT_MAX];
+    uint16_t text_len;
+    uint16_t text_pos;
+} ups_console_t;
+
+void ups_console_init(ups_console_t* c);
+
+// 输入一个字节（回显由主机终端负责）。输出进行中只响应 Ctrl-C
+void ups_console_input(ups_console_t* c, uint8_t byte);
+
+// 取出最多 len 字节输出，没有待发送的输出时返回 0
+size_t ups_console_read(ups_console_t* c, uint8_t* buffer, size_t len);
+
+// 有待发送的输出
+bool ups_console_busy(const ups_console_t* c);
+
+#ifdef __cplusplus
+}
+#endif
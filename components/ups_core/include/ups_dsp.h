@@ -0,0 +1,82 @@
+#pragma once
+
+// 定点DSP内核：Q15 FIR抽取、双二阶IIR、均值/有效值归约，全部按块处理。
+// ESP32-S3 上 FIR 抽取走 esp-dsp 的 PIE(SIMD) 实现，主机和其他目标使用可移植C实现。
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if defined(ESP_PLATFORM) && CONFIG_UPS_DSP_ESP_DSP
+#include "dsps_fird.h"
+#define UPS_DSP_HAVE_SIMD 1
+#else
+#define UPS_DSP_HAVE_SIMD 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_DSP_FIR_MAX_TAPS 64     // esp-dsp 要求抽头数为8的倍数
+
+typedef struct {
+    int16_t coeffs[UPS_DSP_FIR_MAX_TAPS];
+    int16_t delay[2 * UPS_DSP_FIR_MAX_TAPS];    // 双份延迟线，内循环不用取模
+    uint16_t taps;
+    uint16_t decim;
+    uint16_t pos;
+    uint16_t phase;
+#if UPS_DSP_HAVE_SIMD
+    fir_s16_t simd;
+    int16_t simd_coeffs[UPS_DSP_FIR_MAX_TAPS] __attribute__((aligned(16)));
+    int16_t simd_delay[UPS_DSP_FIR_MAX_TAPS + 8] __attribute__((aligned(16)));
+    int16_t simd_pending[UPS_DSP_FIR_MAX_TAPS];     // 上一块末尾不足 decim 个的输入
+    uint16_t simd_pending_count;
+#endif
+} ups_dsp_fir_t;
+
+// 双二阶滤波器（直接I型），系数 Q28，输出状态 Q23（Q15 多留8位小数）
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;
+    int16_t x1, x2;
+    int32_t y1, y2;
+} ups_dsp_biquad_t;
+
+// FIR 抽取器：coeffs 为 Q15，taps 和 decim 都不超过 UPS_DSP_FIR_MAX_TAPS，每 decim 个输入产生一个输出
+void ups_dsp_fir_init(ups_dsp_fir_t* fir, const int16_t* coeffs, uint16_t taps, uint16_t decim);
+
+// 抽取一块数据，返回输出样本数（out 至少 len / decim + 1）。有SIMD实现时使用SIMD，
+// len 不是 decim 的整数倍时多出的样本留到下一块，输出与C实现一致
+uint32_t ups_dsp_fir_decimate(ups_dsp_fir_t* fir, const int16_t* in, int16_t* out, uint32_t len);
+
+// 可移植C实现（基准测试对比用）
+uint32_t ups_dsp_fir_decimate_c(ups_dsp_fir_t* fir, const int16_t* in, int16_t* out, uint32_t len);
+
+// 用第一个样本填满延迟线，直流输入从第一个输出起就是稳态值（上电后第一块数据调用）
+void ups_dsp_fir_prime(ups_dsp_fir_t* fir, int16_t x);
+
+// 按 RBJ 公式设计二阶巴特沃斯低通/高通（初始化时调用，含浮点运算）
+void ups_dsp_biquad_lowpass(ups_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_hz);
+void ups_dsp_biquad_highpass(ups_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_hz);
+
+// 把状态设为输入恒为 x 时的稳态（低通输出 x，高通输出 0），避免上电时的阶跃过渡
+void ups_dsp_biquad_prime(ups_dsp_biquad_t* bq, int16_t x);
+
+// 滤波一块数据，in 与 out 可以相同
+void ups_dsp_biquad_process(ups_dsp_biquad_t* bq, const int16_t* in, int16_t* out, uint32_t len);
+
+// 块均值、平方和与有效值（Q15）。平方和用于跨块累计的有效值窗口
+int16_t ups_dsp_mean(const int16_t* in, uint32_t len);
+uint64_t ups_dsp_sum_squares(const int16_t* in, uint32_t len);
+uint16_t ups_dsp_rms(const int16_t* in, uint32_t len);
+
+// 64位整数平方根
+uint32_t ups_dsp_isqrt(uint64_t x);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+// 事件驱动调度：ADC、GPIO 中断、定时器、USB回调和关机编排调用 ups_event_post() 投递事件，
+// 状态任务空闲时无限期阻塞，被 ups_port_event_wake() 唤醒后用 ups_event_take() 一次取走全部待处理事件，
+// 交给 ups_state_dispatch() 处理。
+// 事件按类型合并为一个位集合：同类事件在处理前重复投递只算一次，投递不会失败、不占队列空间，可在中断中调用。
+// 每类事件记录合并后第一次投递的时刻，状态任务发布后统计投递到发布的延迟
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    UPS_EVENT_SAMPLE = 0,           // ADC 有新数据（补齐电池采样）
+    UPS_EVENT_TICK,                 // 周期定时器：补齐采样，按 UPS_STATE_PUBLISH_MS 发布
+    UPS_EVENT_MAINS,                // 市电检测状态变化
+    UPS_EVENT_AC_GPIO,              // 市电检测输入 GPIO 边沿
+    UPS_EVENT_BUTTON,               // BOOT 按键
+    UPS_EVENT_USB,                  // 枚举完成、总线恢复（立即推送待发的Input报告）
+    UPS_EVENT_SHUTDOWN,             // 关机编排状态变化
+    UPS_EVENT_STORE,                // 持久化参数加载完成
+    UPS_EVENT_COUNT,
+} ups_event_t;
+
+#define UPS_EVENT_BIT(event) (1u << (event))
+
+// ADC 数据块合并投递的间隔：直流通道经 5Hz 低通，20Hz 取最新结果补齐采样不丢失信息
+#define UPS_EVENT_SAMPLE_MS 50
+
+// 投递到发布的延迟统计（微秒）
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} ups_event_stats_t;
+
+// 清空待处理事件和统计（ups_state_init 调用）
+void ups_event_init(void);
+
+// 投递事件，任意任务或中断中调用
+void ups_event_post(ups_event_t event);
+
+// 取走全部待处理事件（位集合），只由状态任务调用
+uint32_t ups_event_take(void);
+
+// 状态任务发布快照后调用：events 中的每类事件按 ups_event_take() 时记下的投递时刻计一次延迟
+void ups_event_published(uint32_t events);
+
+// events 中最早一次投递的时刻（ups_event_take() 时记下，ups_port_micros），events 为空时返回当前时刻
+uint32_t ups_event_first_posted_us(uint32_t events);
+
+void ups_event_get_stats(ups_event_t event, ups_event_stats_t* stats);
+
+const char* ups_event_name(ups_event_t event);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+// 遥测导出：把遥测历史（ups_history）和电源事件日志（ups_journal）编码为紧凑的二进制流。
+// 编码器为拉取式：调用者每次取一块字节直接写入USB发送FIFO，编码直接读环形缓冲和闪存中的记录，
+// 中间不复制整份数据。主机侧解码见 host/ups_export_main.c。
+//
+// 流格式（多字节整数为小端，varint 为 LEB128，zigzag 表示有符号差值）：
+//   头部   "UPSX" 版本(u8) 采样频率(u8) 段掩码(u8)
+//   历史段 'H' 级别(u8) 周期秒(varint) 起始序号(varint)，
+//          每点：序号差(varint, ≥1，跳过的点为读取时已被覆盖) 电压均值差(zigzag) 均值-最小(varint) 最大-均值(varint)
+//                负载均值差(zigzag) 均值-最小(varint) 最大-均值(varint) 电流均值差(zigzag) 市电均值差(zigzag)
+//                状态异或(varint)
+//          结束：序号差 0，随后 CRC-16(u16，从 'H' 到结束标记)
+//   日志段 'J'，每条：序号差(varint, ≥1) 时间差(zigzag) 事件(u8) 详情(u8) 状态异或(varint) 电压差(zigzag)，
+//          结束：序号差 0，随后 CRC-16
+//   结束   'E'
+// 差值都相对同一段中的上一条（第一条相对全零）
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "ups_history.h"
+#include "ups_journal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_EXPORT_VERSION 1
+
+// 段掩码
+#define UPS_EXPORT_HISTORY 0x01
+#define UPS_EXPORT_JOURNAL 0x02
+
+// 导出内容（控制台命令 export 的参数）：'H' 历史、'J' 事件日志、'A' 全部
+#define UPS_EXPORT_CMD_HISTORY 'H'
+#define UPS_EXPORT_CMD_JOURNAL 'J'
+#define UPS_EXPORT_CMD_ALL     'A'
+
+// 单个条目编码后的最大长度
+#define UPS_EXPORT_ITEM_MAX 48
+
+typedef struct {
+    uint8_t sections;
+    uint8_t stage;
+    uint8_t tier;
+    uint32_t index;                 // 历史段：下一个点的序号
+    uint32_t end;                   // 历史段：开始时的写入计数（之后写入的点不导出）
+    uint32_t prev_index;
+    ups_history_point_t prev_point;
+    ups_journal_cursor_t cursor;
+    ups_journal_record_t prev_record;
+    uint16_t crc;
+    uint8_t item[UPS_EXPORT_ITEM_MAX];
+    uint8_t item_len;
+    uint8_t item_pos;
+} ups_export_t;
+
+// 参数字符对应的段掩码，无效时返回 0
+uint8_t ups_export_command(uint8_t command);
+
+// 开始一次导出
+void ups_export_begin(ups_export_t* x, uint8_t sections);
+
+// 取出最多 len 字节，返回 0 表示导出结束
+size_t ups_export_read(ups_export_t* x, uint8_t* buffer, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
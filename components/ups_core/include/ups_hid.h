@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 报告类型，取值与HID规范及TinyUSB的 hid_report_type_t 相同
+#define UPS_HID_REPORT_TYPE_INPUT    1
+#define UPS_HID_REPORT_TYPE_OUTPUT   2
+#define UPS_HID_REPORT_TYPE_FEATURE  3
+
+// HID 协议类型定义
+#define HID_PROTOCOL_NONE 0
+
+// 与设备栈无关的HID请求处理，TinyUSB回调直接转发到这里
+uint16_t ups_hid_get_report(uint8_t instance, uint8_t report_id,
+                            uint8_t report_type, uint8_t* buffer, uint16_t reqlen);
+void ups_hid_set_report(uint8_t instance, uint8_t report_id,
+                        uint8_t report_type, uint8_t const* buffer, uint16_t bufsize);
+void ups_hid_set_protocol(uint8_t instance, uint8_t protocol);
+void ups_hid_report_complete(uint8_t instance);
+void ups_hid_mount(void);
+void ups_hid_unmount(void);
+
+// 总线挂起/恢复（TinyUSB tud_suspend_cb/tud_resume_cb）
+void ups_hid_suspend(bool remote_wakeup_en);
+void ups_hid_resume(void);
+
+// 总线是否挂起
+bool ups_hid_suspended(void);
+
+// 挂起期间发生需要主机立即知道的电源事件（市电断开、电量低、即将关机）时由状态任务调用：
+// 主机允许时发出远程唤醒，恢复后推送待发的Input报告。status 为当前 PresentStatus（写入日志），
+// event_us 为触发事件的投递时刻（ups_port_micros），用于统计延迟。已发出唤醒返回 true
+bool ups_hid_remote_wakeup(uint16_t status, uint32_t event_us);
+
+// 远程唤醒延迟（微秒）：从事件投递到总线恢复、到主机收到 PresentStatus 中断报告。
+// wakeups 由状态任务写入，其余由设备栈任务写入，读者允许读到不一致的中间值
+typedef struct {
+    uint32_t wakeups;           // 发出的远程唤醒
+    uint32_t reported;          // 唤醒后主机收到报告的次数
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t resumed;           // 唤醒后主机恢复总线的次数，以及事件到总线恢复的延迟
+    uint32_t resume_max_us;
+    uint64_t resume_total_us;
+} ups_hid_wakeup_stats_t;
+
+void ups_hid_get_wakeup_stats(ups_hid_wakeup_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+// 遥测历史：固定内存的多分辨率环形缓冲，1秒×10分钟、1分钟×24小时、15分钟×30天。
+// 每个采样只累加到最细一级的区间累加器；区间结束时写入该级环形缓冲，
+// 并把原始和/最值并入上一级累加器，每级的 min/max/mean 都按原始采样精确计算，插入为 O(1)。
+// 状态任务写入；读取可以在其他任务中进行，读到被覆盖的点时返回 false
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    UPS_HISTORY_1S = 0,
+    UPS_HISTORY_1MIN,
+    UPS_HISTORY_15MIN,
+    UPS_HISTORY_TIERS,
+} ups_history_tier_t;
+
+// 各级可读点数：10分钟、24小时、30天。环形缓冲每级多一个槽，留给正在写入的点
+#define UPS_HISTORY_1S_POINTS    600
+#define UPS_HISTORY_1MIN_POINTS  1440
+#define UPS_HISTORY_15MIN_POINTS 2880
+#define UPS_HISTORY_SLOTS(points) ((points) + 1)
+
+// 一个采样（按 UPS_BATTERY_SAMPLE_HZ 输入）
+typedef struct {
+    uint16_t battery_mv;
+    int16_t battery_ma;             // 充电为正
+    uint16_t load_ma;
+    uint16_t mains_dv;              // 市电有效值（0.1V），没有检测时为 0
+    uint16_t status;                // PresentStatus
+} ups_history_sample_t;
+
+// 一个区间的汇总（18字节）
+typedef struct {
+    uint16_t battery_mv_min;
+    uint16_t battery_mv_max;
+    uint16_t battery_mv_mean;
+    uint16_t load_ma_min;
+    uint16_t load_ma_max;
+    uint16_t load_ma_mean;
+    int16_t battery_ma_mean;
+    uint16_t mains_dv_mean;
+    uint16_t status;                // 区间内最后一个采样的 PresentStatus
+} ups_history_point_t;
+
+// 环形缓冲总内存（字节），不含累加器
+#define UPS_HISTORY_BYTES ((UPS_HISTORY_SLOTS(UPS_HISTORY_1S_POINTS) + UPS_HISTORY_SLOTS(UPS_HISTORY_1MIN_POINTS) + \
+                            UPS_HISTORY_SLOTS(UPS_HISTORY_15MIN_POINTS)) * sizeof(ups_history_point_t))
+
+void ups_history_init(void);
+
+// 输入一个采样，按 UPS_BATTERY_SAMPLE_HZ 固定频率调用
+void ups_history_sample(const ups_history_sample_t* sample);
+
+// 每个点覆盖的秒数
+uint32_t ups_history_period_s(ups_history_tier_t tier);
+
+// 该级累计写入的点数；最新的点覆盖 [(written-1)*period, written*period) 秒（自第一次采样起）
+uint32_t ups_history_written(ups_history_tier_t tier);
+
+// 当前可读的点数（写满后为该级的点数）
+uint32_t ups_history_count(ups_history_tier_t tier);
+
+// 按写入序号读取一个点（可读范围为 [written-count, written)），
+// 点尚未写入、已被覆盖或读取期间被覆盖时返回 false
+bool ups_history_get(ups_history_tier_t tier, uint32_t index, ups_history_point_t* point);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+// 多实例：每个电池组/输出是一个实例，在同一个 HID 接口中各占一个 Power Device 应用集合。
+// 报告ID按实例分段：实例 n 的报告ID = n * 64 + 单实例报告ID（实例0与单实例时相同），
+// 请求按 (报告ID >> 6, 报告ID & 63) 直接索引，与实例数无关。
+// 每个实例的状态、电池模型和报告快照都是固定大小的静态数组项，实例数在编译期确定
+
+#include <stdint.h>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#endif
+
+#if defined(CONFIG_UPS_INSTANCE_COUNT)
+#define UPS_INSTANCE_COUNT CONFIG_UPS_INSTANCE_COUNT
+#elif !defined(UPS_INSTANCE_COUNT)
+#define UPS_INSTANCE_COUNT 1
+#endif
+
+// 报告ID为8位，单实例报告ID不超过 0x3F，最多4个实例
+#define UPS_INSTANCE_ID_SHIFT 6
+#define UPS_INSTANCE_MAX (256 >> UPS_INSTANCE_ID_SHIFT)
+
+_Static_assert(UPS_INSTANCE_COUNT >= 1 && UPS_INSTANCE_COUNT <= UPS_INSTANCE_MAX, "UPS_INSTANCE_COUNT");
+
+#define UPS_INSTANCE_REPORT_ID(instance, id) ((uint8_t)(((instance) << UPS_INSTANCE_ID_SHIFT) | (id)))
+#define UPS_REPORT_INSTANCE(report_id)       ((uint8_t)((report_id) >> UPS_INSTANCE_ID_SHIFT))
+#define UPS_REPORT_LOCAL_ID(report_id)       ((uint8_t)((report_id) & ((1u << UPS_INSTANCE_ID_SHIFT) - 1)))
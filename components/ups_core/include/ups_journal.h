@@ -0,0 +1,94 @@
+#pragma once
+
+// 电源事件日志：专用闪存分区中的只追加环形日志，定长16字节记录，带序号和CRC。
+// 按扇区循环写入（擦除最旧的扇区），磨损均匀分布；写到扇区第一个槽位前先擦除该扇区。
+// 掉电时最多丢失正在写的一条记录（CRC不符，恢复时跳过）或正在擦除的扇区。
+// 启动恢复只读各扇区的第一条记录和最新扇区本身。
+// 状态任务用 ups_journal_post() 把事件放入内存队列，闪存写入在后台任务中进行。
+// 闪存访问通过 ups_journal_flash_t，固件为 esp_partition（main/ups_store_esp.c），主机为内存模拟
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_JOURNAL_SECTOR_SIZE 4096
+#define UPS_JOURNAL_RECORD_SIZE 16
+#define UPS_JOURNAL_QUEUE_SIZE  32      // 等待写入的事件数，必须是2的幂
+
+typedef enum {
+    UPS_JOURNAL_BOOT = 1,               // 上电，detail 为复位原因
+    UPS_JOURNAL_STATUS,                 // PresentStatus 位变化，detail 为位号，最高位为新值
+} ups_journal_event_t;
+
+#define UPS_JOURNAL_STATUS_SET 0x80
+
+// 闪存记录（小端，16字节）
+typedef struct {
+    uint32_t seq;                       // 从1开始，跨重启递增
+    uint32_t time_ms;                   // 自启动的毫秒数
+    uint8_t event;                      // ups_journal_event_t
+    uint8_t detail;
+    uint16_t status;                    // 事件后的 PresentStatus
+    uint16_t battery_mv;
+    uint16_t crc;                       // 前14字节的 CRC-16/CCITT
+} ups_journal_record_t;
+
+_Static_assert(sizeof(ups_journal_record_t) == UPS_JOURNAL_RECORD_SIZE, "journal record layout");
+
+// 闪存操作：偏移相对分区起点，写入只能把1改成0，擦除以扇区为单位（结果为全 0xFF）
+typedef struct {
+    uint32_t size;                      // 分区大小，至少2个扇区
+    bool (*read)(uint32_t offset, void* buffer, uint32_t len);
+    bool (*write)(uint32_t offset, const void* data, uint32_t len);
+    bool (*erase_sector)(uint32_t offset);
+} ups_journal_flash_t;
+
+// 读取游标：从最旧的记录开始按序号递增读取
+typedef struct {
+    uint32_t sector;
+    uint32_t slot;
+    uint32_t sectors_left;
+    uint32_t last_seq;
+} ups_journal_cursor_t;
+
+// 清空事件队列和挂载状态（上电时调用一次）
+void ups_journal_init(void);
+
+// 状态任务：放入一条事件（队列满时丢弃并计数）
+void ups_journal_post(uint8_t event, uint8_t detail, uint16_t status, uint16_t battery_mv);
+
+// 写入任务：恢复扫描，找到写入位置和下一个序号
+bool ups_journal_mount(const ups_journal_flash_t* flash);
+
+// 写入任务：把队列中的事件写入闪存，闪存出错时返回 false（事件留在队列中）
+bool ups_journal_flush(void);
+
+// 已挂载时的下一个序号和可能保存的记录数上限
+uint32_t ups_journal_next_seq(void);
+uint32_t ups_journal_capacity(void);
+
+// 累计丢弃的事件数（队列满）
+uint32_t ups_journal_dropped(void);
+
+// 按时间顺序读取，可在写入任务以外的任务中进行（遥测导出）。
+// 读取期间最旧的扇区可能被回收，游标只返回序号递增的有效记录
+void ups_journal_begin(ups_journal_cursor_t* cursor);
+bool ups_journal_next(ups_journal_cursor_t* cursor, ups_journal_record_t* record);
+
+// CRC-16/CCITT（初值 0xFFFF）；_update 用于分段计算
+uint16_t ups_journal_crc16(const void* data, size_t len);
+uint16_t ups_journal_crc16_update(uint16_t crc, const void* data, size_t len);
+
+// PresentStatus 位的名称（位号 0-15）
+const char* ups_journal_status_name(uint8_t bit);
+
+// 格式化为一行文本
+int ups_journal_format(const ups_journal_record_t* record, char* buffer, size_t buflen);
+
+#ifdef __cplusplus
+}
+#endif
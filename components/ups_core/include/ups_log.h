@@ -0,0 +1,54 @@
+#pragma once
+
+// 延迟日志：USB回调只写入定长二进制记录，由低优先级任务格式化输出，
+// 回调中不做任何格式化和串口I/O。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_LOG_RING_SIZE 64    // 记录条数，必须是2的幂
+
+typedef enum {
+    UPS_LOG_GET_BAD_TYPE = 1,   // GET_REPORT 不支持的报告类型
+    UPS_LOG_GET_UNKNOWN,        // GET_REPORT 未知报告ID
+    UPS_LOG_GET_SHORT,          // GET_REPORT 请求长度不足
+    UPS_LOG_SET,                // SET_REPORT 已处理，value 为解析出的配置值
+    UPS_LOG_SET_UNKNOWN,        // SET_REPORT 未知报告ID
+    UPS_LOG_SET_PROTOCOL,       // SET_PROTOCOL，value 为协议
+    UPS_LOG_MOUNT,              // 枚举完成
+    UPS_LOG_UNMOUNT,            // 断开或总线复位
+    UPS_LOG_SUSPEND,            // 总线挂起，value 为主机是否允许远程唤醒
+    UPS_LOG_RESUME,             // 总线恢复
+    UPS_LOG_REMOTE_WAKEUP,      // 挂起期间因电源事件唤醒主机，value 为 PresentStatus
+} ups_log_event_t;
+
+// 定长记录
+typedef struct {
+    uint32_t timestamp_ms;
+    uint8_t event;              // ups_log_event_t
+    uint8_t report_id;
+    uint8_t report_type;
+    uint16_t len;               // 请求长度
+    uint16_t value;
+} ups_log_record_t;
+
+// 写入一条记录（无锁，多写者安全）；满时丢弃并计数
+void ups_log_record(uint8_t event, uint8_t report_id, uint8_t report_type, uint16_t len, uint16_t value);
+
+// 取出一条记录（只允许单一消费者任务调用），没有记录时返回 false
+bool ups_log_pop(ups_log_record_t* record);
+
+// 累计丢弃的记录数
+uint32_t ups_log_dropped(void);
+
+// 把记录格式化为一行文本
+int ups_log_format(const ups_log_record_t* record, char* buffer, size_t buflen);
+
+#ifdef __cplusplus
+}
+#endif
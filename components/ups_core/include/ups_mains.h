@@ -0,0 +1,61 @@
+#pragma once
+
+// 市电监测：对去直流后的市电检测通道（Q15）逐样本跟踪过零点，按半周计算真有效值和周期，
+// 并按跟踪到的相位把每个样本与标称正弦包络比较，停电、欠压、过压在半周内判定。
+// 由 ups_sense 的消费任务调用，结果经双缓冲发布给状态任务
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    UPS_MAINS_UNKNOWN = 0,          // 尚未锁定（上电或输入标定未完成）
+    UPS_MAINS_NORMAL,
+    UPS_MAINS_BROWNOUT,             // 欠压
+    UPS_MAINS_SURGE,                // 过压
+    UPS_MAINS_OUTAGE,               // 停电
+} ups_mains_state_t;
+
+typedef struct {
+    uint16_t nominal_cv;            // 标称电压（厘伏），0 表示锁定后按实测自动选择
+    uint8_t nominal_hz;             // 标称频率 50/60，0 表示锁定后自动选择
+    uint8_t outage_pct;             // 瞬时值低于标称包络的此比例判停电
+    uint8_t brownout_pct;           // 低于此比例判欠压
+    uint8_t surge_pct;              // 高于此比例判过压
+    uint8_t frequency_tol_pct;      // 频率偏离标称超过此比例判电压不稳
+    uint8_t recover_half_cycles;    // 锁定或恢复正常需要连续合格的半周数（至少2）
+} ups_mains_config_t;
+
+typedef struct {
+    ups_mains_state_t state;
+    bool frequency_ok;              // 频率在容差内
+    uint16_t rms_cv;                // 最近一个半周的有效值（厘伏）
+    uint16_t frequency_chz;         // 最近一个整周的频率（0.01Hz）
+    uint16_t nominal_cv;            // 标称电压（配置值或自动选择的结果）
+    uint8_t nominal_hz;
+    uint32_t events;                // 状态变化次数
+    uint32_t event_sample;          // 最近一次状态变化时的样本序号
+} ups_mains_status_t;
+
+// 初始化判定参数（状态任务启动时调用）
+void ups_mains_init(const ups_mains_config_t* config);
+
+// 设置输入：每秒样本数和每个 Q15 计数对应的市电电压（厘伏，Q16）。
+// 由采集模块初始化时调用，会复位相位跟踪
+void ups_mains_set_input(uint32_t sample_hz, int32_t cv_per_count_q16);
+
+// 处理一块去直流后的样本。只允许单一消费任务调用
+void ups_mains_process(const int16_t* samples, uint32_t len);
+
+// 读取最近发布的状态，可在任意任务调用；尚未处理过数据时返回 false
+bool ups_mains_latest(ups_mains_status_t* status);
+
+// 已处理的样本总数（消费任务内使用，回放测量延迟用）
+uint32_t ups_mains_sample_count(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 初始化中断IN报告通知
+void ups_notify_init(void);
+
+// 总线复位/重新枚举后丢弃未完成的传输和排队的报告
+void ups_notify_reset(void);
+
+// 枚举完成后把全部Input报告标记为待发，主机一打开中断端点就收到当前状态
+void ups_notify_resync(void);
+
+// 对比最新发布的快照与上次发送的值，只推送变化的Input报告。
+// 在 ups_report_publish() 之后由写者任务调用
+void ups_notify_check(void);
+
+// 中断IN传输完成，发送下一个待发报告（设备栈任务中调用）。返回完成的报告ID
+uint8_t ups_notify_report_complete(void);
+
+// 总线恢复后发送挂起期间积累的待发报告（设备栈任务中调用）
+void ups_notify_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
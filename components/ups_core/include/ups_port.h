@@ -0,0 +1,87 @@
+#pragma once
+
+// 平台接口：ups_core 只通过这里访问时间、日志和USB设备栈。
+// 固件由 main/ups_port_esp.c 实现，主机构建由 host/ups_sim.c 实现。
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#define UPS_LOGI(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define UPS_LOGW(tag, fmt, ...) ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define UPS_LOGE(tag, fmt, ...) ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#else
+#include <stdio.h>
+extern bool ups_port_log_enabled;
+#define UPS_LOG_HOST(level, tag, fmt, ...) \
+    do { if (ups_port_log_enabled) printf(level " (%s) " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+#define UPS_LOGI(tag, fmt, ...) UPS_LOG_HOST("I", tag, fmt, ##__VA_ARGS__)
+#define UPS_LOGW(tag, fmt, ...) UPS_LOG_HOST("W", tag, fmt, ##__VA_ARGS__)
+#define UPS_LOGE(tag, fmt, ...) UPS_LOG_HOST("E", tag, fmt, ##__VA_ARGS__)
+#endif
+
+// 单调毫秒计数
+uint32_t ups_port_millis(void);
+
+// 自应用启动的微秒数（启动计时用）
+uint32_t ups_port_micros(void);
+
+// 高精度计数器（固件为CPU周期，主机为纳秒）及其每微秒计数，用于基准测试
+uint32_t ups_port_cycles(void);
+uint32_t ups_port_cycles_per_us(void);
+
+// ups_port_cycles() 的单位名（"cycles" 或 "ns"），基准测试输出用
+const char* ups_port_cycles_unit(void);
+
+// USB设备栈：枚举状态、中断IN端点空闲、发送Input报告
+bool ups_port_hid_mounted(void);
+bool ups_port_hid_ready(void);
+bool ups_port_hid_send(uint8_t report_id, const void* data, uint16_t len);
+
+// 总线挂起时发出远程唤醒信号，设备栈没有挂起或主机不允许时返回 false
+bool ups_port_hid_remote_wakeup(void);
+
+// 实例的负载输出控制（关机/重启编排），上电时由 ups_shutdown_init 打开
+void ups_port_output_set(uint8_t instance, bool on);
+
+// 关机编排定时器：delay_ms 后调用一次 ups_shutdown_timer()，替换之前的安排，UINT32_MAX 表示取消。
+// 只在 ups_shutdown_timer() 中调用；其他任务用 ups_port_shutdown_kick() 让回调尽快运行一次。
+// 两者的回调必须在同一个上下文中串行执行
+void ups_port_shutdown_timer(uint32_t delay_ms);
+void ups_port_shutdown_kick(void);
+
+// 唤醒状态任务（ups_event_post 在之前没有待处理事件时调用，可能在中断中，不能阻塞）
+void ups_port_event_wake(void);
+
+// 市电检测输入（GPIO 数字信号）：没有配置时返回 false，由 ADC 市电检测或模拟数据决定 ACPresent
+bool ups_port_ac_sense(bool* present);
+
+// 电源管理统计（控制台 power 命令）
+typedef struct {
+    uint16_t cpu_max_mhz;           // 动态调频范围
+    uint16_t cpu_min_mhz;
+    bool light_sleep;               // 总线挂起期间允许自动 light sleep
+    bool suspended;
+    uint32_t suspends;
+    uint64_t suspended_us;          // 累计挂起时间（含当前这次）
+    uint64_t sleep_us;              // 累计 light sleep 时间
+    uint32_t sleeps;
+    uint32_t wakes;                 // 挂起期间的定时器唤醒次数
+    uint32_t wake_max_us;           // 定时器回调相对预定时刻的延迟：退出 light sleep 和调度
+    uint64_t wake_total_us;
+} ups_port_power_t;
+
+// 没有启用电源管理时返回 false
+bool ups_port_power(ups_port_power_t* power);
+
+// 唤醒持久化写入任务（ups_store 暂存了新快照、ups_journal 有新事件时调用，不能阻塞）
+void ups_port_store_kick(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include "ups_instance.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 报告ID定义
+#define HID_PD_IPRODUCT              0x01 // FEATURE ONLY
+#define HID_PD_SERIAL                0x02 // FEATURE ONLY
+#define HID_PD_MANUFACTURER          0x03 // FEATURE ONLY
+#define IDEVICECHEMISTRY             0x04
+#define IOEMVENDOR                   0x05
+
+#define HID_PD_RECHARGEABLE          0x06 // FEATURE ONLY
+#define HID_PD_PRESENTSTATUS         0x07 // INPUT OR FEATURE(required by Windows)
+#define HID_PD_REMAINTIMELIMIT       0x08
+#define HID_PD_MANUFACTUREDATE       0x09
+#define HID_PD_CONFIGVOLTAGE         0x0A // 10 FEATURE ONLY
+#define HID_PD_VOLTAGE               0x0B // 11 INPUT (NA) OR FEATURE(implemented)
+#define HID_PD_REMAININGCAPACITY     0x0C // 12 INPUT OR FEATURE(required by Windows)
+#define HID_PD_RUNTIMETOEMPTY        0x0D
+#define HID_PD_FULLCHARGECAPACITY    0x0E // 14 FEATURE ONLY. Last Full Charge Capacity
+#define HID_PD_WARNCAPACITYLIMIT     0x0F
+#define HID_PD_CPCTYGRANULARITY1     0x10
+#define HID_PD_REMNCAPACITYLIMIT     0x11
+#define HID_PD_DELAYBE4SHUTDOWN      0x12 // 18 FEATURE ONLY
+#define HID_PD_DELAYBE4REBOOT        0x13
+#define HID_PD_AUDIBLEALARMCTRL      0x14 // 20 INPUT OR FEATURE
+#define HID_PD_CURRENT               0x15 // 21 FEATURE ONLY
+#define HID_PD_CAPACITYMODE          0x16
+#define HID_PD_DESIGNCAPACITY        0x17
+#define HID_PD_CPCTYGRANULARITY2     0x18
+#define HID_PD_CONFIGFREQUENCY       0x19 // 25 FEATURE ONLY
+#define HID_PD_AVERAGETIME2FULL      0x1A
+#define HID_PD_AVERAGECURRENT        0x1B
+#define HID_PD_AVERAGETIME2EMPTY     0x1C
+
+#define HID_PD_IDEVICECHEMISTRY      0x1F // Feature
+#define HID_PD_IOEMINFORMATION       0x20 // Feature
+
+// 字符串索引定义
+#define IMANUFACTURER               0x01
+#define IPRODUCT                    0x02
+#define ISERIAL                     0x03
+
+// 报告表按单实例ID直接索引，ID 0 保留。以下接口的 report_id 都带实例号（ups_instance.h），
+// 实例0的报告ID就是上面的定义
+#define UPS_REPORT_ID_MAX            HID_PD_IOEMINFORMATION
+#define UPS_REPORT_MAX_LEN           2    // 单个报告负载最大字节数（不含Report ID）
+
+_Static_assert(UPS_REPORT_ID_MAX < (1u << UPS_INSTANCE_ID_SHIFT), "report ID range per instance");
+
+// 可选编码器：请求时动态生成负载，返回写入的字节数。report_id 带实例号
+typedef uint16_t (*ups_report_encoder_t)(uint8_t report_id, uint8_t* buffer, uint16_t reqlen);
+
+// 报告表项，由 ups_report_schema.h 在编译期生成
+typedef struct {
+    uint8_t len;                    // 负载长度，0 表示描述符中没有该报告
+    uint8_t offset;                 // 在预序列化数据区中的偏移（小端数据）
+} ups_report_entry_t;
+
+// 按结构表写入全部报告的初值并发布
+void ups_report_init(void);
+
+// 报告描述符（长度 UPS_HID_REPORT_DESCRIPTOR_LEN），由结构表生成，ups_report_init 中第一次生成。
+// len 非空时写入实际长度
+const uint8_t* ups_report_descriptor(uint16_t* len);
+
+// 为报告挂接请求时编码器（仅在初始化阶段调用），非空时优先于预序列化数据。
+// report_id 为单实例ID，所有实例共用同一个编码器
+void ups_report_set_encoder(uint8_t report_id, ups_report_encoder_t encode);
+
+// 按描述符中的长度把数值写成小端负载。只写入写者私有的暂存区，
+// 调用 ups_report_publish() 后才对读者可见。只允许单一写者任务调用
+void ups_report_set(uint8_t report_id, uint32_t value);
+
+// 原子发布暂存区中全部实例的报告（双缓冲 + 序列号），读者永不阻塞
+void ups_report_publish(void);
+
+// 报告负载长度，未定义返回 0
+uint8_t ups_report_len(uint8_t report_id);
+
+// GET_REPORT 快速路径：返回写入字节数，未知ID或长度不足返回 0。
+// 可在任意任务中调用，读取最近一次发布的一致快照
+uint16_t ups_report_get(uint8_t report_id, uint8_t* buffer, uint16_t reqlen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+#pragma once
+
+// 报告结构表：报告描述符、每个ID的负载长度和序列化偏移都从这里在编译期生成，
+// 描述符与负载不可能不一致。新增或修改报告只改这一处。
+
+#include "ups_report.h"
+
+// 用途页面
+#define HID_PAGE_POWER_DEVICE        0x84
+#define HID_PAGE_BATTERY_SYSTEM      0x85
+
+// 单位（HID 4字节单位编码）
+#define HID_UNIT_NONE                0x00000000
+#define HID_UNIT_SECONDS             0x00001001
+#define HID_UNIT_CENTIVOLTS          0x00F0D121
+#define HID_UNIT_AMPERES             0x00100001  // 配合指数 0x0E 为厘安
+#define HID_UNIT_HERTZ               0x0000F001
+
+// Main item 标志
+#define HID_IO_CONST_NONVOL          0x23 // Const, Var, Abs, NonVol
+#define HID_IO_DATA_NONVOL           0x22 // Data, Var, Abs, NonVol
+#define HID_IO_CONST_VOL_83          0x83 // Const, Var, Abs, Vol
+#define HID_IO_CONST_VOL             0xA3 // Const, Var, Abs, No Null, Vol
+#define HID_IO_DATA_VOL              0xA2 // Data, Var, Abs, No Null, Vol
+
+// 报告列表，顺序即描述符中的顺序
+//   STR(id, page, usage, string_index, feature)
+//       8位字符串索引报告，负载就是字符串索引
+//   FEAT(id, page, usage, bits, logical_min, logical_max, unit, unit_exp, feature, default)
+//       只有Feature的数值报告
+//   INFEAT(id, page, usage, bits, logical_min, logical_max, unit, unit_exp, input, feature, default)
+//       同时有Input和Feature的数值报告，可通过中断端点推送
+// default 为上电初值，标注“运行时”的由状态任务刷新
+#define UPS_REPORT_SCHEMA(STR, FEAT, INFEAT) \
+    /* ==================== 信息类特性 ==================== */ \
+    STR(HID_PD_IPRODUCT,          HID_PAGE_POWER_DEVICE,  0xFE, IPRODUCT,         HID_IO_CONST_NONVOL) /* 产品字符串 */ \
+    STR(HID_PD_SERIAL,            HID_PAGE_POWER_DEVICE,  0xFF, ISERIAL,          HID_IO_CONST_NONVOL) /* 序列号字符串 */ \
+    STR(HID_PD_MANUFACTURER,      HID_PAGE_POWER_DEVICE,  0xFD, IMANUFACTURER,    HID_IO_CONST_NONVOL) /* 制造商字符串 */ \
+    /* ==================== 电池系统特性 ==================== */ \
+    FEAT(HID_PD_RECHARGEABLE,     HID_PAGE_BATTERY_SYSTEM, 0x8B, 8, 0, 255, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_NONVOL, 0x01)                                                  /* 可充电：是 */ \
+    STR(HID_PD_IDEVICECHEMISTRY,  HID_PAGE_BATTERY_SYSTEM, 0x89, IDEVICECHEMISTRY, HID_IO_CONST_NONVOL) /* 电池化学类型 */ \
+    STR(HID_PD_IOEMINFORMATION,   HID_PAGE_BATTERY_SYSTEM, 0x8F, IOEMVENDOR,       HID_IO_CONST_NONVOL) /* OEM信息 */ \
+    FEAT(HID_PD_CAPACITYMODE,     HID_PAGE_BATTERY_SYSTEM, 0x2C, 8, 0, 255, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_NONVOL, 0x01)                                                  /* 容量模式 */ \
+    FEAT(HID_PD_CPCTYGRANULARITY1, HID_PAGE_BATTERY_SYSTEM, 0x8D, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_DATA_NONVOL, 1)                                                      /* 容量粒度1：1% */ \
+    FEAT(HID_PD_CPCTYGRANULARITY2, HID_PAGE_BATTERY_SYSTEM, 0x8E, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_NONVOL, 0)                                                     /* 容量粒度2 */ \
+    FEAT(HID_PD_FULLCHARGECAPACITY, HID_PAGE_BATTERY_SYSTEM, 0x67, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_VOL_83, 0)                                                     /* 充满电容量（运行时） */ \
+    FEAT(HID_PD_DESIGNCAPACITY,   HID_PAGE_BATTERY_SYSTEM, 0x83, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_VOL_83, 0)                                                     /* 设计容量（运行时） */ \
+    /* ==================== 电池容量与状态数据 ==================== */ \
+    INFEAT(HID_PD_REMAININGCAPACITY, HID_PAGE_BATTERY_SYSTEM, 0x66, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+           HID_IO_CONST_VOL, HID_IO_CONST_VOL, 0)                                    /* 剩余容量（运行时） */ \
+    FEAT(HID_PD_WARNCAPACITYLIMIT, HID_PAGE_BATTERY_SYSTEM, 0x8C, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_DATA_VOL, 20)                                                        /* 警告容量限制：20% */ \
+    FEAT(HID_PD_REMNCAPACITYLIMIT, HID_PAGE_BATTERY_SYSTEM, 0x29, 8, 0, 100, HID_UNIT_NONE, 0x00, \
+         HID_IO_DATA_VOL, 10)                                                        /* 剩余容量限制：10% */ \
+    /* ==================== 时间相关数据 ==================== */ \
+    FEAT(HID_PD_MANUFACTUREDATE,  HID_PAGE_BATTERY_SYSTEM, 0x85, 16, 0, 65535, HID_UNIT_NONE, 0x00, \
+         HID_IO_CONST_VOL, 0)                                                        /* 生产日期（运行时） */ \
+    FEAT(HID_PD_AVERAGETIME2FULL, HID_PAGE_BATTERY_SYSTEM, 0x6A, 16, 0, 65535, HID_UNIT_SECONDS, 0x00, \
+         HID_IO_CONST_VOL, 0)                                                        /* 平均充满时间（运行时） */ \
+    INFEAT(HID_PD_AVERAGETIME2EMPTY, HID_PAGE_BATTERY_SYSTEM, 0x69, 16, 0, 65535, HID_UNIT_SECONDS, 0x00, \
+           HID_IO_CONST_VOL, HID_IO_CONST_VOL, 0)                                    /* 平均放空时间（运行时） */ \
+    INFEAT(HID_PD_RUNTIMETOEMPTY, HID_PAGE_BATTERY_SYSTEM, 0x68, 16, 0, 65535, HID_UNIT_SECONDS, 0x00, \
+           HID_IO_CONST_VOL, HID_IO_CONST_VOL, 0)                                    /* 运行至空时间（运行时） */ \
+    INFEAT(HID_PD_REMAINTIMELIMIT, HID_PAGE_BATTERY_SYSTEM, 0x2A, 16, 120, 1380, HID_UNIT_SECONDS, 0x00, \
+           HID_IO_DATA_NONVOL, HID_IO_DATA_VOL, 120)                                 /* 剩余时间限制：120秒 */ \
+    /* ==================== 电源设备控制 ==================== */ \
+    FEAT(HID_PD_DELAYBE4SHUTDOWN, HID_PAGE_POWER_DEVICE, 0x57, 16, -32768, 32767, HID_UNIT_SECONDS, 0x00, \
+         HID_IO_DATA_VOL, -1)                                                        /* 关机前延迟（ups_shutdown，-1 无倒计时） */ \
+    FEAT(HID_PD_DELAYBE4REBOOT,   HID_PAGE_POWER_DEVICE, 0x55, 16, -32768, 32767, HID_UNIT_SECONDS, 0x00, \
+         HID_IO_DATA_VOL, -1)                                                        /* 重启前延迟（ups_shutdown，-1 无倒计时） */ \
+    FEAT(HID_PD_CONFIGVOLTAGE,    HID_PAGE_POWER_DEVICE, 0x40, 16, 0, 65535, HID_UNIT_CENTIVOLTS, 0x05, \
+         HID_IO_CONST_NONVOL, 0)                                                     /* 配置电压（运行时） */ \
+    FEAT(HID_PD_CONFIGFREQUENCY,  HID_PAGE_POWER_DEVICE, 0x42, 8, 0, 255, HID_UNIT_HERTZ, 0x00, \
+         HID_IO_CONST_NONVOL, 0)                                                     /* 配置频率（运行时） */ \
+    INFEAT(HID_PD_VOLTAGE,        HID_PAGE_POWER_DEVICE, 0x30, 16, 0, 65535, HID_UNIT_CENTIVOLTS, 0x05, \
+           HID_IO_CONST_VOL, HID_IO_CONST_VOL, 0)                                    /* 当前电压（运行时） */ \
+    FEAT(HID_PD_CURRENT,          HID_PAGE_POWER_DEVICE, 0x31, 16, -32768, 32767, HID_UNIT_AMPERES, 0x0E, \
+         HID_IO_CONST_VOL, 0)                                                        /* 电池电流（运行时，充电为正） */ \
+    INFEAT(HID_PD_AUDIBLEALARMCTRL, HID_PAGE_POWER_DEVICE, 0x5A, 8, 1, 3, HID_UNIT_NONE, 0x00, \
+           HID_IO_DATA_NONVOL, HID_IO_DATA_VOL, 2)                                   /* 声音报警控制：启用 */
+
+// PresentStatus 位列表，顺序必须与 struct PresentStatus 的位序一致
+//   BIT(page, usage, input, feature)
+#define UPS_PRESENT_STATUS_SCHEMA(BIT) \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x44, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* Charging */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x45, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* Discharging */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0xD0, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* ACPresent */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0xD1, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* BatteryPresent */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x42, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* BelowRemainingCapacityLimit */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x43, HID_IO_DATA_VOL,  HID_IO_DATA_VOL)  /* RemainingTimeLimitExpired */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x4B, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* NeedReplacement */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0xDB, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* VoltageNotRegulated */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x46, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* FullyCharged */ \
+    BIT(HID_PAGE_BATTERY_SYSTEM, 0x47, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* FullyDischarged */ \
+    BIT(HID_PAGE_POWER_DEVICE,   0x68, HID_IO_DATA_VOL,  HID_IO_DATA_VOL)  /* ShutdownRequested */ \
+    BIT(HID_PAGE_POWER_DEVICE,   0x69, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* ShutdownImminent */ \
+    BIT(HID_PAGE_POWER_DEVICE,   0x73, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* CommunicationLost */ \
+    BIT(HID_PAGE_POWER_DEVICE,   0x65, HID_IO_CONST_VOL, HID_IO_CONST_VOL) /* Overload */
+
+// ==================== 编译期计算 ====================
+
+#define UPS_SCHEMA_COUNT_BIT(page, usage, in, feat) + 1
+#define UPS_PRESENT_STATUS_BITS     (0 UPS_PRESENT_STATUS_SCHEMA(UPS_SCHEMA_COUNT_BIT))
+#define UPS_PRESENT_STATUS_PAD      ((8 - UPS_PRESENT_STATUS_BITS % 8) % 8)
+#define UPS_PRESENT_STATUS_LEN      ((UPS_PRESENT_STATUS_BITS + 7) / 8)
+
+// 预序列化数据区布局：每个报告一个字段，偏移由 offsetof 给出
+#define UPS_SCHEMA_IMAGE_STR(id, page, usage, str, feat) \
+    uint8_t r_##id[1];
+#define UPS_SCHEMA_IMAGE_FEAT(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    uint8_t r_##id[(bits) / 8];
+#define UPS_SCHEMA_IMAGE_INFEAT(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    uint8_t r_##id[(bits) / 8];
+
+typedef struct {
+    uint8_t r_HID_PD_PRESENTSTATUS[UPS_PRESENT_STATUS_LEN];
+    UPS_REPORT_SCHEMA(UPS_SCHEMA_IMAGE_STR, UPS_SCHEMA_IMAGE_FEAT, UPS_SCHEMA_IMAGE_INFEAT)
+} ups_report_image_t;
+
+// ==================== 描述符字节生成 ====================
+// 描述符由 ups_report_descriptor() 按结构表生成（ups_report.c），LOGICAL_MINIMUM/LOGICAL_MAXIMUM/UNIT
+// 的数据按能容纳数值的最短长度（1/2/4字节）写出。数据长度取决于数值，预处理器无法在宏中改变
+// 字节个数，所以字节在初始化时写入；总长度是编译期常量，供配置描述符的 wDescriptorLength 使用
+
+// 短条目数据长度：逻辑最小/最大值按有符号数（0..255 需要2字节，否则主机会读成 -1），单位按无符号位域
+#define HID_SDATA_LEN(v) \
+    ((int32_t)(v) >= -128 && (int32_t)(v) <= 127 ? 1 : (int32_t)(v) >= -32768 && (int32_t)(v) <= 32767 ? 2 : 4)
+#define HID_UDATA_LEN(v) \
+    ((uint32_t)(v) <= 0xFF ? 1 : (uint32_t)(v) <= 0xFFFF ? 2 : 4)
+
+// 每个报告都完整写出全局项，不依赖前一个报告的状态：
+// USAGE_PAGE, REPORT_ID, REPORT_SIZE, REPORT_COUNT (1), LOGICAL_MINIMUM, LOGICAL_MAXIMUM, UNIT, UNIT_EXPONENT
+#define UPS_DESC_GLOBALS_LEN(lmin, lmax, unit) \
+    (2 + 2 + 2 + 2 + 1 + HID_SDATA_LEN(lmin) + 1 + HID_SDATA_LEN(lmax) + 1 + HID_UDATA_LEN(unit) + 2)
+
+#define UPS_DESC_STR_LEN(id, page, usage, str, feat) \
+    + UPS_DESC_GLOBALS_LEN(0, 255, HID_UNIT_NONE) + 6
+#define UPS_DESC_FEAT_LEN(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    + UPS_DESC_GLOBALS_LEN(lmin, lmax, unit) + 4
+#define UPS_DESC_INFEAT_LEN(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    + UPS_DESC_GLOBALS_LEN(lmin, lmax, unit) + 8
+#define UPS_DESC_BIT_LEN(page, usage, in, feat) + 10
+
+// 一个实例的 UPS 应用集合，每个顶层应用集合在主机上是一个独立的电池/UPS
+#define UPS_DESC_INSTANCE_HEAD \
+    0x05, HID_PAGE_POWER_DEVICE,    /* USAGE_PAGE (Power Device) */ \
+    0x09, 0x04,                     /* USAGE (UPS) */ \
+    0xA1, 0x01,                     /* COLLECTION (Application) */ \
+    0x09, 0x24,                     /*   USAGE (Sink) */ \
+    0xA1, 0x02,                     /*   COLLECTION (Logical) */
+
+// PresentStatus 集合，报告ID之后是位列表
+#define UPS_DESC_STATUS_HEAD \
+    0x05, HID_PAGE_POWER_DEVICE,    /*     USAGE_PAGE (Power Device) */ \
+    0x09, 0x02,                     /*     USAGE (PresentStatus) */ \
+    0xA1, 0x02,                     /*     COLLECTION (Logical) */ \
+    0x85,                           /*       REPORT_ID (实例的 0x07) */
+
+#define UPS_DESC_STATUS_GLOBALS \
+    0x75, 0x01,                     /*       REPORT_SIZE (1) */ \
+    0x95, 0x01,                     /*       REPORT_COUNT (1) */ \
+    0x15, 0x00,                     /*       LOGICAL_MINIMUM (0) */ \
+    0x25, 0x01,                     /*       LOGICAL_MAXIMUM (1) */ \
+    0x65, 0x00,                     /*       UNIT (None) */ \
+    0x55, 0x00,                     /*       UNIT_EXPONENT (0) */
+
+#define UPS_DESC_INSTANCE_TAIL \
+    0x95, UPS_PRESENT_STATUS_PAD,   /*       REPORT_COUNT (填充位) */ \
+    0x81, 0x01,                     /*       INPUT (Constant, Array) */ \
+    0xB1, 0x01,                     /*       FEATURE (Constant, Array) */ \
+    0xC0,                           /*     END_COLLECTION */ \
+    0xC0,                           /*   END_COLLECTION */ \
+    0xC0,                           /* END_COLLECTION */
+
+#define UPS_DESC_BYTES_LEN(...)     sizeof((const uint8_t[]){ __VA_ARGS__ })
+
+// 每个实例的描述符长度，实例0在前且报告ID与单实例相同，其余实例的报告ID加上实例号（ups_instance.h）
+#define UPS_HID_INSTANCE_LEN ( \
+    UPS_DESC_BYTES_LEN(UPS_DESC_INSTANCE_HEAD) \
+    UPS_REPORT_SCHEMA(UPS_DESC_STR_LEN, UPS_DESC_FEAT_LEN, UPS_DESC_INFEAT_LEN) \
+    + UPS_DESC_BYTES_LEN(UPS_DESC_STATUS_HEAD) + 1 \
+    + UPS_DESC_BYTES_LEN(UPS_DESC_STATUS_GLOBALS) \
+    UPS_PRESENT_STATUS_SCHEMA(UPS_DESC_BIT_LEN) \
+    + UPS_DESC_BYTES_LEN(UPS_DESC_INSTANCE_TAIL))
+
+// 完整报告描述符的长度：每个实例一个应用集合，共用一个 HID 接口
+#define UPS_HID_REPORT_DESCRIPTOR_LEN (UPS_HID_INSTANCE_LEN * UPS_INSTANCE_COUNT)
@@ -0,0 +1,47 @@
+#pragma once
+
+// 运行时间估算：负载电流按放电倍率查表折算为额定倍率下的等效电流（Peukert效应），
+// 负载电流和等效电流各经两级指数滑动平均（约2分钟/约10分钟），并累计上次充满以来的总量：
+// 已放出的电量按累计之比折算到额定倍率，剩下的额定倍率电量除以平滑后的等效电流即运行时间。
+// 每个采样一次查表插值、四次移位加减和两次累加，没有除法；估算时三次除法。
+// 折算表所有实例共用，平滑值每个实例（ups_instance.h）一份
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 折算表：下标 i 对应放电电流 = i/2 * 额定电流（i = 0..UPS_RUNTIME_DERATE_POINTS-1），
+// 值为可用容量比例（Q12，4096 = 100%），相邻点线性插值，超出末点（16倍）按末点
+#define UPS_RUNTIME_DERATE_POINTS 33
+#define UPS_RUNTIME_Q12 4096
+
+typedef struct {
+    uint32_t tau_fast_ms;           // RunTimeToEmpty 平滑时间常数
+    uint32_t tau_slow_ms;           // AverageTimeToEmpty 平滑时间常数
+    uint16_t rated_current_ma;      // 标称容量对应的放电电流（如20小时率）
+    uint16_t peukert_x100;          // Peukert 指数 ×100（铅酸约 110~130），derate_table 为空时使用
+    const uint16_t* derate_table;   // 可选：实测折算表，UPS_RUNTIME_DERATE_POINTS 项
+    uint16_t initial_load_ma;       // 平均值初值
+} ups_runtime_config_t;
+
+// 初始化全部实例，按 ups_battery 的采样频率调用 ups_runtime_sample()
+void ups_runtime_init(const ups_runtime_config_t* config);
+
+// 输入一个负载电流采样（mA，非负）
+void ups_runtime_sample(uint8_t instance, uint32_t load_ma);
+
+// 由剩余电量和充满容量估算运行时间（秒，饱和到 65535）
+void ups_runtime_estimate(uint8_t instance, uint32_t remaining_mah, uint32_t full_charge_mah,
+                          uint16_t* runtime_to_empty, uint16_t* avg_time_to_empty);
+
+// 负载电流折算到额定倍率下的等效电流（mA）
+uint32_t ups_runtime_equivalent_ma(uint32_t load_ma);
+
+// 当前平滑后的负载电流（mA）
+uint32_t ups_runtime_load_ma(uint8_t instance);
+
+#ifdef __cplusplus
+}
+#endif
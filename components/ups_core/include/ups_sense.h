@@ -0,0 +1,56 @@
+#pragma once
+
+// 传感采集：按块处理 ADC 连续转换（DMA）输出。直流通道经 FIR 抽取和低通滤波，
+// 市电通道去直流后按 100ms 窗口求有效值并交给 ups_mains 逐半周检测，每块换算成电压/电流后发布。固件由 main/ups_adc_esp.c 的消费任务调用，
+// 主机构建由文件样本源调用，处理代码相同。
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 每个采样 4 字节，ESP32-S3 TYPE2 输出格式：
+//   bit 0-11 数据，bit 13-16 通道，bit 17 ADC单元
+#define UPS_SENSE_SAMPLE_BYTES 4
+
+typedef enum {
+    UPS_SENSE_BATTERY_V = 0,        // 电池电压（分压）
+    UPS_SENSE_BATTERY_I,            // 电池电流（双向，充电为正）
+    UPS_SENSE_LOAD_I,               // 负载电流
+    UPS_SENSE_AC,                   // 市电检测（交流，带直流偏置）
+    UPS_SENSE_CHANNELS,
+} ups_sense_channel_t;
+
+typedef struct {
+    uint8_t adc_channel[UPS_SENSE_CHANNELS];    // 各信号对应的 ADC 通道号
+    int32_t offset_raw[UPS_SENSE_CHANNELS];     // 零点（原始计数）
+    int32_t gain_q16[UPS_SENSE_CHANNELS];       // 每个原始计数对应的 mV 或 mA（Q16）
+    uint32_t channel_rate_hz;                   // 每个通道的采样率
+    uint16_t ac_line_ratio;                     // 市电电压与检测端电压之比
+} ups_sense_config_t;
+
+typedef struct {
+    uint16_t battery_mv;
+    int32_t battery_ma;             // 充电为正，放电为负
+    uint32_t load_ma;
+    uint32_t ac_rms_mv;             // 市电检测通道去直流后最近 100ms 的有效值
+    uint32_t blocks;                // 已处理的块数
+} ups_sense_reading_t;
+
+// 初始化（在消费任务启动前调用）
+void ups_sense_init(const ups_sense_config_t* config);
+
+// 单次处理的最大采样数（所有通道合计），更大的块分段处理
+#define UPS_SENSE_MAX_BLOCK_SAMPLES 1024
+
+// 处理一块 DMA 输出，len 为字节数。只允许单一消费任务调用
+void ups_sense_process(const uint8_t* data, uint32_t len);
+
+// 读取最近一块的结果，可在任意任务调用；尚未处理过数据时返回 false
+bool ups_sense_latest(ups_sense_reading_t* reading);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+// 单写者、多读者的最新值交接（序号 + 两份缓冲），读写双方都不加锁、不阻塞。
+// 每次发布序号加1：写者先写 banks[新序号 & 1]（读者当前不读的一份）再用 release 发布序号；
+// 读者复制 banks[序号 & 1]，复制后序号未变才算有效，否则重读。序号为 0 表示还没有发布过。
+// 写者在读者复制期间连续发布两次才会让读者重读，每次发布只写一份。
+// ups_report.c 的快照每次发布两份都写（读者任何时刻都能读到最新一份），不用这里的实现
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    void* banks;                    // 两份，每份 size 字节
+    size_t size;
+    atomic_uint seq;
+} ups_seqbuf_t;
+
+// banks 为两个元素的数组，size 为一个元素的大小；序号清零
+void ups_seqbuf_init(ups_seqbuf_t* buf, void* banks, size_t size);
+
+// 发布一份新值（只由唯一的写者调用），返回新的序号
+unsigned ups_seqbuf_publish(ups_seqbuf_t* buf, const void* value);
+
+// 复制最新发布的值，返回其序号；还没有发布过时返回 0，不写 value
+unsigned ups_seqbuf_read(ups_seqbuf_t* buf, void* value);
+
+#ifdef __cplusplus
+}
+#endif
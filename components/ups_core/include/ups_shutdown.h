@@ -0,0 +1,45 @@
+#pragma once
+
+// 关机/重启编排：主机写 DelayBeforeShutdown / DelayBeforeReboot（秒）开始倒计时，写负数取消。
+//   关机：到时关闭输出，之后保持关闭，直到市电断开后再恢复时重新打开（或主机写入重启）
+//   重启：到时关闭输出，UPS_SHUTDOWN_REBOOT_OFF_MS 后重新打开；此时没有市电则等市电恢复
+// 倒计时期间 ShutdownRequested 置位，剩余不到 UPS_SHUTDOWN_IMMINENT_MS 或输出已关闭时 ShutdownImminent 置位。
+// GET_REPORT 返回按请求时刻计算的剩余秒数（没有倒计时为 -1）。
+// 到期由平台单次定时器触发（ups_port_shutdown_timer），不依赖状态任务轮询；
+// 所有状态变化只在定时器回调中进行，主机写入只更新截止时间并立即触发一次回调。
+// 每个实例（ups_instance.h）有自己的倒计时和输出，市电状态共用
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPS_SHUTDOWN_IMMINENT_MS  5000
+#define UPS_SHUTDOWN_REBOOT_OFF_MS 10000
+
+void ups_shutdown_init(void);
+
+// USB回调：主机写入 DelayBeforeShutdown / DelayBeforeReboot（report_id 为带实例号的 HID_PD_DELAYBE4SHUTDOWN/REBOOT）
+void ups_shutdown_set(uint8_t report_id, int16_t seconds);
+
+// 平台定时器到期（ups_port_shutdown_timer 安排的回调）
+void ups_shutdown_timer(void);
+
+// 状态任务：当前市电状态（输出关闭后按市电恢复重新打开）
+void ups_shutdown_ac(bool present);
+
+// 实例当前的 ShutdownRequested / ShutdownImminent
+void ups_shutdown_status(uint8_t instance, bool* requested, bool* imminent);
+
+// 实例的输出是否打开
+bool ups_shutdown_output_on(uint8_t instance);
+
+// 状态变化计数：倒计时开始/取消、进入即将关机、输出开关时加一，同时投递 UPS_EVENT_SHUTDOWN
+// （固定频率主循环按计数、事件驱动的状态任务按事件立即刷新 PresentStatus）
+uint32_t ups_shutdown_changes(void);
+
+#ifdef __cplusplus
+}
+#endif
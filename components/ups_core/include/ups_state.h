@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ups_report_schema.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 电源状态结构体
+struct PresentStatus {
+  uint8_t Charging : 1;                   // bit 0x00
+  uint8_t Discharging : 1;                // bit 0x01
+  uint8_t ACPresent : 1;                  // bit 0x02
+  uint8_t BatteryPresent : 1;             // bit 0x03
+  uint8_t BelowRemainingCapacityLimit : 1;// bit 0x04
+  uint8_t RemainingTimeLimitExpired : 1;  // bit 0x05
+  uint8_t NeedReplacement : 1;            // bit 0x06
+  uint8_t VoltageNotRegulated : 1;        // bit 0x07
+
+  uint8_t FullyCharged : 1;               // bit 0x08
+  uint8_t FullyDischarged : 1;            // bit 0x09
+  uint8_t ShutdownRequested : 1;          // bit 0x0A
+  uint8_t ShutdownImminent : 1;           // bit 0x0B
+  uint8_t CommunicationLost : 1;          // bit 0x0C
+  uint8_t Overload : 1;                   // bit 0x0D
+  uint8_t unused1 : 1;
+  uint8_t unused2 : 1;
+};
+
+_Static_assert(sizeof(struct PresentStatus) == UPS_PRESENT_STATUS_LEN, "PresentStatus layout");
+
+// 将PresentStatus结构体转换为uint16_t
+static inline uint16_t PresentStatus_to_uint16(const struct PresentStatus* ps) {
+    return *(const uint16_t*)(ps);
+}
+
+// 每个实例（ups_instance.h）的状态，只允许状态任务修改
+typedef struct {
+    struct PresentStatus status;
+    uint16_t voltage;
+    int16_t current;
+    uint8_t remaining_capacity;
+    uint16_t full_charge_capacity;
+    uint8_t remaining_capacity_limit;
+    uint16_t runtime_to_empty;
+    uint16_t avg_time_to_full;
+    uint16_t avg_time_to_empty;
+} ups_instance_state_t;
+
+extern ups_instance_state_t ups_instances[UPS_INSTANCE_COUNT];
+
+// 实例0的 PresentStatus（历史记录、事件日志和持久化只覆盖实例0）
+#define UPS (ups_instances[0].status)
+
+// 所有实例共用的全局状态，只允许状态任务修改
+extern uint16_t manufacture_date;
+extern uint16_t config_voltage;
+extern uint8_t config_frequency;
+extern uint8_t warring_capacity_limit;
+extern uint16_t design_capacity;
+
+// 初始化报告表和通知，发布初始快照
+void ups_state_init(void);
+
+// 电池采样，按 UPS_BATTERY_SAMPLE_HZ 固定频率调用（与 ups_state_update 同一任务）。
+// 第一份实测数据到达或市电状态有变化时返回 true，调用者应立即调用 ups_state_update()
+bool ups_state_sample(void);
+
+// 更新UPS状态，发布快照并推送变化的Input报告
+void ups_state_update(void);
+
+// 定期发布的间隔，固件按此周期投递 UPS_EVENT_TICK
+#define UPS_STATE_PUBLISH_MS 2000
+
+// 事件驱动的状态任务：处理 ups_event_take() 取到的事件。
+// 先按固定采样周期补齐到当前时刻的电池采样（期间使用最新的 ADC 结果），
+// 再在定期发布（UPS_EVENT_TICK）、需要立即反映的事件或采样发现变化时调用 ups_state_update()。
+// 与直接按固定频率调用 ups_state_sample()/ups_state_update() 二选一
+void ups_state_dispatch(uint32_t events);
+
+#ifdef __cplusplus
+}
+#endif
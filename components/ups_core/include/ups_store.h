@@ -0,0 +1,58 @@
+#pragma once
+
+// 电池学习参数持久化：充满容量、循环次数、内阻和生产日期常驻内存，
+// 只在有意义的变化（限最小间隔）、长定时到期或低电量紧急时暂存一份快照，
+// 由后台写入任务取最新快照写入闪存（多次暂存合并为一次写入）。
+// 状态任务和USB回调都不等待闪存，写入后端见 main/ups_store_esp.c
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 持久化格式版本，字段变化时加一（旧数据按无数据处理）
+#define UPS_STORE_VERSION 1
+
+typedef struct {
+    uint16_t version;
+    uint16_t manufacture_date;      // 自1990-01-01的天数
+    uint32_t full_charge_mah;       // 学习到的充满容量
+    uint16_t cycle_count;
+    uint16_t resistance_mohm;       // 0 表示尚未测得
+} ups_store_data_t;
+
+typedef struct {
+    uint32_t design_capacity_mah;
+    uint8_t capacity_step_pct;      // 充满容量变化达到设计容量的此比例才算有意义
+    uint8_t resistance_step_pct;    // 内阻相对变化达到此比例才算有意义
+    uint32_t min_interval_ms;       // 有意义变化的最小写入间隔
+    uint32_t max_interval_ms;       // 其他变化（微小漂移）的写入间隔
+} ups_store_config_t;
+
+// 初始化（状态任务），在后端加载完成前不暂存任何快照，避免默认值覆盖闪存中的数据
+void ups_store_init(const ups_store_config_t* config);
+
+// 后端：读取闪存完成，没有有效数据时传 NULL
+void ups_store_loaded(const ups_store_data_t* data);
+
+// 状态任务：取走加载结果（只返回一次）。有数据时返回 true 并填入 data
+bool ups_store_take_loaded(ups_store_data_t* data);
+
+// 状态任务：提交当前内存中的参数。urgent 为低电量即将掉电，每次进入紧急状态时立即暂存一次
+void ups_store_update(const ups_store_data_t* data, bool urgent, uint32_t now_ms);
+
+// 写入任务：取最新的待写快照，没有新快照时返回 false（此时 data 的内容不用）
+bool ups_store_pending(ups_store_data_t* data, uint32_t* seq);
+
+// 写入任务：seq 对应的快照已写入（ok）或写入失败（下次最小间隔后重新暂存）
+void ups_store_done(uint32_t seq, bool ok);
+
+// 累计写入次数/失败次数
+uint32_t ups_store_commits(void);
+uint32_t ups_store_failures(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,259 @@
+#include <string.h>
+#include "ups_port.h"
+#include "ups_instance.h"
+#include "ups_battery.h"
+
+static const char *TAG = "BATTERY";
+
+// 电量单位：mA·采样周期（100Hz时为 mA·10ms），1mAh = 3600 * UPS_BATTERY_SAMPLE_HZ
+#define UNITS_PER_MAH ((int64_t)3600 * UPS_BATTERY_SAMPLE_HZ)
+
+// 端点判定需要持续的采样数
+#define FULL_HOLD_SAMPLES  (10 * UPS_BATTERY_SAMPLE_HZ)    // 充满：10秒
+#define EMPTY_HOLD_SAMPLES (1 * UPS_BATTERY_SAMPLE_HZ)     // 放空：1秒
+
+#define MINUTE_SAMPLES (60 * UPS_BATTERY_SAMPLE_HZ)
+
+// 重新学习的充满容量只接受设计容量的 50% ~ 125%
+#define LEARN_MIN_PERCENT 50
+#define LEARN_MAX_PERCENT 125
+
+// 内阻估算：相邻采样电流变化超过此值时取 ΔV/ΔI，按 1/8 指数平均，只接受 1~1000mΩ
+#define RESISTANCE_STEP_MA   200
+#define RESISTANCE_MAX_MOHM  1000
+#define RESISTANCE_EMA_SHIFT 3
+
+typedef enum {
+    LEARN_NONE = 0,
+    LEARN_FROM_FULL,        // 从充满开始连续放电，等待放空
+    LEARN_FROM_EMPTY,       // 从放空开始连续充电，等待充满
+} battery_learn_t;
+
+// 每个实例一个模型，采样路径只访问自己的状态
+typedef struct {
+    ups_battery_config_t config;
+    int32_t charge_efficiency_q8;       // 充电效率，Q8
+
+    int64_t charge;                     // 剩余电量
+    int64_t full;                       // 充满容量
+    bool fully_charged;
+    bool fully_discharged;
+    uint16_t full_hold;
+    uint16_t empty_hold;
+
+    battery_learn_t learn_state;
+    int64_t learn_charge;               // 学习窗口内移动的电量
+
+    int64_t discharged;                 // 本次循环已放出的电量
+    uint16_t cycles;
+    uint32_t resistance_q4;             // 内阻（mΩ，Q4），0 表示尚未测得
+    int32_t prev_current_ma;
+    uint16_t prev_voltage_mv;
+
+    // 电流按1分钟分块求和，只在块结束时锁存（放电方向的估算见 ups_runtime.c）
+    int64_t minute_sum;
+    uint32_t minute_count;
+    int64_t minute_last_sum;
+} battery_state_t;
+
+static battery_state_t batteries[UPS_INSTANCE_COUNT];
+
+void ups_battery_init(uint8_t instance, const ups_battery_config_t* config, uint8_t initial_percent) {
+    battery_state_t* b = &batteries[instance];
+
+    b->config = *config;
+    b->charge_efficiency_q8 = (int32_t)config->charge_efficiency * 256 / 100;
+
+    b->full = (int64_t)config->design_capacity_mah * UNITS_PER_MAH;
+    b->charge = b->full * (initial_percent > 100 ? 100 : initial_percent) / 100;
+    b->fully_charged = false;
+    b->fully_discharged = false;
+    b->full_hold = 0;
+    b->empty_hold = 0;
+
+    b->learn_state = LEARN_NONE;
+    b->learn_charge = 0;
+
+    b->discharged = 0;
+    b->cycles = 0;
+    b->resistance_q4 = 0;
+    b->prev_current_ma = 0;
+    b->prev_voltage_mv = 0;
+
+    b->minute_sum = 0;
+    b->minute_count = 0;
+    b->minute_last_sum = 0;
+}
+
+void ups_battery_restore(uint8_t instance, uint32_t full_charge_mah, uint16_t cycle_count, uint16_t resistance_mohm) {
+    battery_state_t* b = &batteries[instance];
+
+    int64_t design = (int64_t)b->config.design_capacity_mah * UNITS_PER_MAH;
+    int64_t full = (int64_t)full_charge_mah * UNITS_PER_MAH;
+
+    if (full * 100 >= design * LEARN_MIN_PERCENT && full * 100 <= design * LEARN_MAX_PERCENT) {
+        // 剩余电量按百分比保持不变
+        b->charge = b->charge * full / b->full;
+        b->full = full;
+    }
+    b->cycles = cycle_count;
+    if (resistance_mohm > 0 && resistance_mohm <= RESISTANCE_MAX_MOHM) {
+        b->resistance_q4 = (uint32_t)resistance_mohm << 4;
+    }
+}
+
+// 放电/静置时的负载阶跃 R = ΔV/ΔI（充电端电压含极化，不参与；每次阶跃一次除法）
+static void battery_resistance(battery_state_t* b, int32_t current_ma, uint16_t voltage_mv) {
+    int32_t di = current_ma - b->prev_current_ma;
+    int32_t dv = (int32_t)voltage_mv - b->prev_voltage_mv;
+
+    if (b->prev_voltage_mv != 0 && current_ma <= 0 && b->prev_current_ma <= 0 && (di >= RESISTANCE_STEP_MA || di <= -RESISTANCE_STEP_MA)) {
+        int32_t r_q4 = dv * 1000 * 16 / di;
+        if (r_q4 > 0 && r_q4 <= RESISTANCE_MAX_MOHM * 16) {
+            b->resistance_q4 = b->resistance_q4 == 0 ? (uint32_t)r_q4
+                          : (uint32_t)((int32_t)b->resistance_q4 + ((r_q4 - (int32_t)b->resistance_q4) >> RESISTANCE_EMA_SHIFT));
+        }
+    }
+    b->prev_current_ma = current_ma;
+    b->prev_voltage_mv = voltage_mv;
+}
+
+static void battery_relearn(battery_state_t* b, int64_t learned) {
+    int64_t design = (int64_t)b->config.design_capacity_mah * UNITS_PER_MAH;
+    uint32_t learned_mah = (uint32_t)(learned / UNITS_PER_MAH);
+
+    if (learned * 100 < design * LEARN_MIN_PERCENT || learned * 100 > design * LEARN_MAX_PERCENT) {
+        UPS_LOGW(TAG, "Relearned capacity %u mAh out of range, ignored", (unsigned)learned_mah);
+        return;
+    }
+    b->full = learned;
+    UPS_LOGI(TAG, "Full charge capacity relearned: %u mAh", (unsigned)learned_mah);
+}
+
+static void battery_at_full(battery_state_t* b) {
+    if (b->learn_state == LEARN_FROM_EMPTY) {
+        battery_relearn(b, b->learn_charge);
+    }
+    b->charge = b->full;
+    b->fully_charged = true;
+    b->learn_state = LEARN_FROM_FULL;
+    b->learn_charge = 0;
+}
+
+static void battery_at_empty(battery_state_t* b) {
+    if (b->learn_state == LEARN_FROM_FULL) {
+        battery_relearn(b, b->learn_charge);
+    }
+    b->charge = 0;
+    b->fully_discharged = true;
+    b->learn_state = LEARN_FROM_EMPTY;
+    b->learn_charge = 0;
+}
+
+void ups_battery_sample(uint8_t instance, int32_t current_ma, uint16_t voltage_mv) {
+    battery_state_t* b = &batteries[instance];
+
+    int32_t taper = b->config.taper_current_ma;
+    int32_t delta = current_ma > 0 ? (current_ma * b->charge_efficiency_q8) >> 8 : current_ma;
+
+    // 库仑计数
+    b->charge += delta;
+    if (delta < 0) {
+        b->discharged -= delta;
+        if (b->discharged >= b->full) {
+            b->discharged -= b->full;
+            b->cycles++;
+        }
+    }
+    if (b->charge < 0) {
+        b->charge = 0;
+    } else if (b->charge > b->full) {
+        b->charge = b->full;
+    }
+
+    // 学习窗口：方向反转（超过截止电流）即作废
+    if (b->learn_state == LEARN_FROM_FULL) {
+        if (current_ma > taper) {
+            b->learn_state = LEARN_NONE;
+        } else {
+            b->learn_charge -= delta;
+        }
+    } else if (b->learn_state == LEARN_FROM_EMPTY) {
+        if (current_ma < -taper) {
+            b->learn_state = LEARN_NONE;
+        } else {
+            b->learn_charge += delta;
+        }
+    }
+
+    // 端点判定
+    if (current_ma < -taper) {
+        b->fully_charged = false;
+    } else if (current_ma > taper) {
+        b->fully_discharged = false;
+    }
+
+    if (voltage_mv >= b->config.full_voltage_mv && current_ma >= 0 && current_ma <= taper) {
+        if (b->full_hold < FULL_HOLD_SAMPLES) {
+            b->full_hold++;
+        } else if (!b->fully_charged) {
+            battery_at_full(b);
+        }
+    } else {
+        b->full_hold = 0;
+    }
+
+    if (voltage_mv <= b->config.empty_voltage_mv && current_ma < 0) {
+        if (b->empty_hold < EMPTY_HOLD_SAMPLES) {
+            b->empty_hold++;
+        } else if (!b->fully_discharged) {
+            battery_at_empty(b);
+        }
+    } else {
+        b->empty_hold = 0;
+    }
+
+    battery_resistance(b, current_ma, voltage_mv);
+
+    // 电流平均
+    b->minute_sum += current_ma;
+    if (++b->minute_count >= MINUTE_SAMPLES) {
+        b->minute_last_sum = b->minute_sum;
+        b->minute_sum = 0;
+        b->minute_count = 0;
+    }
+}
+
+static uint16_t battery_clamp_seconds(int64_t seconds) {
+    if (seconds < 0) {
+        return 0;
+    }
+    return seconds > 65535 ? 65535 : (uint16_t)seconds;
+}
+
+void ups_battery_get_status(uint8_t instance, ups_battery_status_t* status) {
+    battery_state_t* b = &batteries[instance];
+
+    int64_t design = (int64_t)b->config.design_capacity_mah * UNITS_PER_MAH;
+    uint32_t full_percent = (uint32_t)((b->full * 100 + design / 2) / design);
+
+    memset(status, 0, sizeof(*status));
+    status->remaining_capacity = (uint8_t)((b->charge * 100 + b->full / 2) / b->full);
+    status->full_charge_capacity = full_percent > 100 ? 100 : (uint8_t)full_percent;
+    status->remaining_mah = (uint32_t)(b->charge / UNITS_PER_MAH);
+    status->full_charge_mah = (uint32_t)(b->full / UNITS_PER_MAH);
+    status->cycle_count = b->cycles;
+    status->resistance_mohm = (uint16_t)((b->resistance_q4 + 8) >> 4);
+    status->fully_charged = b->fully_charged;
+    status->fully_discharged = b->fully_discharged;
+
+    // 充满时间按效率折算后的平均充电电流估算，不在充电时为 65535
+    int64_t charged_per_minute = b->minute_last_sum > 0 ? (b->minute_last_sum * b->charge_efficiency_q8) >> 8 : 0;
+    if (b->fully_charged) {
+        status->avg_time_to_full = 0;
+    } else if (charged_per_minute > 0) {
+        status->avg_time_to_full = battery_clamp_seconds((b->full - b->charge) * 60 / charged_per_minute);
+    } else {
+        status->avg_time_to_full = 65535;
+    }
+}
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <string.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_hid.h"
+#include "ups_log.h"
+#include "ups_dsp.h"
+#include "ups_bench.h"
+
+// 延迟直方图：按 2 的幂分段，每段再线性分 16 格（相对误差 < 6.25%），
+// 每次调用都计入，max 单独精确记录
+#define BENCH_SUB_BITS  4
+#define BENCH_SUB       (1u << BENCH_SUB_BITS)
+#define BENCH_BUCKETS   ((32 - BENCH_SUB_BITS + 1) * BENCH_SUB)
+
+// 主机每2秒轮询的报告（见 tusb_hid_example_main.c 中的轮询频率表）
+static const uint8_t bench_poll_ids[] = {
+    HID_PD_VOLTAGE, HID_PD_REMAININGCAPACITY, HID_PD_RUNTIMETOEMPTY, HID_PD_PRESENTSTATUS,
+};
+
+// NUT usbhid-ups 启动时逐个读取全部报告ID，包括描述符中没有的
+static uint8_t bench_sweep_ids[UPS_REPORT_ID_MAX];
+
+// 主机写入的Feature报告（Report ID + 负载）
+static const uint8_t bench_set_report[] = { HID_PD_DELAYBE4SHUTDOWN, 0x2C, 0x01 };
+
+static uint32_t bench_hist[BENCH_BUCKETS];
+static uint32_t bench_max;
+
+// ==================== 对照：原 tud_hid_get_report_cb 的 switch 实现 ====================
+// 只用于基准对比，按报告ID逐个 case 取全局变量现场序列化。
+// 原实现在未知ID/长度不足时调用 ESP_LOGW，这里改为与查表路径相同的 ups_log_record，
+// 两条路径只差在查找和序列化方式上
+
+typedef uint16_t (*bench_get_fn_t)(uint8_t instance, uint8_t report_id,
+                                   uint8_t report_type, uint8_t* buffer, uint16_t reqlen);
+
+// 原实现中由状态任务刷新的全局变量
+static volatile uint16_t bench_sw_status = 0x000D;
+static volatile uint16_t bench_sw_manufacture_date = 0x5A21;
+static volatile uint16_t bench_sw_config_voltage = 1200;
+static volatile uint16_t bench_sw_voltage = 1260;
+static volatile uint8_t bench_sw_remaining_capacity = 87;
+static volatile uint16_t bench_sw_runtime_to_empty = 3000;
+static volatile uint16_t bench_sw_full_charge_capacity = 100;
+static volatile int16_t bench_sw_delay_before_shutdown = -1;
+static volatile int16_t bench_sw_delay_before_reboot = -1;
+static volatile uint8_t bench_sw_design_capacity = 100;
+static volatile uint16_t bench_sw_avg_time_to_full = 0;
+static volatile uint16_t bench_sw_avg_time_to_empty = 3000;
+
+#define BENCH_SW_U8(v) \
+    if (reqlen >= 1) { buffer[0] = (v); return 1; } \
+    break;
+#define BENCH_SW_U16(v) \
+    if (reqlen >= 2) { uint16_t x = (uint16_t)(v); buffer[0] = x & 0xFF; buffer[1] = (x >> 8) & 0xFF; return 2; } \
+    break;
+
+static uint16_t bench_switch_get_report(uint8_t instance, uint8_t report_id,
+                                        uint8_t report_type, uint8_t* buffer, uint16_t reqlen)
+{
+    (void)instance;
+    if (report_type != UPS_HID_REPORT_TYPE_FEATURE) {
+        ups_log_record(UPS_LOG_GET_BAD_TYPE, report_id, report_type, reqlen, 0);
+        return 0;
+    }
+
+    switch (report_id) {
+        case HID_PD_IPRODUCT:           BENCH_SW_U8(IPRODUCT)
+        case HID_PD_SERIAL:             BENCH_SW_U8(ISERIAL)
+        case HID_PD_MANUFACTURER:       BENCH_SW_U8(IMANUFACTURER)
+        case HID_PD_RECHARGEABLE:       BENCH_SW_U8(0x01)
+        case HID_PD_PRESENTSTATUS:      BENCH_SW_U16(bench_sw_status)
+        case HID_PD_MANUFACTUREDATE:    BENCH_SW_U16(bench_sw_manufacture_date)
+        case HID_PD_CONFIGVOLTAGE:      BENCH_SW_U16(bench_sw_config_voltage)
+        case HID_PD_VOLTAGE:            BENCH_SW_U16(bench_sw_voltage)
+        case HID_PD_REMAININGCAPACITY:  BENCH_SW_U8(bench_sw_remaining_capacity)
+        case HID_PD_RUNTIMETOEMPTY:     BENCH_SW_U16(bench_sw_runtime_to_empty)
+        case HID_PD_FULLCHARGECAPACITY: BENCH_SW_U16(bench_sw_full_charge_capacity)
+        case HID_PD_WARNCAPACITYLIMIT:  BENCH_SW_U8(20)
+        case HID_PD_CPCTYGRANULARITY1:  BENCH_SW_U8(1)
+        case HID_PD_REMNCAPACITYLIMIT:  BENCH_SW_U8(10)
+        case HID_PD_DELAYBE4SHUTDOWN:   BENCH_SW_U16(bench_sw_delay_before_shutdown)
+        case HID_PD_DELAYBE4REBOOT:     BENCH_SW_U16(bench_sw_delay_before_reboot)
+        case HID_PD_AUDIBLEALARMCTRL:   BENCH_SW_U8(2)
+        case HID_PD_CAPACITYMODE:       BENCH_SW_U8(0x01)
+        case HID_PD_DESIGNCAPACITY:     BENCH_SW_U8(bench_sw_design_capacity)
+        case HID_PD_CPCTYGRANULARITY2:  BENCH_SW_U8(0x00)
+        case HID_PD_AVERAGETIME2FULL:   BENCH_SW_U16(bench_sw_avg_time_to_full)
+        case HID_PD_AVERAGETIME2EMPTY:  BENCH_SW_U16(bench_sw_avg_time_to_empty)
+        case HID_PD_IDEVICECHEMISTRY:   BENCH_SW_U8(IDEVICECHEMISTRY)
+        case HID_PD_IOEMINFORMATION:    BENCH_SW_U8(IOEMVENDOR)
+        default:
+            ups_log_record(UPS_LOG_GET_UNKNOWN, report_id, report_type, reqlen, 0);
+            return 0;
+    }
+
+    ups_log_record(UPS_LOG_GET_SHORT, report_id, report_type, reqlen, 0);
+    return 0;
+}
+
+// DSP内核基准：单通道一帧的样本数（与 ups_adc_esp.c 的帧大小一致）
+#define BENCH_DSP_BLOCK 64
+
+static const int16_t bench_fir_coeffs[32] = {
+    -54, -64, -82, -97, -93, -47, 66, 266, 562, 951, 1411, 1909, 2396, 2821, 3136, 3302,
+    3302, 3136, 2821, 2396, 1909, 1411, 951, 562, 266, 66, -47, -93, -97, -82, -64, -54,
+};
+
+static int16_t bench_dsp_in[BENCH_DSP_BLOCK];
+static int16_t bench_dsp_out[BENCH_DSP_BLOCK];
+static ups_dsp_fir_t bench_fir;
+static ups_dsp_biquad_t bench_biquad;
+static volatile uint32_t bench_sink;
+
+static uint32_t bench_bucket(uint32_t v) {
+    if (v < BENCH_SUB) {
+        return v;
+    }
+    uint32_t shift = 31 - __builtin_clz(v) - BENCH_SUB_BITS;
+    return (shift + 1) * BENCH_SUB + ((v >> shift) & (BENCH_SUB - 1));
+}
+
+// 格的下界
+static uint32_t bench_bucket_value(uint32_t b) {
+    if (b < BENCH_SUB) {
+        return b;
+    }
+    uint32_t shift = b / BENCH_SUB - 1;
+    return (BENCH_SUB + b % BENCH_SUB) << shift;
+}
+
+static void bench_record(uint32_t dt) {
+    bench_hist[bench_bucket(dt)]++;
+    if (dt > bench_max) {
+        bench_max = dt;
+    }
+}
+
+// 第 rank 个（从0起）样本所在格的下界，不超过 max
+static uint32_t bench_rank(uint64_t rank) {
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < BENCH_BUCKETS; b++) {
+        seen += bench_hist[b];
+        if (seen > rank) {
+            uint32_t v = bench_bucket_value(b);
+            return v < bench_max ? v : bench_max;
+        }
+    }
+    return bench_max;
+}
+
+static void bench_finish(ups_bench_result_t* res, uint64_t total_cycles) {
+    uint32_t per_us = ups_port_cycles_per_us();
+
+    res->p50_ns = (uint32_t)((uint64_t)bench_rank((uint64_t)res->calls / 2) * 1000 / per_us);
+    res->p99_ns = (uint32_t)((uint64_t)bench_rank((uint64_t)res->calls * 99 / 100) * 1000 / per_us);
+    res->max_ns = (uint32_t)((uint64_t)bench_max * 1000 / per_us);
+    res->calls_per_sec = total_cycles ? (uint32_t)((uint64_t)res->calls * per_us * 1000000 / total_cycles) : 0;
+
+    printf("bench %-8s calls=%-8u p50=%6u ns  p99=%6u ns  max=%7u ns  %u calls/s\n",
+           res->name, (unsigned)res->calls, (unsigned)res->p50_ns, (unsigned)res->p99_ns,
+           (unsigned)res->max_ns, (unsigned)res->calls_per_sec);
+}
+
+static void bench_get_mix(const char* name, bench_get_fn_t get, const uint8_t* ids, size_t count, uint32_t rounds) {
+    ups_bench_result_t res = { .name = name };
+    uint8_t buffer[64];
+    uint64_t total = 0;
+
+    memset(bench_hist, 0, sizeof(bench_hist));
+    bench_max = 0;
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t t0 = ups_port_cycles();
+            get(0, ids[i], UPS_HID_REPORT_TYPE_FEATURE, buffer, sizeof(buffer));
+            uint32_t dt = ups_port_cycles() - t0;
+
+            total += dt;
+            res.calls++;
+            bench_record(dt);
+        }
+    }
+    bench_finish(&res, total);
+}
+
+static void bench_set_mix(uint32_t rounds) {
+    ups_bench_result_t res = { .name = "set" };
+    uint64_t total = 0;
+
+    memset(bench_hist, 0, sizeof(bench_hist));
+    bench_max = 0;
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint32_t t0 = ups_port_cycles();
+        ups_hid_set_report(0, bench_set_report[0], UPS_HID_REPORT_TYPE_FEATURE,
+                           &bench_set_report[1], sizeof(bench_set_report) - 1);
+        uint32_t dt = ups_port_cycles() - t0;
+
+        total += dt;
+        res.calls++;
+        bench_record(dt);
+    }
+    bench_finish(&res, total);
+
+    // 取消基准中写入的关机倒计时
+    static const uint8_t cancel[] = { 0xFF, 0xFF };
+    ups_hid_set_report(0, bench_set_report[0], UPS_HID_REPORT_TYPE_FEATURE, cancel, sizeof(cancel));
+}
+
+// 每个采样的计数器计数（固件为CPU周期，主机为纳秒），保留两位小数
+static void bench_dsp_finish(const char* name, uint64_t cycles, uint32_t rounds) {
+    uint64_t x100 = cycles * 100 / ((uint64_t)rounds * BENCH_DSP_BLOCK);
+    printf("bench %-8s %u.%02u %s/sample\n", name, (unsigned)(x100 / 100), (unsigned)(x100 % 100),
+           ups_port_cycles_unit());
+}
+
+static void bench_dsp(uint32_t rounds) {
+    uint64_t fir = 0, fir_simd = 0, biquad = 0, rms = 0, mean = 0;
+
+    for (int i = 0; i < BENCH_DSP_BLOCK; i++) {
+        bench_dsp_in[i] = (int16_t)((i * 2654435761u) >> 20) - 2048;
+    }
+    ups_dsp_biquad_lowpass(&bench_biquad, 5, 625);
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint32_t t0 = ups_port_cycles();
+        ups_dsp_fir_decimate_c(&bench_fir, bench_dsp_in, bench_dsp_out, BENCH_DSP_BLOCK);
+        uint32_t t1 = ups_port_cycles();
+#if UPS_DSP_HAVE_SIMD
+        ups_dsp_fir_decimate(&bench_fir, bench_dsp_in, bench_dsp_out, BENCH_DSP_BLOCK);
+#endif
+        uint32_t t2 = ups_port_cycles();
+        ups_dsp_biquad_process(&bench_biquad, bench_dsp_in, bench_dsp_out, BENCH_DSP_BLOCK);
+        uint32_t t3 = ups_port_cycles();
+        bench_sink += ups_dsp_rms(bench_dsp_in, BENCH_DSP_BLOCK);
+        uint32_t t4 = ups_port_cycles();
+        bench_sink += (uint16_t)ups_dsp_mean(bench_dsp_in, BENCH_DSP_BLOCK);
+        uint32_t t5 = ups_port_cycles();
+
+        fir += t1 - t0;
+        fir_simd += t2 - t1;
+        biquad += t3 - t2;
+        rms += t4 - t3;
+        mean += t5 - t4;
+    }
+
+    // 没有SIMD实现时 ups_dsp_fir_decimate 就是C实现，只输出一行
+    bench_dsp_finish("fir", fir, rounds);
+#if UPS_DSP_HAVE_SIMD
+    bench_dsp_finish("fir-simd", fir_simd, rounds);
+#else
+    (void)fir_simd;
+#endif
+    bench_dsp_finish("biquad", biquad, rounds);
+    bench_dsp_finish("rms", rms, rounds);
+    bench_dsp_finish("mean", mean, rounds);
+}
+
+void ups_bench_run(uint32_t rounds) {
+    if (rounds == 0) {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(bench_sweep_ids); i++) {
+        bench_sweep_ids[i] = i + 1;
+    }
+
+    // 查表路径与原 switch 路径在同样的组合下成对输出
+    bench_get_mix("poll", ups_hid_get_report, bench_poll_ids, sizeof(bench_poll_ids), rounds);
+    bench_get_mix("poll-sw", bench_switch_get_report, bench_poll_ids, sizeof(bench_poll_ids), rounds);
+    bench_get_mix("sweep", ups_hid_get_report, bench_sweep_ids, sizeof(bench_sweep_ids), rounds);
+    bench_get_mix("sweep-sw", bench_switch_get_report, bench_sweep_ids, sizeof(bench_sweep_ids), rounds);
+    bench_set_mix(rounds);
+
+    ups_dsp_fir_init(&bench_fir, bench_fir_coeffs, 32, 8);
+    bench_dsp(rounds);
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_boot.h"
+
+// 各阶段到达时间（微秒），0 表示尚未到达；真正的 0us 记为 1us
+static atomic_uint boot_time_us[UPS_BOOT_STAGES];
+
+static const char* const boot_stage_names[UPS_BOOT_STAGES] = {
+    [UPS_BOOT_APP_START] = "app",
+    [UPS_BOOT_USB_INSTALLED] = "usb",
+    [UPS_BOOT_NVS_READY] = "nvs",
+    [UPS_BOOT_FIRST_SAMPLE] = "sample",
+    [UPS_BOOT_FIRST_PUBLISH] = "publish",
+    [UPS_BOOT_MOUNTED] = "mounted",
+    [UPS_BOOT_FIRST_GET_REPORT] = "get",
+    [UPS_BOOT_FIRST_VALID_REPORT] = "valid",
+};
+
+void ups_boot_mark(ups_boot_stage_t stage) {
+    if (atomic_load_explicit(&boot_time_us[stage], memory_order_relaxed) != 0) {
+        return;
+    }
+    unsigned now = ups_port_micros();
+    unsigned expected = 0;
+    atomic_compare_exchange_strong(&boot_time_us[stage], &expected, now ? now : 1);
+}
+
+void ups_boot_report_served(void) {
+    if (atomic_load_explicit(&boot_time_us[UPS_BOOT_FIRST_VALID_REPORT], memory_order_relaxed) != 0) {
+        return;
+    }
+    ups_boot_mark(UPS_BOOT_FIRST_GET_REPORT);
+    if (atomic_load_explicit(&boot_time_us[UPS_BOOT_FIRST_PUBLISH], memory_order_relaxed) != 0) {
+        ups_boot_mark(UPS_BOOT_FIRST_VALID_REPORT);
+    }
+}
+
+bool ups_boot_time_us(ups_boot_stage_t stage, uint32_t* time_us) {
+    unsigned t = atomic_load_explicit(&boot_time_us[stage], memory_order_relaxed);
+    *time_us = t;
+    return t != 0;
+}
+
+bool ups_boot_complete(void) {
+    for (int i = 0; i < UPS_BOOT_STAGES; i++) {
+        if (atomic_load_explicit(&boot_time_us[i], memory_order_relaxed) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ups_boot_format(char* buffer, size_t buflen) {
+    int n = 0;
+    for (int i = 0; i < UPS_BOOT_STAGES && n >= 0 && (size_t)n < buflen; i++) {
+        uint32_t t;
+        if (ups_boot_time_us((ups_boot_stage_t)i, &t)) {
+            n += snprintf(buffer + n, buflen - n, "%s%s=%u.%ums", i ? " " : "", boot_stage_names[i],
+                          (unsigned)(t / 1000), (unsigned)(t % 1000 / 100));
+        } else {
+            n += snprintf(buffer + n, buflen - n, "%s%s=-", i ? " " : "", boot_stage_names[i]);
+        }
+    }
+    return n;
+}
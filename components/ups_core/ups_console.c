@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "ups_report.h"
+#include "ups_history.h"
+#include "ups_store.h"
+#include "ups_boot.h"
+#include "ups_event.h"
+#include "ups_hid.h"
+#include "ups_port.h"
+#include "ups_console.h"
+
+enum {
+    CONSOLE_IDLE = 0,
+    CONSOLE_TEXT,                       // 只有 text 中的一段输出
+    CONSOLE_HELP,
+    CONSOLE_STATUS,
+    CONSOLE_POWER,
+    CONSOLE_JOURNAL,
+    CONSOLE_EXPORT,
+    CONSOLE_FLOOD,
+    CONSOLE_PROMPT,                     // 命令输出结束，发送提示符
+};
+
+#define CONSOLE_CTRL_C 0x03
+
+static const char* const console_help[] = {
+    "help             this list\r\n",
+    "status           reports, store and journal counters\r\n",
+    "boot             boot stage times\r\n",
+    "power            DFS range, USB suspend and light sleep time, wake latencies\r\n",
+    "journal          power event journal\r\n",
+    "export H|J|A     binary export (history, journal, all), no prompt after the stream\r\n",
+    "flood <KB>       filler output for USB load tests\r\n",
+};
+
+void ups_console_init(ups_console_t* c) {
+    memset(c, 0, sizeof(*c));
+}
+
+bool ups_console_busy(const ups_console_t* c) {
+    return c->mode != CONSOLE_IDLE;
+}
+
+static void console_text(ups_console_t* c, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void console_text(ups_console_t* c, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(c->text, sizeof(c->text), fmt, args);
+    va_end(args);
+    c->text_len = (uint16_t)(n < 0 ? 0 : n >= (int)sizeof(c->text) ? (int)sizeof(c->text) - 1 : n);
+    c->text_pos = 0;
+}
+
+// 以 text 中已有的 n 个字符结束一行（超长时截断）
+static void console_line_end(ups_console_t* c, int n) {
+    if (n < 0) {
+        n = 0;
+    } else if (n > (int)sizeof(c->text) - 3) {
+        n = (int)sizeof(c->text) - 3;
+    }
+    memcpy(c->text + n, "\r\n", 3);
+    c->text_len = (uint16_t)(n + 2);
+    c->text_pos = 0;
+}
+
+// 读取最近发布的报告快照（与 GET_REPORT 同一路径）
+static uint32_t console_report(uint8_t report_id) {
+    uint8_t buf[UPS_REPORT_MAX_LEN] = { 0 };
+    ups_report_get(report_id, buf, sizeof(buf));
+    return buf[0] | (uint32_t)buf[1] << 8;
+}
+
+// 实例0之外的每个实例一行
+#define STATUS_INSTANCE_STEP 4
+#define STATUS_EVENT_STEP    (STATUS_INSTANCE_STEP + UPS_INSTANCE_COUNT - 1)
+
+// status 分几行生成，每次一行；最后是每类发布过的事件的投递到发布延迟
+static bool console_status(ups_console_t* c) {
+    while (c->step >= STATUS_EVENT_STEP && c->step - STATUS_EVENT_STEP < UPS_EVENT_COUNT) {
+        ups_event_t event = (ups_event_t)(c->step++ - STATUS_EVENT_STEP);
+        ups_event_stats_t stats;
+        ups_event_get_stats(event, &stats);
+        if (stats.count != 0) {
+            console_text(c, "event %-8s %u published, latency mean %u us, max %u us\r\n", ups_event_name(event),
+                         (unsigned)stats.count, (unsigned)(stats.total_us / stats.count), (unsigned)stats.max_us);
+            return true;
+        }
+    }
+    if (c->step >= STATUS_INSTANCE_STEP && c->step < STATUS_EVENT_STEP) {
+        uint8_t instance = (uint8_t)(c->step++ - STATUS_INSTANCE_STEP + 1);
+        console_text(c, "instance %u status 0x%04X, battery %u cV, capacity %u%%, runtime %u s\r\n", instance,
+                     (unsigned)console_report(UPS_INSTANCE_REPORT_ID(instance, HID_PD_PRESENTSTATUS)),
+                     (unsigned)console_report(UPS_INSTANCE_REPORT_ID(instance, HID_PD_VOLTAGE)),
+                     (unsigned)console_report(UPS_INSTANCE_REPORT_ID(instance, HID_PD_REMAININGCAPACITY)),
+                     (unsigned)console_report(UPS_INSTANCE_REPORT_ID(instance, HID_PD_RUNTIMETOEMPTY)));
+        return true;
+    }
+    switch (c->step++) {
+        case 0: {
+            uint16_t status = (uint16_t)console_report(HID_PD_PRESENTSTATUS);
+            int n = snprintf(c->text, sizeof(c->text), "status 0x%04X", status);
+            for (uint8_t bit = 0; bit < 16 && n < (int)sizeof(c->text); bit++) {
+                if (status & (1u << bit)) {
+                    n += snprintf(c->text + n, sizeof(c->text) - n, " %s", ups_journal_status_name(bit));
+                }
+            }
+            console_line_end(c, n);
+            return true;
+        }
+        case 1:
+            console_text(c, "battery %u cV, %d cA, capacity %u%%, runtime %u s\r\n",
+                         (unsigned)console_report(HID_PD_VOLTAGE), (int16_t)console_report(HID_PD_CURRENT),
+                         (unsigned)console_report(HID_PD_REMAININGCAPACITY),
+                         (unsigned)console_report(HID_PD_RUNTIMETOEMPTY));
+            return true;
+        case 2:
+            console_text(c, "store %u commits, %u failures; journal next #%u, %u dropped\r\n",
+                         (unsigned)ups_store_commits(), (unsigned)ups_store_failures(),
+                         (unsigned)ups_journal_next_seq(), (unsigned)ups_journal_dropped());
+            return true;
+        case 3:
+            console_text(c, "history %u/%u/%u points\r\n", (unsigned)ups_history_count(UPS_HISTORY_1S),
+                         (unsigned)ups_history_count(UPS_HISTORY_1MIN),
+                         (unsigned)ups_history_count(UPS_HISTORY_15MIN));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// power 分几行生成，没有电源管理时只输出远程唤醒统计
+static bool console_power(ups_console_t* c) {
+    ups_port_power_t p;
+    ups_hid_wakeup_stats_t w;
+
+    if (!ups_port_power(&p) && c->step < 3) {
+        c->step = 3;
+        console_text(c, "power management disabled\r\n");
+        return true;
+    }
+    switch (c->step++) {
+        case 0:
+            console_text(c, "cpu %u-%u MHz, light sleep while suspended %s, bus %s, %u suspends\r\n",
+                         p.cpu_min_mhz, p.cpu_max_mhz, p.light_sleep ? "on" : "off",
+                         p.suspended ? "suspended" : "active", (unsigned)p.suspends);
+            return true;
+        case 1:
+            console_text(c, "suspended %u s, light sleep %u s (%u%%) in %u sleeps\r\n",
+                         (unsigned)(p.suspended_us / 1000000), (unsigned)(p.sleep_us / 1000000),
+                         p.suspended_us ? (unsigned)(p.sleep_us * 100 / p.suspended_us) : 0, (unsigned)p.sleeps);
+            return true;
+        case 2:
+            console_text(c, "timer wake latency while suspended: %u wakes, mean %u us, max %u us\r\n",
+                         (unsigned)p.wakes, p.wakes ? (unsigned)(p.wake_total_us / p.wakes) : 0,
+                         (unsigned)p.wake_max_us);
+            return true;
+        case 3:
+            ups_hid_get_wakeup_stats(&w);
+            console_text(c, "remote wakeup %u, event->resume %u resumes, mean %u us, max %u us\r\n",
+                         (unsigned)w.wakeups, (unsigned)w.resumed,
+                         w.resumed ? (unsigned)(w.resume_total_us / w.resumed) : 0, (unsigned)w.resume_max_us);
+            return true;
+        case 4:
+            ups_hid_get_wakeup_stats(&w);
+            console_text(c, "event->report %u reports, last %u us, mean %u us, max %u us\r\n",
+                         (unsigned)w.reported, (unsigned)w.last_us,
+                         w.reported ? (unsigned)(w.total_us / w.reported) : 0, (unsigned)w.max_us);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool console_journal(ups_console_t* c) {
+    ups_journal_record_t r;
+    if (!ups_journal_next(&c->cursor, &r)) {
+        return false;
+    }
+    console_line_end(c, ups_journal_format(&r, c->text, sizeof(c->text) - 2));
+    return true;
+}
+
+// 每行64字节（剩余字节数 + 填充），最后一行按剩余字节截短
+static bool console_flood(ups_console_t* c) {
+    if (c->remaining == 0) {
+        return false;
+    }
+    uint32_t n = c->remaining < 64 ? c->remaining : 64;
+    memset(c->text, '.', n);
+    if (n >= 12) {
+        snprintf(c->text, sizeof(c->text), "%08X", (unsigned)c->remaining);
+        c->text[8] = ' ';
+    }
+    if (n >= 2) {
+        c->text[n - 2] = '\r';
+    }
+    c->text[n - 1] = '\n';
+    c->text_len = (uint16_t)n;
+    c->text_pos = 0;
+    c->remaining -= n;
+    return true;
+}
+
+// 生成下一段输出到 text，当前命令的输出结束时返回 false
+static bool console_fill(ups_console_t* c) {
+    switch (c->mode) {
+        case CONSOLE_HELP:
+            if (c->step >= sizeof(console_help) / sizeof(console_help[0])) {
+                return false;
+            }
+            console_text(c, "%s", console_help[c->step++]);
+            return true;
+        case CONSOLE_STATUS:  return console_status(c);
+        case CONSOLE_POWER:   return console_power(c);
+        case CONSOLE_JOURNAL: return console_journal(c);
+        case CONSOLE_FLOOD:   return console_flood(c);
+        default:              return false;
+    }
+}
+
+static void console_execute(ups_console_t* c) {
+    char* cmd = c->line;
+    char* arg;
+
+    c->line[c->line_len] = '\0';
+    c->line_len = 0;
+    while (*cmd == ' ') {
+        cmd++;
+    }
+    arg = strchr(cmd, ' ');
+    if (arg != NULL) {
+        *arg++ = '\0';
+        while (*arg == ' ') {
+            arg++;
+        }
+    } else {
+        arg = cmd + strlen(cmd);
+    }
+    c->step = 0;
+    c->text_len = 0;
+    c->text_pos = 0;
+
+    if (*cmd == '\0') {
+        c->mode = CONSOLE_TEXT;
+    } else if (strcmp(cmd, "help") == 0) {
+        c->mode = CONSOLE_HELP;
+    } else if (strcmp(cmd, "status") == 0) {
+        c->mode = CONSOLE_STATUS;
+    } else if (strcmp(cmd, "power") == 0) {
+        c->mode = CONSOLE_POWER;
+    } else if (strcmp(cmd, "boot") == 0) {
+        c->mode = CONSOLE_TEXT;
+        console_line_end(c, ups_boot_format(c->text, sizeof(c->text) - 2));
+    } else if (strcmp(cmd, "journal") == 0) {
+        c->mode = CONSOLE_JOURNAL;
+        ups_journal_begin(&c->cursor);
+    } else if (strcmp(cmd, "export") == 0 && ups_export_command((uint8_t)arg[0]) != 0 && arg[1] == '\0') {
+        c->mode = CONSOLE_EXPORT;
+        ups_export_begin(&c->export, ups_export_command((uint8_t)arg[0]));
+    } else if (strcmp(cmd, "flood") == 0 && atoi(arg) > 0) {
+        c->mode = CONSOLE_FLOOD;
+        c->remaining = (uint32_t)atoi(arg) * 1024;
+    } else {
+        c->mode = CONSOLE_TEXT;
+        console_text(c, "unknown command '%s', try help\r\n", cmd);
+    }
+}
+
+void ups_console_input(ups_console_t* c, uint8_t byte) {
+    if (byte == CONSOLE_CTRL_C) {
+        // 中止：丢弃当前行和未发送的输出
+        c->line_len = 0;
+        c->mode = CONSOLE_TEXT;
+        console_text(c, "^C\r\n");
+        return;
+    }
+    if (c->mode != CONSOLE_IDLE) {
+        return;
+    }
+    if (byte == '\r' || byte == '\n') {
+        console_execute(c);
+    } else if ((byte == '\b' || byte == 0x7F) && c->line_len > 0) {
+        c->line_len--;
+    } else if (byte >= 0x20 && byte < 0x7F && c->line_len < UPS_CONSOLE_LINE_MAX - 1) {
+        c->line[c->line_len++] = (char)byte;
+    }
+}
+
+size_t ups_console_read(ups_console_t* c, uint8_t* buffer, size_t len) {
+    size_t n = 0;
+
+    while (n < len && c->mode != CONSOLE_IDLE) {
+        // 导出流直接编码到调用者的缓冲，结束后不输出提示符（流以 'E' 结尾）
+        if (c->mode == CONSOLE_EXPORT) {
+            size_t got = ups_export_read(&c->export, buffer + n, len - n);
+            if (got == 0) {
+                c->mode = CONSOLE_IDLE;
+            }
+            n += got;
+            continue;
+        }
+        if (c->text_pos < c->text_len) {
+            size_t chunk = c->text_len - c->text_pos;
+            if (chunk > len - n) {
+                chunk = len - n;
+            }
+            memcpy(buffer + n, c->text + c->text_pos, chunk);
+            c->text_pos += (uint16_t)chunk;
+            n += chunk;
+            continue;
+        }
+        if (console_fill(c)) {
+            continue;
+        }
+        if (c->mode == CONSOLE_PROMPT) {
+            c->mode = CONSOLE_IDLE;
+        } else {
+            c->mode = CONSOLE_PROMPT;
+            console_text(c, "%s", UPS_CONSOLE_PROMPT);
+        }
+    }
+    return n;
+}
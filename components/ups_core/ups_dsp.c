@@ -0,0 +1,192 @@
+#include <math.h>
+#include <string.h>
+#include "ups_dsp.h"
+
+#define BIQUAD_COEFF_BITS 28
+#define BIQUAD_STATE_BITS 8
+
+static inline int16_t dsp_sat16(int32_t x) {
+    return x > 32767 ? 32767 : x < -32768 ? -32768 : (int16_t)x;
+}
+
+void ups_dsp_fir_init(ups_dsp_fir_t* fir, const int16_t* coeffs, uint16_t taps, uint16_t decim) {
+    memset(fir, 0, sizeof(*fir));
+    fir->taps = taps > UPS_DSP_FIR_MAX_TAPS ? UPS_DSP_FIR_MAX_TAPS : taps;
+    fir->decim = decim == 0 ? 1 : decim > UPS_DSP_FIR_MAX_TAPS ? UPS_DSP_FIR_MAX_TAPS : decim;
+    memcpy(fir->coeffs, coeffs, fir->taps * sizeof(int16_t));
+
+#if UPS_DSP_HAVE_SIMD
+    memcpy(fir->simd_coeffs, coeffs, fir->taps * sizeof(int16_t));
+    dsps_fird_init_s16(&fir->simd, fir->simd_coeffs, fir->simd_delay, fir->taps, fir->decim, 0, 0);
+#endif
+}
+
+void ups_dsp_fir_prime(ups_dsp_fir_t* fir, int16_t x) {
+    for (uint16_t i = 0; i < 2 * fir->taps; i++) {
+        fir->delay[i] = x;
+    }
+#if UPS_DSP_HAVE_SIMD
+    for (uint16_t i = 0; i < sizeof(fir->simd_delay) / sizeof(fir->simd_delay[0]); i++) {
+        fir->simd_delay[i] = x;
+    }
+#endif
+}
+
+uint32_t ups_dsp_fir_decimate_c(ups_dsp_fir_t* fir, const int16_t* in, int16_t* out, uint32_t len) {
+    uint32_t produced = 0;
+    uint16_t taps = fir->taps;
+
+    for (uint32_t i = 0; i < len; i++) {
+        // 同一样本写两份，delay[pos..pos+taps) 始终是按时间顺序排列的最近 taps 个样本
+        fir->delay[fir->pos] = in[i];
+        fir->delay[fir->pos + taps] = in[i];
+        if (++fir->pos >= taps) {
+            fir->pos = 0;
+        }
+        if (++fir->phase < fir->decim) {
+            continue;
+        }
+        fir->phase = 0;
+
+        // 32位累加：抽头绝对值之和不超过约 2^16 时不会溢出（低通抽取器满足）
+        const int16_t* window = &fir->delay[fir->pos];
+        int32_t acc = 1 << 14;
+        for (uint16_t k = 0; k < taps; k++) {
+            acc += (int32_t)fir->coeffs[taps - 1 - k] * window[k];
+        }
+        out[produced++] = dsp_sat16(acc >> 15);
+    }
+    return produced;
+}
+
+uint32_t ups_dsp_fir_decimate(ups_dsp_fir_t* fir, const int16_t* in, int16_t* out, uint32_t len) {
+#if UPS_DSP_HAVE_SIMD
+    // dsps_fird_s16 只处理整组（每组 decim 个输入），组外的样本暂存到下一块
+    uint16_t decim = fir->decim;
+    uint32_t produced = 0;
+
+    if (fir->simd_pending_count > 0) {
+        uint32_t take = decim - fir->simd_pending_count;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(&fir->simd_pending[fir->simd_pending_count], in, take * sizeof(int16_t));
+        fir->simd_pending_count += take;
+        in += take;
+        len -= take;
+        if (fir->simd_pending_count < decim) {
+            return 0;
+        }
+        produced = (uint32_t)dsps_fird_s16(&fir->simd, fir->simd_pending, out, 1);
+        fir->simd_pending_count = 0;
+    }
+
+    uint32_t groups = len / decim;
+    if (groups > 0) {
+        produced += (uint32_t)dsps_fird_s16(&fir->simd, in, out + produced, (int32_t)groups);
+    }
+    fir->simd_pending_count = (uint16_t)(len - groups * decim);
+    memcpy(fir->simd_pending, in + groups * decim, fir->simd_pending_count * sizeof(int16_t));
+    return produced;
+#else
+    return ups_dsp_fir_decimate_c(fir, in, out, len);
+#endif
+}
+
+static void dsp_biquad_set(ups_dsp_biquad_t* bq, float b0, float b1, float b2, float a0, float a1, float a2) {
+    const float scale = (float)(1 << BIQUAD_COEFF_BITS);
+    memset(bq, 0, sizeof(*bq));
+    bq->b0 = (int32_t)lroundf(b0 / a0 * scale);
+    bq->b1 = (int32_t)lroundf(b1 / a0 * scale);
+    bq->b2 = (int32_t)lroundf(b2 / a0 * scale);
+    bq->a1 = (int32_t)lroundf(a1 / a0 * scale);
+    bq->a2 = (int32_t)lroundf(a2 / a0 * scale);
+}
+
+void ups_dsp_biquad_lowpass(ups_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_hz) {
+    float w0 = 2.0f * (float)M_PI * cutoff_hz / sample_hz;
+    float c = cosf(w0), alpha = sinf(w0) / (2.0f * (float)M_SQRT1_2);
+    dsp_biquad_set(bq, (1 - c) / 2, 1 - c, (1 - c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+}
+
+void ups_dsp_biquad_highpass(ups_dsp_biquad_t* bq, uint32_t cutoff_hz, uint32_t sample_hz) {
+    float w0 = 2.0f * (float)M_PI * cutoff_hz / sample_hz;
+    float c = cosf(w0), alpha = sinf(w0) / (2.0f * (float)M_SQRT1_2);
+    dsp_biquad_set(bq, (1 + c) / 2, -(1 + c), (1 + c) / 2, 1 + alpha, -2 * c, 1 - alpha);
+}
+
+void ups_dsp_biquad_prime(ups_dsp_biquad_t* bq, int16_t x) {
+    // 稳态 y = x * (b0+b1+b2) / (1+a1+a2)，只在初始化时做一次除法
+    int64_t num = (int64_t)bq->b0 + bq->b1 + bq->b2;
+    int64_t den = ((int64_t)1 << BIQUAD_COEFF_BITS) + bq->a1 + bq->a2;
+    bq->x1 = x;
+    bq->x2 = x;
+    bq->y1 = den != 0 ? (int32_t)(num * x * (1 << BIQUAD_STATE_BITS) / den) : 0;
+    bq->y2 = bq->y1;
+}
+
+void ups_dsp_biquad_process(ups_dsp_biquad_t* bq, const int16_t* in, int16_t* out, uint32_t len) {
+    int32_t x1 = bq->x1, x2 = bq->x2, y1 = bq->y1, y2 = bq->y2;
+
+    for (uint32_t i = 0; i < len; i++) {
+        int32_t x0 = in[i];
+        int64_t acc = ((int64_t)bq->b0 * x0 + (int64_t)bq->b1 * x1 + (int64_t)bq->b2 * x2) * (1 << BIQUAD_STATE_BITS);
+        acc -= (int64_t)bq->a1 * y1 + (int64_t)bq->a2 * y2;
+        int32_t y0 = (int32_t)(acc >> BIQUAD_COEFF_BITS);
+
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        out[i] = dsp_sat16(y0 >> BIQUAD_STATE_BITS);
+    }
+
+    bq->x1 = (int16_t)x1;
+    bq->x2 = (int16_t)x2;
+    bq->y1 = y1;
+    bq->y2 = y2;
+}
+
+int16_t ups_dsp_mean(const int16_t* in, uint32_t len) {
+    int32_t sum = 0;
+    if (len == 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        sum += in[i];
+    }
+    return (int16_t)(sum / (int32_t)len);
+}
+
+uint64_t ups_dsp_sum_squares(const int16_t* in, uint32_t len) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        sum += (uint32_t)((int32_t)in[i] * in[i]);
+    }
+    return sum;
+}
+
+uint16_t ups_dsp_rms(const int16_t* in, uint32_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    uint32_t rms = ups_dsp_isqrt(ups_dsp_sum_squares(in, len) / len);
+    return rms > 65535 ? 65535 : (uint16_t)rms;
+}
+
+uint32_t ups_dsp_isqrt(uint64_t x) {
+    uint64_t root = 0, bit = (uint64_t)1 << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
@@ -0,0 +1,89 @@
+#include <stdatomic.h>
+#include <string.h>
+#include "ups_port.h"
+#include "ups_event.h"
+
+static atomic_uint event_pending;
+
+// 合并后第一次投递的时刻（ups_port_micros），投递者在置位前写入
+static atomic_uint event_posted_us[UPS_EVENT_COUNT];
+
+// 以下只由状态任务访问（统计允许其他任务读到不一致的中间值）
+static uint32_t event_taken_us[UPS_EVENT_COUNT];
+static ups_event_stats_t event_stats[UPS_EVENT_COUNT];
+
+static const char* const event_names[UPS_EVENT_COUNT] = {
+    [UPS_EVENT_SAMPLE] = "sample",
+    [UPS_EVENT_TICK] = "tick",
+    [UPS_EVENT_MAINS] = "mains",
+    [UPS_EVENT_AC_GPIO] = "ac_gpio",
+    [UPS_EVENT_BUTTON] = "button",
+    [UPS_EVENT_USB] = "usb",
+    [UPS_EVENT_SHUTDOWN] = "shutdown",
+    [UPS_EVENT_STORE] = "store",
+};
+
+void ups_event_init(void) {
+    atomic_store(&event_pending, 0);
+    memset(event_taken_us, 0, sizeof(event_taken_us));
+    memset(event_stats, 0, sizeof(event_stats));
+}
+
+void ups_event_post(ups_event_t event) {
+    unsigned bit = UPS_EVENT_BIT(event);
+
+    // 已经在等待处理的事件保留最早的投递时刻
+    if (!(atomic_load_explicit(&event_pending, memory_order_relaxed) & bit)) {
+        atomic_store_explicit(&event_posted_us[event], ups_port_micros(), memory_order_relaxed);
+    }
+    // 之前没有待处理事件时状态任务可能在阻塞，需要唤醒；否则它取走事件前一定会再看到这一位
+    if (atomic_fetch_or_explicit(&event_pending, bit, memory_order_release) == 0) {
+        ups_port_event_wake();
+    }
+}
+
+uint32_t ups_event_take(void) {
+    uint32_t events = atomic_exchange_explicit(&event_pending, 0, memory_order_acquire);
+
+    for (uint32_t pending = events; pending != 0; pending &= pending - 1) {
+        unsigned event = (unsigned)__builtin_ctz(pending);
+        event_taken_us[event] = atomic_load_explicit(&event_posted_us[event], memory_order_relaxed);
+    }
+    return events;
+}
+
+void ups_event_published(uint32_t events) {
+    uint32_t now = ups_port_micros();
+
+    for (; events != 0; events &= events - 1) {
+        unsigned event = (unsigned)__builtin_ctz(events);
+        uint32_t latency = now - event_taken_us[event];
+        ups_event_stats_t* stats = &event_stats[event];
+        stats->count++;
+        stats->total_us += latency;
+        if (latency > stats->max_us) {
+            stats->max_us = latency;
+        }
+    }
+}
+
+uint32_t ups_event_first_posted_us(uint32_t events) {
+    uint32_t now = ups_port_micros();
+    uint32_t first = now;
+
+    for (; events != 0; events &= events - 1) {
+        unsigned event = (unsigned)__builtin_ctz(events);
+        if (now - event_taken_us[event] > now - first) {
+            first = event_taken_us[event];
+        }
+    }
+    return first;
+}
+
+void ups_event_get_stats(ups_event_t event, ups_event_stats_t* stats) {
+    *stats = event_stats[event];
+}
+
+const char* ups_event_name(ups_event_t event) {
+    return (unsigned)event < UPS_EVENT_COUNT ? event_names[event] : "?";
+}
@@ -0,0 +1,203 @@
+#include <string.h>
+#include "ups_battery.h"
+#include "ups_export.h"
+
+enum {
+    EXPORT_HEADER = 0,
+    EXPORT_TIER_START,
+    EXPORT_TIER_POINTS,
+    EXPORT_TIER_END,
+    EXPORT_JOURNAL_START,
+    EXPORT_JOURNAL_RECORDS,
+    EXPORT_JOURNAL_END,
+    EXPORT_END,
+    EXPORT_DONE,
+};
+
+uint8_t ups_export_command(uint8_t command) {
+    switch (command) {
+        case UPS_EXPORT_CMD_HISTORY: return UPS_EXPORT_HISTORY;
+        case UPS_EXPORT_CMD_JOURNAL: return UPS_EXPORT_JOURNAL;
+        case UPS_EXPORT_CMD_ALL:     return UPS_EXPORT_HISTORY | UPS_EXPORT_JOURNAL;
+        default:                     return 0;
+    }
+}
+
+void ups_export_begin(ups_export_t* x, uint8_t sections) {
+    memset(x, 0, sizeof(*x));
+    x->sections = sections;
+    x->stage = EXPORT_HEADER;
+}
+
+static void export_byte(ups_export_t* x, uint8_t b) {
+    x->item[x->item_len++] = b;
+}
+
+static void export_varint(ups_export_t* x, uint32_t v) {
+    while (v >= 0x80) {
+        export_byte(x, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    export_byte(x, (uint8_t)v);
+}
+
+static void export_zigzag(ups_export_t* x, int32_t v) {
+    export_varint(x, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+// 段内条目计入CRC；段结束时追加CRC
+static void export_section_item(ups_export_t* x, uint8_t start) {
+    x->crc = ups_journal_crc16_update(x->crc, &x->item[start], x->item_len - start);
+}
+
+static void export_section_end(ups_export_t* x) {
+    export_varint(x, 0);
+    export_section_item(x, 0);
+    export_byte(x, (uint8_t)x->crc);
+    export_byte(x, (uint8_t)(x->crc >> 8));
+}
+
+static void export_point(ups_export_t* x, uint32_t index, const ups_history_point_t* p) {
+    const ups_history_point_t* q = &x->prev_point;
+
+    export_varint(x, index - x->prev_index);
+    export_zigzag(x, (int32_t)p->battery_mv_mean - q->battery_mv_mean);
+    export_varint(x, (uint32_t)(p->battery_mv_mean - p->battery_mv_min));
+    export_varint(x, (uint32_t)(p->battery_mv_max - p->battery_mv_mean));
+    export_zigzag(x, (int32_t)p->load_ma_mean - q->load_ma_mean);
+    export_varint(x, (uint32_t)(p->load_ma_mean - p->load_ma_min));
+    export_varint(x, (uint32_t)(p->load_ma_max - p->load_ma_mean));
+    export_zigzag(x, (int32_t)p->battery_ma_mean - q->battery_ma_mean);
+    export_zigzag(x, (int32_t)p->mains_dv_mean - q->mains_dv_mean);
+    export_varint(x, (uint32_t)(p->status ^ q->status));
+    x->prev_index = index;
+    x->prev_point = *p;
+}
+
+static void export_record(ups_export_t* x, const ups_journal_record_t* r) {
+    const ups_journal_record_t* q = &x->prev_record;
+
+    export_varint(x, r->seq - q->seq);
+    export_zigzag(x, (int32_t)(r->time_ms - q->time_ms));
+    export_byte(x, r->event);
+    export_byte(x, r->detail);
+    export_varint(x, (uint32_t)(r->status ^ q->status));
+    export_zigzag(x, (int32_t)r->battery_mv - q->battery_mv);
+    x->prev_record = *r;
+}
+
+// 下一个历史段的起点，没有更多历史段时转到日志段
+static void export_next_tier(ups_export_t* x) {
+    if ((x->sections & UPS_EXPORT_HISTORY) && x->tier < UPS_HISTORY_TIERS) {
+        x->stage = EXPORT_TIER_START;
+    } else {
+        x->stage = (x->sections & UPS_EXPORT_JOURNAL) ? EXPORT_JOURNAL_START : EXPORT_END;
+    }
+}
+
+// 编码下一个条目到 x->item，导出结束时返回 false
+static bool export_fill(ups_export_t* x) {
+    x->item_len = 0;
+    x->item_pos = 0;
+
+    while (x->item_len == 0) {
+        switch (x->stage) {
+            case EXPORT_HEADER:
+                memcpy(x->item, "UPSX", 4);
+                x->item_len = 4;
+                export_byte(x, UPS_EXPORT_VERSION);
+                export_byte(x, UPS_BATTERY_SAMPLE_HZ);
+                export_byte(x, x->sections);
+                export_next_tier(x);
+                break;
+
+            case EXPORT_TIER_START: {
+                ups_history_tier_t tier = (ups_history_tier_t)x->tier;
+                x->end = ups_history_written(tier);
+                x->index = x->end - ups_history_count(tier);
+                x->prev_index = x->index - 1;
+                memset(&x->prev_point, 0, sizeof(x->prev_point));
+                x->crc = 0xFFFF;
+                export_byte(x, 'H');
+                export_byte(x, x->tier);
+                export_varint(x, ups_history_period_s(tier));
+                export_varint(x, x->index);
+                export_section_item(x, 0);
+                x->stage = EXPORT_TIER_POINTS;
+                break;
+            }
+
+            case EXPORT_TIER_POINTS: {
+                ups_history_point_t p;
+                if (x->index >= x->end) {
+                    x->stage = EXPORT_TIER_END;
+                    break;
+                }
+                // 读取期间被覆盖的点跳过（序号差大于1）
+                if (ups_history_get((ups_history_tier_t)x->tier, x->index, &p)) {
+                    export_point(x, x->index, &p);
+                    export_section_item(x, 0);
+                }
+                x->index++;
+                break;
+            }
+
+            case EXPORT_TIER_END:
+                export_section_end(x);
+                x->tier++;
+                export_next_tier(x);
+                break;
+
+            case EXPORT_JOURNAL_START:
+                ups_journal_begin(&x->cursor);
+                memset(&x->prev_record, 0, sizeof(x->prev_record));
+                x->crc = 0xFFFF;
+                export_byte(x, 'J');
+                export_section_item(x, 0);
+                x->stage = EXPORT_JOURNAL_RECORDS;
+                break;
+
+            case EXPORT_JOURNAL_RECORDS: {
+                ups_journal_record_t r;
+                if (ups_journal_next(&x->cursor, &r)) {
+                    export_record(x, &r);
+                    export_section_item(x, 0);
+                } else {
+                    x->stage = EXPORT_JOURNAL_END;
+                }
+                break;
+            }
+
+            case EXPORT_JOURNAL_END:
+                export_section_end(x);
+                x->stage = EXPORT_END;
+                break;
+
+            case EXPORT_END:
+                export_byte(x, 'E');
+                x->stage = EXPORT_DONE;
+                break;
+
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+size_t ups_export_read(ups_export_t* x, uint8_t* buffer, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        if (x->item_pos == x->item_len && !export_fill(x)) {
+            break;
+        }
+        size_t chunk = x->item_len - x->item_pos;
+        if (chunk > len - n) {
+            chunk = len - n;
+        }
+        memcpy(buffer + n, &x->item[x->item_pos], chunk);
+        x->item_pos += chunk;
+        n += chunk;
+    }
+    return n;
+}
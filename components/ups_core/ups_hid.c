@@ -0,0 +1,208 @@
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_notify.h"
+#include "ups_log.h"
+#include "ups_boot.h"
+#include "ups_shutdown.h"
+#include "ups_event.h"
+#include "ups_hid.h"
+
+// 总线挂起状态（TinyUSB任务写入，状态任务读取）
+static atomic_bool hid_suspended;
+static atomic_bool hid_remote_wakeup_en;
+
+// 远程唤醒后等待主机收到 PresentStatus：状态任务置位，TinyUSB任务统计后清除
+static atomic_bool wakeup_pending;
+static atomic_uint wakeup_event_us;
+static ups_hid_wakeup_stats_t wakeup_stats;
+
+uint16_t ups_hid_get_report(uint8_t instance, uint8_t report_id,
+                            uint8_t report_type, uint8_t* buffer, uint16_t reqlen)
+{
+    (void)instance;     // 只有一个 HID 接口，电池实例由报告ID区分
+
+    // 只处理Feature Report（类型3）
+    if (report_type != UPS_HID_REPORT_TYPE_FEATURE) {
+        ups_log_record(UPS_LOG_GET_BAD_TYPE, report_id, report_type, reqlen, 0);
+        return 0;
+    }
+
+    // 查表返回预序列化数据
+    uint16_t len = ups_report_get(report_id, buffer, reqlen);
+    if (len == 0) {
+        uint8_t event = ups_report_len(report_id) == 0 ? UPS_LOG_GET_UNKNOWN : UPS_LOG_GET_SHORT;
+        ups_log_record(event, report_id, report_type, reqlen, 0);
+    } else {
+        ups_boot_report_served();
+    }
+    return len;
+}
+
+// 回调中只解析并记录，不做格式化输出
+void ups_hid_set_report(uint8_t instance, uint8_t report_id,
+                        uint8_t report_type, uint8_t const* buffer, uint16_t bufsize)
+{
+    (void)instance;
+
+    if (report_type != UPS_HID_REPORT_TYPE_FEATURE || bufsize < 1) {
+        ups_log_record(UPS_LOG_SET_UNKNOWN, report_id, report_type, bufsize, 0);
+        return;
+    }
+
+    uint8_t const* data = buffer + 1;
+    uint16_t data_size = bufsize - 1;
+    uint16_t value = 0;
+
+    // 各实例的报告按单实例ID处理，实例号超出范围的报告不存在
+    if (UPS_REPORT_INSTANCE(report_id) >= UPS_INSTANCE_COUNT) {
+        ups_log_record(UPS_LOG_SET_UNKNOWN, report_id, report_type, bufsize, 0);
+        return;
+    }
+
+    switch (UPS_REPORT_LOCAL_ID(report_id)) {
+        // ==================== 关机/重启倒计时（buffer 为负载，不含 Report ID） ====================
+        case HID_PD_DELAYBE4SHUTDOWN:
+        case HID_PD_DELAYBE4REBOOT:
+            if (bufsize < 2) {
+                ups_log_record(UPS_LOG_SET_UNKNOWN, report_id, report_type, bufsize, 0);
+                return;
+            }
+            value = (uint16_t)(buffer[0] | buffer[1] << 8);
+            ups_shutdown_set(report_id, (int16_t)value);
+            break;
+
+        // ==================== Report ID 1: 主交流输入配置 ====================
+        case 0x01: // 主交流输入配置，value = 电压(V)
+            if (data_size >= 4) {
+                value = data[2] * 128;
+                // 硬件控制代码
+            }
+            break;
+
+        // ==================== Report ID 2: 备份直流流配置 ====================
+        case 0x02: // 备份直流流配置，value = 电压(mV)
+            if (data_size >= 5) {
+                value = ((data[3] << 8) | data[2]) * 32;
+                // 硬件控制代码
+            }
+            break;
+
+        case 0x03: // 输出交流流配置，value = 电压(V)
+            if (data_size >= 6) {
+                value = data[2] * 128;
+                // 硬件控制代码
+            }
+            break;
+
+        case 0x06: // 电池配置，value = 电压(mV)
+            if (data_size >= 11) {
+                value = ((data[6] << 8) | data[5]) * 32;
+                // 硬件控制代码
+            }
+            break;
+
+        case 0x0B: // 电源摘要配置，value = 电压(mV)
+            if (data_size >= 28) {
+                value = ((data[16] << 8) | data[15]) * 32;
+                // 硬件控制代码
+            }
+            break;
+
+        default:
+            ups_log_record(UPS_LOG_SET_UNKNOWN, report_id, report_type, bufsize, 0);
+            return;
+    }
+
+    ups_log_record(UPS_LOG_SET, report_id, report_type, bufsize, value);
+}
+
+// SET_PROTOCOL
+void ups_hid_set_protocol(uint8_t instance, uint8_t protocol)
+{
+    (void)instance;
+    ups_log_record(UPS_LOG_SET_PROTOCOL, 0, 0, 0, protocol);
+}
+
+// 设备枚举完成：报告表从上电起就在更新，直接推送当前Input状态
+void ups_hid_mount(void) {
+    atomic_store(&hid_suspended, false);
+    atomic_store(&wakeup_pending, false);
+    ups_notify_reset();
+    ups_boot_mark(UPS_BOOT_MOUNTED);
+    ups_log_record(UPS_LOG_MOUNT, 0, 0, 0, 0);
+    ups_notify_resync();
+    ups_event_post(UPS_EVENT_USB);
+}
+
+// 断开/挂起后重新枚举前，丢弃未完成的传输；状态任务照常运行
+void ups_hid_unmount(void) {
+    atomic_store(&hid_suspended, false);
+    atomic_store(&wakeup_pending, false);
+    ups_notify_reset();
+    ups_log_record(UPS_LOG_UNMOUNT, 0, 0, 0, 0);
+}
+
+// 挂起期间中断IN端点不可用，变化的报告留在待发集合中
+void ups_hid_suspend(bool remote_wakeup_en) {
+    atomic_store(&hid_remote_wakeup_en, remote_wakeup_en);
+    atomic_store(&hid_suspended, true);
+    ups_log_record(UPS_LOG_SUSPEND, 0, 0, 0, remote_wakeup_en);
+}
+
+// 恢复后先发出挂起期间积累的报告，再发布一次最新快照
+void ups_hid_resume(void) {
+    atomic_store(&hid_suspended, false);
+    if (atomic_load(&wakeup_pending)) {
+        uint32_t latency = ups_port_micros() - atomic_load(&wakeup_event_us);
+        wakeup_stats.resumed++;
+        wakeup_stats.resume_total_us += latency;
+        if (latency > wakeup_stats.resume_max_us) {
+            wakeup_stats.resume_max_us = latency;
+        }
+    }
+    ups_log_record(UPS_LOG_RESUME, 0, 0, 0, 0);
+    ups_notify_flush();
+    ups_event_post(UPS_EVENT_USB);
+}
+
+bool ups_hid_suspended(void) {
+    return atomic_load(&hid_suspended);
+}
+
+bool ups_hid_remote_wakeup(uint16_t status, uint32_t event_us) {
+    if (!atomic_load(&hid_suspended) || !atomic_load(&hid_remote_wakeup_en) || !ups_port_hid_remote_wakeup()) {
+        return false;
+    }
+    // 主机恢复前再次唤醒时保留最早的事件时刻
+    if (!atomic_load(&wakeup_pending)) {
+        atomic_store(&wakeup_event_us, event_us);
+        atomic_store(&wakeup_pending, true);
+    }
+    wakeup_stats.wakeups++;
+    ups_log_record(UPS_LOG_REMOTE_WAKEUP, 0, 0, 0, status);
+    return true;
+}
+
+void ups_hid_get_wakeup_stats(ups_hid_wakeup_stats_t* stats) {
+    *stats = wakeup_stats;
+}
+
+// 中断IN传输完成
+void ups_hid_report_complete(uint8_t instance) {
+    (void)instance;
+    uint8_t report_id = ups_notify_report_complete();
+
+    // 远程唤醒后主机收到任一实例的 PresentStatus（按发送优先级排在最前）
+    if (UPS_REPORT_LOCAL_ID(report_id) == HID_PD_PRESENTSTATUS && atomic_load(&wakeup_pending)) {
+        uint32_t latency = ups_port_micros() - atomic_load(&wakeup_event_us);
+        atomic_store(&wakeup_pending, false);
+        wakeup_stats.reported++;
+        wakeup_stats.last_us = latency;
+        wakeup_stats.total_us += latency;
+        if (latency > wakeup_stats.max_us) {
+            wakeup_stats.max_us = latency;
+        }
+    }
+}
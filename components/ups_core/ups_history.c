@@ -0,0 +1,152 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "ups_battery.h"
+#include "ups_history.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+// 开启 CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY 时放在 PSRAM，否则为内部RAM
+#define HISTORY_RAM EXT_RAM_BSS_ATTR
+#else
+#define HISTORY_RAM
+#endif
+
+// 区间累加器：原始采样的和、最值与个数，逐级向上合并
+typedef struct {
+    int64_t battery_mv_sum;
+    int64_t load_ma_sum;
+    int64_t battery_ma_sum;
+    int64_t mains_dv_sum;
+    uint32_t samples;
+    uint16_t battery_mv_min;
+    uint16_t battery_mv_max;
+    uint16_t load_ma_min;
+    uint16_t load_ma_max;
+    uint16_t status;
+    uint16_t children;              // 已并入的下一级区间数（最细一级为采样数）
+} history_accum_t;
+
+typedef struct {
+    ups_history_point_t* ring;
+    uint32_t points;                // 可读点数，环形缓冲为 points + 1 个槽
+    uint32_t period_s;
+    uint16_t children;              // 每个区间包含的下一级区间数
+    atomic_uint written;
+    history_accum_t accum;
+} history_tier_t;
+
+static HISTORY_RAM ups_history_point_t history_1s[UPS_HISTORY_SLOTS(UPS_HISTORY_1S_POINTS)];
+static HISTORY_RAM ups_history_point_t history_1min[UPS_HISTORY_SLOTS(UPS_HISTORY_1MIN_POINTS)];
+static HISTORY_RAM ups_history_point_t history_15min[UPS_HISTORY_SLOTS(UPS_HISTORY_15MIN_POINTS)];
+
+static history_tier_t history_tiers[UPS_HISTORY_TIERS] = {
+    [UPS_HISTORY_1S] = { history_1s, UPS_HISTORY_1S_POINTS, 1, UPS_BATTERY_SAMPLE_HZ },
+    [UPS_HISTORY_1MIN] = { history_1min, UPS_HISTORY_1MIN_POINTS, 60, 60 },
+    [UPS_HISTORY_15MIN] = { history_15min, UPS_HISTORY_15MIN_POINTS, 15 * 60, 15 },
+};
+
+static void history_accum_reset(history_accum_t* a) {
+    memset(a, 0, sizeof(*a));
+    a->battery_mv_min = UINT16_MAX;
+    a->load_ma_min = UINT16_MAX;
+}
+
+void ups_history_init(void) {
+    for (int i = 0; i < UPS_HISTORY_TIERS; i++) {
+        atomic_store(&history_tiers[i].written, 0);
+        history_accum_reset(&history_tiers[i].accum);
+    }
+}
+
+// 将下一级的累加器（或单个采样）并入本级
+static void history_merge(history_accum_t* dst, const history_accum_t* src) {
+    dst->battery_mv_sum += src->battery_mv_sum;
+    dst->load_ma_sum += src->load_ma_sum;
+    dst->battery_ma_sum += src->battery_ma_sum;
+    dst->mains_dv_sum += src->mains_dv_sum;
+    dst->samples += src->samples;
+    if (src->battery_mv_min < dst->battery_mv_min) dst->battery_mv_min = src->battery_mv_min;
+    if (src->battery_mv_max > dst->battery_mv_max) dst->battery_mv_max = src->battery_mv_max;
+    if (src->load_ma_min < dst->load_ma_min) dst->load_ma_min = src->load_ma_min;
+    if (src->load_ma_max > dst->load_ma_max) dst->load_ma_max = src->load_ma_max;
+    dst->status = src->status;
+    dst->children++;
+}
+
+static int64_t history_mean(int64_t sum, uint32_t n) {
+    return sum >= 0 ? (sum + n / 2) / n : (sum - (int64_t)(n / 2)) / n;
+}
+
+// 区间结束：写入环形缓冲后发布序号（读者据此判断槽位是否被覆盖）
+static void history_close(history_tier_t* tier) {
+    const history_accum_t* a = &tier->accum;
+    unsigned written = atomic_load_explicit(&tier->written, memory_order_relaxed);
+    ups_history_point_t* p = &tier->ring[written % (tier->points + 1)];
+
+    p->battery_mv_min = a->battery_mv_min;
+    p->battery_mv_max = a->battery_mv_max;
+    p->battery_mv_mean = (uint16_t)history_mean(a->battery_mv_sum, a->samples);
+    p->load_ma_min = a->load_ma_min;
+    p->load_ma_max = a->load_ma_max;
+    p->load_ma_mean = (uint16_t)history_mean(a->load_ma_sum, a->samples);
+    p->battery_ma_mean = (int16_t)history_mean(a->battery_ma_sum, a->samples);
+    p->mains_dv_mean = (uint16_t)history_mean(a->mains_dv_sum, a->samples);
+    p->status = a->status;
+    atomic_store_explicit(&tier->written, written + 1, memory_order_release);
+}
+
+void ups_history_sample(const ups_history_sample_t* sample) {
+    history_accum_t one = {
+        .battery_mv_sum = sample->battery_mv,
+        .load_ma_sum = sample->load_ma,
+        .battery_ma_sum = sample->battery_ma,
+        .mains_dv_sum = sample->mains_dv,
+        .samples = 1,
+        .battery_mv_min = sample->battery_mv,
+        .battery_mv_max = sample->battery_mv,
+        .load_ma_min = sample->load_ma,
+        .load_ma_max = sample->load_ma,
+        .status = sample->status,
+    };
+
+    // 逐级合并：只有区间结束时才继续向上（每秒一次、每分钟一次、每15分钟一次）
+    history_merge(&history_tiers[0].accum, &one);
+    for (int i = 0; i < UPS_HISTORY_TIERS; i++) {
+        history_tier_t* tier = &history_tiers[i];
+        if (tier->accum.children < tier->children) {
+            return;
+        }
+        history_close(tier);
+        if (i + 1 < UPS_HISTORY_TIERS) {
+            history_merge(&history_tiers[i + 1].accum, &tier->accum);
+        }
+        history_accum_reset(&tier->accum);
+    }
+}
+
+uint32_t ups_history_period_s(ups_history_tier_t tier) {
+    return history_tiers[tier].period_s;
+}
+
+uint32_t ups_history_written(ups_history_tier_t tier) {
+    return atomic_load_explicit(&history_tiers[tier].written, memory_order_acquire);
+}
+
+uint32_t ups_history_count(ups_history_tier_t tier) {
+    uint32_t written = ups_history_written(tier);
+    return written < history_tiers[tier].points ? written : history_tiers[tier].points;
+}
+
+// 读取后再检查序号：写入者已经写到（或正在写） index + points + 1 的槽位时，本次读到的数据可能已被覆盖
+bool ups_history_get(ups_history_tier_t tier, uint32_t index, ups_history_point_t* point) {
+    const history_tier_t* t = &history_tiers[tier];
+    uint32_t written = atomic_load_explicit(&t->written, memory_order_acquire);
+
+    if (index >= written || written - index > t->points) {
+        return false;
+    }
+    *point = t->ring[index % (t->points + 1)];
+    atomic_thread_fence(memory_order_acquire);
+    written = atomic_load_explicit(&t->written, memory_order_relaxed);
+    return written - index <= t->points;
+}
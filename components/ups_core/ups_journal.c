@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_journal.h"
+
+static const char *TAG = "JOURNAL";
+
+_Static_assert((UPS_JOURNAL_QUEUE_SIZE & (UPS_JOURNAL_QUEUE_SIZE - 1)) == 0, "queue size must be a power of 2");
+
+#define JOURNAL_SLOTS      (UPS_JOURNAL_SECTOR_SIZE / UPS_JOURNAL_RECORD_SIZE)
+#define JOURNAL_QUEUE_MASK (UPS_JOURNAL_QUEUE_SIZE - 1)
+
+// 写入位置（只在写入任务中修改）
+static const ups_journal_flash_t* journal_flash;
+static uint32_t journal_sectors;
+static uint32_t journal_head_sector;
+static uint32_t journal_head_slot;          // 下一个写入槽位，JOURNAL_SLOTS 表示扇区已满
+static atomic_uint journal_seq;             // 下一个序号，0 表示未挂载
+
+// 单生产者（状态任务）单消费者（写入任务）队列，记录的序号在写入时分配
+static ups_journal_record_t journal_queue[UPS_JOURNAL_QUEUE_SIZE];
+static atomic_uint journal_queue_head;
+static atomic_uint journal_queue_tail;
+static atomic_uint journal_dropped_count;
+
+uint16_t ups_journal_crc16_update(uint16_t crc, const void* data, size_t len) {
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    const uint8_t* p = data;
+    while (len--) {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*p >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*p & 0x0F)]);
+        p++;
+    }
+    return crc;
+}
+
+uint16_t ups_journal_crc16(const void* data, size_t len) {
+    return ups_journal_crc16_update(0xFFFF, data, len);
+}
+
+static bool journal_erased(const ups_journal_record_t* r) {
+    const uint8_t* p = (const uint8_t*)r;
+    for (int i = 0; i < UPS_JOURNAL_RECORD_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool journal_valid(const ups_journal_record_t* r) {
+    return r->seq != 0 && r->seq != UINT32_MAX &&
+           ups_journal_crc16(r, offsetof(ups_journal_record_t, crc)) == r->crc;
+}
+
+static bool journal_read_slot(uint32_t sector, uint32_t slot, ups_journal_record_t* r) {
+    return journal_flash->read(sector * UPS_JOURNAL_SECTOR_SIZE + slot * UPS_JOURNAL_RECORD_SIZE, r, sizeof(*r));
+}
+
+// 扇区中第一条有效记录的序号，没有时为 0。通常只读第一个槽位；
+// 第一个槽位写入中途掉电时继续向后找，遇到擦除状态的槽位即停止
+static uint32_t journal_sector_first(uint32_t sector) {
+    ups_journal_record_t r;
+    for (uint32_t slot = 0; slot < JOURNAL_SLOTS; slot++) {
+        if (!journal_read_slot(sector, slot, &r) || journal_erased(&r)) {
+            return 0;
+        }
+        if (journal_valid(&r)) {
+            return r.seq;
+        }
+    }
+    return 0;
+}
+
+bool ups_journal_mount(const ups_journal_flash_t* flash) {
+    if (flash->size < 2 * UPS_JOURNAL_SECTOR_SIZE) {
+        UPS_LOGE(TAG, "Partition too small: %u bytes", (unsigned)flash->size);
+        return false;
+    }
+    journal_flash = flash;
+    journal_sectors = flash->size / UPS_JOURNAL_SECTOR_SIZE;
+
+    // 最新的扇区：第一条记录序号最大
+    uint32_t best = 0;
+    journal_head_sector = 0;
+    for (uint32_t s = 0; s < journal_sectors; s++) {
+        uint32_t first = journal_sector_first(s);
+        if (first > best) {
+            best = first;
+            journal_head_sector = s;
+        }
+    }
+
+    // 最新扇区内找第一个擦除状态的槽位，中途损坏的记录跳过
+    uint32_t last = 0;
+    journal_head_slot = 0;
+    if (best != 0) {
+        ups_journal_record_t r;
+        while (journal_head_slot < JOURNAL_SLOTS) {
+            if (!journal_read_slot(journal_head_sector, journal_head_slot, &r)) {
+                return false;
+            }
+            if (journal_erased(&r)) {
+                break;
+            }
+            if (journal_valid(&r) && r.seq > last) {
+                last = r.seq;
+            }
+            journal_head_slot++;
+        }
+    }
+    atomic_store_explicit(&journal_seq, last + 1, memory_order_release);
+    UPS_LOGI(TAG, "Mounted: %u sectors, head %u/%u, next seq %u", (unsigned)journal_sectors,
+             (unsigned)journal_head_sector, (unsigned)journal_head_slot, (unsigned)(last + 1));
+    return true;
+}
+
+// 追加一条记录：扇区写满时转到下一个扇区并先擦除（回收最旧的记录）
+static bool journal_append(ups_journal_record_t* r) {
+    if (journal_head_slot >= JOURNAL_SLOTS) {
+        journal_head_sector = (journal_head_sector + 1) % journal_sectors;
+        journal_head_slot = 0;
+    }
+    if (journal_head_slot == 0 && !journal_flash->erase_sector(journal_head_sector * UPS_JOURNAL_SECTOR_SIZE)) {
+        return false;
+    }
+
+    r->seq = atomic_load_explicit(&journal_seq, memory_order_relaxed);
+    r->crc = ups_journal_crc16(r, offsetof(ups_journal_record_t, crc));
+    uint32_t offset = journal_head_sector * UPS_JOURNAL_SECTOR_SIZE + journal_head_slot * UPS_JOURNAL_RECORD_SIZE;
+
+    // 写入失败的槽位可能已部分写入，不再使用
+    journal_head_slot++;
+    if (!journal_flash->write(offset, r, sizeof(*r))) {
+        return false;
+    }
+    atomic_store_explicit(&journal_seq, r->seq + 1, memory_order_release);
+    return true;
+}
+
+void ups_journal_init(void) {
+    journal_flash = NULL;
+    journal_sectors = 0;
+    atomic_store(&journal_seq, 0);
+    atomic_store(&journal_queue_head, 0);
+    atomic_store(&journal_queue_tail, 0);
+    atomic_store(&journal_dropped_count, 0);
+}
+
+void ups_journal_post(uint8_t event, uint8_t detail, uint16_t status, uint16_t battery_mv) {
+    unsigned head = atomic_load_explicit(&journal_queue_head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&journal_queue_tail, memory_order_acquire) >= UPS_JOURNAL_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&journal_dropped_count, 1, memory_order_relaxed);
+        return;
+    }
+    journal_queue[head & JOURNAL_QUEUE_MASK] = (ups_journal_record_t){
+        .time_ms = ups_port_millis(),
+        .event = event,
+        .detail = detail,
+        .status = status,
+        .battery_mv = battery_mv,
+    };
+    atomic_store_explicit(&journal_queue_head, head + 1, memory_order_release);
+    ups_port_store_kick();
+}
+
+bool ups_journal_flush(void) {
+    if (atomic_load_explicit(&journal_seq, memory_order_relaxed) == 0) {
+        return false;
+    }
+    unsigned tail = atomic_load_explicit(&journal_queue_tail, memory_order_relaxed);
+    while (tail != atomic_load_explicit(&journal_queue_head, memory_order_acquire)) {
+        ups_journal_record_t r = journal_queue[tail & JOURNAL_QUEUE_MASK];
+        if (!journal_append(&r)) {
+            return false;
+        }
+        atomic_store_explicit(&journal_queue_tail, ++tail, memory_order_release);
+    }
+    return true;
+}
+
+uint32_t ups_journal_next_seq(void) {
+    return atomic_load_explicit(&journal_seq, memory_order_acquire);
+}
+
+uint32_t ups_journal_capacity(void) {
+    // 写入新扇区前会擦除一个扇区
+    return journal_sectors ? (journal_sectors - 1) * JOURNAL_SLOTS : 0;
+}
+
+uint32_t ups_journal_dropped(void) {
+    return atomic_load_explicit(&journal_dropped_count, memory_order_relaxed);
+}
+
+// 从最新扇区的下一个扇区（最旧）开始；挂载完成前（序号为 0）没有可读的记录
+void ups_journal_begin(ups_journal_cursor_t* cursor) {
+    bool mounted = atomic_load_explicit(&journal_seq, memory_order_acquire) != 0;
+    cursor->sector = mounted ? (journal_head_sector + 1) % journal_sectors : 0;
+    cursor->slot = 0;
+    cursor->sectors_left = mounted ? journal_sectors : 0;
+    cursor->last_seq = 0;
+}
+
+bool ups_journal_next(ups_journal_cursor_t* cursor, ups_journal_record_t* record) {
+    while (cursor->sectors_left > 0) {
+        if (cursor->slot >= JOURNAL_SLOTS) {
+            cursor->sector = (cursor->sector + 1) % journal_sectors;
+            cursor->slot = 0;
+            cursor->sectors_left--;
+            continue;
+        }
+        if (!journal_read_slot(cursor->sector, cursor->slot, record)) {
+            return false;
+        }
+        cursor->slot++;
+        if (journal_erased(record)) {
+            cursor->slot = JOURNAL_SLOTS;       // 扇区内其余槽位尚未写入
+            continue;
+        }
+        if (journal_valid(record) && record->seq > cursor->last_seq) {
+            cursor->last_seq = record->seq;
+            return true;
+        }
+    }
+    return false;
+}
+
+// PresentStatus 各位的名称（与 ups_state.h 的位定义一致）
+static const char* const journal_status_names[16] = {
+    "Charging", "Discharging", "ACPresent", "BatteryPresent",
+    "BelowRemainingCapacityLimit", "RemainingTimeLimitExpired", "NeedReplacement", "VoltageNotRegulated",
+    "FullyCharged", "FullyDischarged", "ShutdownRequested", "ShutdownImminent",
+    "CommunicationLost", "Overload", "bit14", "bit15",
+};
+
+const char* ups_journal_status_name(uint8_t bit) {
+    return journal_status_names[bit & 0x0F];
+}
+
+int ups_journal_format(const ups_journal_record_t* r, char* buffer, size_t buflen) {
+    switch (r->event) {
+        case UPS_JOURNAL_BOOT:
+            return snprintf(buffer, buflen, "#%u [%u] Boot, reset reason %u",
+                            (unsigned)r->seq, (unsigned)r->time_ms, r->detail);
+        case UPS_JOURNAL_STATUS:
+            return snprintf(buffer, buflen, "#%u [%u] %s %s, status=0x%04X, battery=%umV",
+                            (unsigned)r->seq, (unsigned)r->time_ms, journal_status_names[r->detail & 0x0F],
+                            (r->detail & UPS_JOURNAL_STATUS_SET) ? "set" : "cleared", r->status, r->battery_mv);
+        default:
+            return snprintf(buffer, buflen, "#%u [%u] Event %u detail %u",
+                            (unsigned)r->seq, (unsigned)r->time_ms, r->event, r->detail);
+    }
+}
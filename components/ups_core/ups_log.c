@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_log.h"
+
+_Static_assert((UPS_LOG_RING_SIZE & (UPS_LOG_RING_SIZE - 1)) == 0, "ring size must be a power of 2");
+
+// 有界MPSC环形队列：每个槽位带序列号，写者用CAS抢占写入位置，
+// 写完再更新槽位序列号，消费者据此判断槽位是否已写完。
+// 槽位中保存的是“序列号 - 槽位下标”，静态清零即为合法初态，无需初始化
+typedef struct {
+    atomic_uint seq;
+    ups_log_record_t record;
+} ups_log_cell_t;
+
+#define LOG_MASK (UPS_LOG_RING_SIZE - 1)
+
+static ups_log_cell_t log_ring[UPS_LOG_RING_SIZE];
+static atomic_uint log_head = 0;
+static unsigned log_tail = 0;
+static atomic_uint log_dropped_count = 0;
+
+static inline unsigned log_cell_seq(unsigned idx, memory_order order) {
+    return atomic_load_explicit(&log_ring[idx].seq, order) + idx;
+}
+
+static inline void log_cell_set_seq(unsigned idx, unsigned seq) {
+    atomic_store_explicit(&log_ring[idx].seq, seq - idx, memory_order_release);
+}
+
+void ups_log_record(uint8_t event, uint8_t report_id, uint8_t report_type, uint16_t len, uint16_t value) {
+    unsigned pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+    for (;;) {
+        int diff = (int)(log_cell_seq(pos & LOG_MASK, memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&log_head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 队列满：丢弃，不阻塞回调
+            atomic_fetch_add_explicit(&log_dropped_count, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+        }
+    }
+
+    log_ring[pos & LOG_MASK].record = (ups_log_record_t) {
+        .timestamp_ms = ups_port_millis(),
+        .event = event,
+        .report_id = report_id,
+        .report_type = report_type,
+        .len = len,
+        .value = value,
+    };
+    log_cell_set_seq(pos & LOG_MASK, pos + 1);
+}
+
+bool ups_log_pop(ups_log_record_t* record) {
+    unsigned idx = log_tail & LOG_MASK;
+    if ((int)(log_cell_seq(idx, memory_order_acquire) - (log_tail + 1)) < 0) {
+        return false;
+    }
+
+    *record = log_ring[idx].record;
+    log_cell_set_seq(idx, log_tail + UPS_LOG_RING_SIZE);
+    log_tail++;
+    return true;
+}
+
+uint32_t ups_log_dropped(void) {
+    return atomic_load_explicit(&log_dropped_count, memory_order_relaxed);
+}
+
+int ups_log_format(const ups_log_record_t* r, char* buffer, size_t buflen) {
+    switch (r->event) {
+        case UPS_LOG_GET_BAD_TYPE:
+            return snprintf(buffer, buflen, "[%u] Unsupported report type: %u",
+                            (unsigned)r->timestamp_ms, r->report_type);
+        case UPS_LOG_GET_UNKNOWN:
+            return snprintf(buffer, buflen, "[%u] Unknown feature report ID: 0x%02X",
+                            (unsigned)r->timestamp_ms, r->report_id);
+        case UPS_LOG_GET_SHORT:
+            return snprintf(buffer, buflen, "[%u] Request length too short for report ID: 0x%02X, ReqLen=%u",
+                            (unsigned)r->timestamp_ms, r->report_id, r->len);
+        case UPS_LOG_SET:
+            return snprintf(buffer, buflen, "[%u] Set report: ID=0x%02X, Type=%u, Size=%u, Value=%u",
+                            (unsigned)r->timestamp_ms, r->report_id, r->report_type, r->len, r->value);
+        case UPS_LOG_SET_UNKNOWN:
+            return snprintf(buffer, buflen, "[%u] Unknown report ID: 0x%02X, Type=%u, Size=%u",
+                            (unsigned)r->timestamp_ms, r->report_id, r->report_type, r->len);
+        case UPS_LOG_SET_PROTOCOL:
+            return snprintf(buffer, buflen, "[%u] Protocol set to: %u",
+                            (unsigned)r->timestamp_ms, r->value);
+        case UPS_LOG_MOUNT:
+            return snprintf(buffer, buflen, "[%u] USB mounted", (unsigned)r->timestamp_ms);
+        case UPS_LOG_UNMOUNT:
+            return snprintf(buffer, buflen, "[%u] USB unmounted", (unsigned)r->timestamp_ms);
+        case UPS_LOG_SUSPEND:
+            return snprintf(buffer, buflen, "[%u] USB suspended, remote wakeup %s",
+                            (unsigned)r->timestamp_ms, r->value ? "enabled" : "disabled");
+        case UPS_LOG_RESUME:
+            return snprintf(buffer, buflen, "[%u] USB resumed", (unsigned)r->timestamp_ms);
+        case UPS_LOG_REMOTE_WAKEUP:
+            return snprintf(buffer, buflen, "[%u] Remote wakeup: status 0x%04X",
+                            (unsigned)r->timestamp_ms, r->value);
+        default:
+            return snprintf(buffer, buflen, "[%u] Event %u: ID=0x%02X",
+                            (unsigned)r->timestamp_ms, r->event, r->report_id);
+    }
+}
@@ -0,0 +1,327 @@
+#include <string.h>
+#include "ups_dsp.h"
+#include "ups_seqbuf.h"
+#include "ups_mains.h"
+
+// 半周期有效范围（40~70Hz），超出范围的过零视为失步
+#define MAINS_HZ_UPPER       70
+#define MAINS_HZ_LOWER       40
+// 锁定前的过零迟滞（Q15），锁定后为标称峰值的 1/8
+#define MAINS_HYST_DEFAULT   1024
+// 包络比较只在 sin >= 0.5 的相位区间（30°~150°）进行，过零附近不判定
+#define MAINS_ENVELOPE_MIN   16384
+// 瞬时判定需要连续超限 1ms
+#define MAINS_CONFIRM_MS     1
+// √2（Q16）
+#define MAINS_SQRT2_Q16      92682
+
+// 1/4 周期正弦表（Q15），65 点
+static const int16_t mains_sine[65] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767,
+};
+
+// 自动选择标称电压时的候选值（厘伏）
+static const uint16_t mains_nominal_cv[] = { 10000, 11000, 11500, 12000, 12700, 22000, 23000, 24000 };
+
+static ups_mains_config_t mains_config;
+static uint32_t mains_hz;
+static int32_t mains_gain_q16;
+
+// 消费任务私有：过零跟踪、半周累计和判定状态
+static ups_mains_status_t mains_current;
+static uint32_t mains_samples;
+static uint32_t mains_peak;             // 标称峰值（Q15 计数），0 表示尚未确定
+static int32_t mains_hyst;
+static uint32_t mains_confirm;
+static uint32_t mains_min_half_q8;
+static uint32_t mains_max_half_q8;
+static uint32_t mains_ref_half_q8;      // 最近一个有效半周的长度，用于推算相位
+static uint32_t mains_step_q16;         // 每个样本的相位增量（半周 = 65536）
+static uint32_t mains_prev_half_q8;
+static int8_t mains_polarity;           // +1/-1，0 表示失步
+static int16_t mains_prev;
+static uint32_t mains_pos_q8;           // 距上一个确认过零点的样本数（Q8）
+static uint32_t mains_cross_q8;         // 候选过零点（Q8），0 表示没有
+static uint64_t mains_sum;
+static uint32_t mains_count;
+static uint32_t mains_sag;
+static uint32_t mains_outage;
+static uint32_t mains_swell;
+static ups_mains_state_t mains_settle;
+static uint32_t mains_settle_count;
+
+// 已发布的结果，ups_mains_process（在 ups_sense 的消费任务中调用）是唯一的写者（见 ups_seqbuf.h）
+static ups_mains_status_t mains_bank[2];
+static ups_seqbuf_t mains_published;
+
+static void mains_reset_tracking(void) {
+    mains_polarity = 0;
+    mains_prev = 0;
+    mains_pos_q8 = 0;
+    mains_cross_q8 = 0;
+    mains_sum = 0;
+    mains_count = 0;
+    mains_sag = 0;
+    mains_outage = 0;
+    mains_swell = 0;
+    mains_settle = UPS_MAINS_UNKNOWN;
+    mains_settle_count = 0;
+}
+
+static void mains_set_ref(uint32_t half_q8) {
+    mains_ref_half_q8 = half_q8;
+    mains_step_q16 = (65536u * 256u) / half_q8;
+}
+
+// 标称值确定后换算峰值和迟滞
+static void mains_set_nominal(uint16_t nominal_cv, uint8_t nominal_hz) {
+    mains_current.nominal_cv = nominal_cv;
+    mains_current.nominal_hz = nominal_hz;
+    mains_peak = mains_gain_q16 > 0 ? (uint32_t)((uint64_t)nominal_cv * MAINS_SQRT2_Q16 / (uint32_t)mains_gain_q16) : 0;
+    mains_hyst = mains_peak ? (int32_t)(mains_peak / 8) : MAINS_HYST_DEFAULT;
+}
+
+void ups_mains_init(const ups_mains_config_t* config) {
+    mains_config = *config;
+    memset(&mains_current, 0, sizeof(mains_current));
+    ups_seqbuf_init(&mains_published, mains_bank, sizeof(mains_bank[0]));
+    if (mains_hz) {
+        ups_mains_set_input(mains_hz, mains_gain_q16);
+    }
+}
+
+void ups_mains_set_input(uint32_t sample_hz, int32_t cv_per_count_q16) {
+    mains_hz = sample_hz;
+    mains_gain_q16 = cv_per_count_q16;
+    mains_confirm = sample_hz * MAINS_CONFIRM_MS / 1000;
+    if (mains_confirm < 2) {
+        mains_confirm = 2;
+    }
+    mains_min_half_q8 = sample_hz * 128 / MAINS_HZ_UPPER;     // 最高频率对应最短半周期
+    mains_max_half_q8 = sample_hz * 128 / MAINS_HZ_LOWER;     // 最低频率对应最长半周期
+    mains_set_ref(sample_hz * 128 / (mains_config.nominal_hz ? mains_config.nominal_hz : 50));
+    mains_prev_half_q8 = mains_ref_half_q8;
+    mains_samples = 0;
+
+    mains_current.state = UPS_MAINS_UNKNOWN;
+    mains_current.frequency_ok = false;
+    mains_current.rms_cv = 0;
+    mains_current.frequency_chz = 0;
+    mains_peak = 0;
+    mains_hyst = MAINS_HYST_DEFAULT;
+    if (mains_config.nominal_cv && mains_config.nominal_hz) {
+        mains_set_nominal(mains_config.nominal_cv, mains_config.nominal_hz);
+    }
+    mains_reset_tracking();
+}
+
+static int mains_severity(ups_mains_state_t state) {
+    switch (state) {
+        case UPS_MAINS_OUTAGE:   return 2;
+        case UPS_MAINS_BROWNOUT:
+        case UPS_MAINS_SURGE:    return 1;
+        default:                 return 0;
+    }
+}
+
+static void mains_enter(ups_mains_state_t state) {
+    if (state == mains_current.state) {
+        return;
+    }
+    mains_current.state = state;
+    mains_current.events++;
+    mains_current.event_sample = mains_samples;
+    mains_settle = state;
+    mains_settle_count = 0;
+}
+
+// 异常立即生效（更严重，或同级别的另一种异常）；恢复/降级由半周结算处理
+static void mains_escalate(ups_mains_state_t state) {
+    ups_mains_state_t current = mains_current.state;
+    if (current == UPS_MAINS_UNKNOWN) {
+        if (state == UPS_MAINS_OUTAGE) {
+            mains_enter(state);
+        }
+        return;
+    }
+    if (mains_severity(state) > mains_severity(current) ||
+        (mains_severity(state) == mains_severity(current) && state != current && state != UPS_MAINS_NORMAL)) {
+        mains_enter(state);
+    }
+}
+
+static ups_mains_state_t mains_classify(uint32_t rms_cv) {
+    uint32_t nominal = mains_current.nominal_cv;
+    if (rms_cv * 100 < nominal * mains_config.outage_pct) {
+        return UPS_MAINS_OUTAGE;
+    }
+    if (rms_cv * 100 < nominal * mains_config.brownout_pct) {
+        return UPS_MAINS_BROWNOUT;
+    }
+    if (rms_cv * 100 > nominal * mains_config.surge_pct) {
+        return UPS_MAINS_SURGE;
+    }
+    return UPS_MAINS_NORMAL;
+}
+
+// 锁定时按实测值选择标称电压和频率
+static void mains_lock(uint32_t rms_cv) {
+    uint16_t nominal_cv = mains_config.nominal_cv;
+    uint8_t nominal_hz = mains_config.nominal_hz;
+
+    if (nominal_hz == 0) {
+        nominal_hz = mains_current.frequency_chz < 5500 ? 50 : 60;
+    }
+    if (nominal_cv == 0) {
+        uint32_t best = UINT32_MAX;
+        for (uint32_t i = 0; i < sizeof(mains_nominal_cv) / sizeof(mains_nominal_cv[0]); i++) {
+            uint32_t diff = rms_cv > mains_nominal_cv[i] ? rms_cv - mains_nominal_cv[i] : mains_nominal_cv[i] - rms_cv;
+            if (diff < best) {
+                best = diff;
+                nominal_cv = mains_nominal_cv[i];
+            }
+        }
+    }
+    mains_set_nominal(nominal_cv, nominal_hz);
+}
+
+// 一个半周结束（过零点确认）：结算有效值和频率，处理锁定、恢复和降级
+static void mains_half_cycle(uint32_t half_q8) {
+    uint32_t rms = ups_dsp_isqrt(mains_sum / (mains_count ? mains_count : 1));
+    uint32_t rms_cv = (uint32_t)(((uint64_t)rms * (uint32_t)mains_gain_q16) >> 16);
+    mains_current.rms_cv = rms_cv > 65535 ? 65535 : (uint16_t)rms_cv;
+
+    if (half_q8 < mains_min_half_q8 || half_q8 > mains_max_half_q8) {
+        mains_settle_count = 0;
+        return;
+    }
+
+    // 两个半周合成一个整周，抵消检测信号的直流不对称
+    uint32_t full_q8 = mains_prev_half_q8 + half_q8;
+    mains_prev_half_q8 = half_q8;
+    mains_set_ref(half_q8);
+    mains_current.frequency_chz = (uint16_t)((uint64_t)mains_hz * 25600 / full_q8);
+    if (mains_current.nominal_hz) {
+        uint32_t nominal_chz = mains_current.nominal_hz * 100u;
+        uint32_t diff = mains_current.frequency_chz > nominal_chz ? mains_current.frequency_chz - nominal_chz
+                                                                  : nominal_chz - mains_current.frequency_chz;
+        mains_current.frequency_ok = diff * 100 <= nominal_chz * mains_config.frequency_tol_pct;
+    }
+
+    // 未锁定（上电，或上电即停电）：连续若干个有效半周后确定标称值
+    if (mains_current.state == UPS_MAINS_UNKNOWN || mains_peak == 0) {
+        if (++mains_settle_count >= mains_config.recover_half_cycles) {
+            if (mains_peak == 0) {
+                mains_lock(rms_cv);
+            }
+            mains_enter(mains_classify(rms_cv));
+        }
+        return;
+    }
+
+    ups_mains_state_t state = mains_classify(rms_cv);
+    if (state == mains_settle) {
+        mains_settle_count++;
+    } else {
+        mains_settle = state;
+        mains_settle_count = 1;
+    }
+    if (state != mains_current.state) {
+        if (mains_severity(state) > mains_severity(mains_current.state)) {
+            mains_enter(state);
+        } else if (mains_settle_count >= mains_config.recover_half_cycles) {
+            mains_enter(state);
+        }
+    }
+}
+
+// 按相位推算的标称包络（Q15 计数）
+static uint32_t mains_envelope(uint32_t pos_q8) {
+    uint32_t phase = ((pos_q8 * mains_step_q16) >> 8) & 0xFFFF;
+    uint32_t index = phase >> 9;
+    if (index > 64) {
+        index = 128 - index;
+    }
+    return (uint32_t)mains_sine[index];
+}
+
+void ups_mains_process(const int16_t* samples, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++, mains_samples++) {
+        int32_t x = samples[i];
+        uint32_t a = (uint32_t)(x < 0 ? -x : x);
+
+        mains_pos_q8 += 256;
+        mains_sum += (uint32_t)(x * x);
+        mains_count++;
+
+        // 过零：符号变化处线性插值出候选点，幅值越过迟滞后确认
+        if (mains_polarity == 0) {
+            if (a > (uint32_t)mains_hyst) {
+                mains_polarity = x > 0 ? 1 : -1;
+                mains_pos_q8 = 0;
+                mains_sum = 0;
+                mains_count = 0;
+            }
+        } else {
+            if ((x ^ mains_prev) < 0 || (x == 0 && mains_prev != 0)) {
+                int32_t p = mains_prev < 0 ? -mains_prev : mains_prev;
+                mains_cross_q8 = mains_pos_q8 - 256 + (uint32_t)(p * 256 / (p + (int32_t)a));
+            }
+            if (mains_cross_q8 && a > (uint32_t)mains_hyst && (x > 0 ? 1 : -1) != mains_polarity) {
+                uint32_t half_q8 = mains_cross_q8;
+                mains_polarity = (int8_t)-mains_polarity;
+                mains_cross_q8 = 0;
+                mains_half_cycle(half_q8);
+                mains_pos_q8 -= half_q8;
+                mains_sum = (uint32_t)(x * x);
+                mains_count = 1;
+            } else if (mains_cross_q8 && (x > 0 ? 1 : -1) == mains_polarity && a > (uint32_t)mains_hyst) {
+                mains_cross_q8 = 0;
+            }
+        }
+        mains_prev = (int16_t)x;
+
+        // 超过最长半周仍未过零：停电（或严重畸变），重新寻找过零
+        if (mains_pos_q8 > mains_max_half_q8) {
+            mains_half_cycle(mains_pos_q8);
+            mains_escalate(UPS_MAINS_OUTAGE);
+            mains_reset_tracking();
+            continue;
+        }
+
+        // 包络比较：只在锁定后、相位区间中段进行
+        if (mains_peak == 0 || mains_polarity == 0 || mains_current.state == UPS_MAINS_UNKNOWN) {
+            continue;
+        }
+        uint32_t sine = mains_envelope(mains_pos_q8);
+        if (sine < MAINS_ENVELOPE_MIN) {
+            continue;
+        }
+        uint32_t expected = (mains_peak * sine) >> 15;
+        uint32_t level = a * 100;
+        mains_outage = level < expected * mains_config.outage_pct ? mains_outage + 1 : 0;
+        mains_sag = level < expected * mains_config.brownout_pct ? mains_sag + 1 : 0;
+        mains_swell = level > expected * mains_config.surge_pct ? mains_swell + 1 : 0;
+        if (mains_outage >= mains_confirm) {
+            mains_escalate(UPS_MAINS_OUTAGE);
+        } else if (mains_sag >= mains_confirm) {
+            mains_escalate(UPS_MAINS_BROWNOUT);
+        } else if (mains_swell >= mains_confirm) {
+            mains_escalate(UPS_MAINS_SURGE);
+        }
+    }
+
+    ups_seqbuf_publish(&mains_published, &mains_current);
+}
+
+bool ups_mains_latest(ups_mains_status_t* status) {
+    return ups_seqbuf_read(&mains_published, status) != 0;
+}
+
+uint32_t ups_mains_sample_count(void) {
+    return mains_samples;
+}
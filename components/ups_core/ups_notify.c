@@ -0,0 +1,124 @@
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_notify.h"
+
+// 通过中断端点 0x81 主动推送的Input报告，数组顺序即发送优先级
+static const uint8_t notify_report_ids[] = {
+    HID_PD_PRESENTSTATUS,
+    HID_PD_REMAININGCAPACITY,
+    HID_PD_RUNTIMETOEMPTY,
+    HID_PD_AVERAGETIME2EMPTY,
+    HID_PD_VOLTAGE,
+};
+
+#define NOTIFY_SLOT_COUNT (sizeof(notify_report_ids) / sizeof(notify_report_ids[0]))
+
+// 位号 = 优先级 * 实例数 + 实例号：所有实例的 PresentStatus 排在任何数值报告之前
+#define NOTIFY_BIT_COUNT  (NOTIFY_SLOT_COUNT * UPS_INSTANCE_COUNT)
+
+_Static_assert(NOTIFY_BIT_COUNT <= 32, "notify pending bitmap");
+
+// 待发送位图：每个实例的每个报告ID最多占一位，重复变化自动合并。
+// 发送时读取最新发布的值（后写覆盖），不保存中间值
+static atomic_uint notify_pending = 0;
+static atomic_bool notify_busy = false;     // 端点上有未完成的传输
+static atomic_uint notify_inflight = 0;     // 未完成传输的报告ID
+
+// 上次检测到的值，用于变化检测（仅写者任务访问）
+static uint8_t last_sent[NOTIFY_BIT_COUNT][UPS_REPORT_MAX_LEN];
+static bool last_valid = false;
+
+// 端点空闲时按优先级发送一个待发报告，写者任务与TinyUSB任务都可能调用
+static void notify_send_next(void) {
+    for (;;) {
+        bool expected = false;
+        if (!atomic_compare_exchange_strong(&notify_busy, &expected, true)) {
+            return;
+        }
+
+        unsigned pending = atomic_load(&notify_pending);
+        if (pending != 0 && ups_port_hid_ready()) {
+            unsigned bit = __builtin_ctz(pending);
+            uint8_t report_id = UPS_INSTANCE_REPORT_ID(bit % UPS_INSTANCE_COUNT,
+                                                       notify_report_ids[bit / UPS_INSTANCE_COUNT]);
+            uint8_t data[UPS_REPORT_MAX_LEN];
+
+            // 先清位再读值：发送期间的新变化会重新置位
+            atomic_fetch_and(&notify_pending, ~(1u << bit));
+            uint16_t len = ups_report_get(report_id, data, sizeof(data));
+            atomic_store(&notify_inflight, report_id);
+            if (len > 0 && ups_port_hid_send(report_id, data, len)) {
+                return;     // 由 ups_notify_report_complete 释放 busy
+            }
+            if (len > 0) {
+                // 发送失败时保留该位，留给下一次完成/flush/check 重试，
+                // 不在这里循环：设备栈可能一直报告端点空闲却拒绝发送
+                atomic_fetch_or(&notify_pending, 1u << bit);
+                atomic_store(&notify_busy, false);
+                return;
+            }
+        }
+        atomic_store(&notify_busy, false);
+
+        // 释放 busy 期间可能有新报告置位
+        if (atomic_load(&notify_pending) == 0 || !ups_port_hid_ready()) {
+            return;
+        }
+    }
+}
+
+void ups_notify_init(void) {
+    atomic_store(&notify_pending, 0);
+    atomic_store(&notify_busy, false);
+}
+
+void ups_notify_reset(void) {
+    atomic_store(&notify_pending, 0);
+    atomic_store(&notify_busy, false);
+}
+
+void ups_notify_resync(void) {
+    atomic_fetch_or(&notify_pending, (unsigned)((1ull << NOTIFY_BIT_COUNT) - 1));
+    notify_send_next();
+}
+
+void ups_notify_check(void) {
+    unsigned changed = 0;
+
+    for (size_t i = 0; i < NOTIFY_BIT_COUNT; i++) {
+        uint8_t data[UPS_REPORT_MAX_LEN];
+        uint8_t report_id = UPS_INSTANCE_REPORT_ID(i % UPS_INSTANCE_COUNT, notify_report_ids[i / UPS_INSTANCE_COUNT]);
+        uint16_t len = ups_report_get(report_id, data, sizeof(data));
+        if (len == 0) {
+            continue;
+        }
+        if (last_valid && memcmp(last_sent[i], data, len) == 0) {
+            continue;
+        }
+        memcpy(last_sent[i], data, len);
+        changed |= 1u << i;
+    }
+    last_valid = true;
+
+    // 未枚举时只记录基线，枚举后主机会主动读取Feature报告
+    if (changed == 0 || !ups_port_hid_mounted()) {
+        return;
+    }
+    atomic_fetch_or(&notify_pending, changed);
+
+    notify_send_next();
+}
+
+uint8_t ups_notify_report_complete(void) {
+    uint8_t report_id = (uint8_t)atomic_load(&notify_inflight);
+    atomic_store(&notify_busy, false);
+    notify_send_next();
+    return report_id;
+}
+
+void ups_notify_flush(void) {
+    notify_send_next();
+}
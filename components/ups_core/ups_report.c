@@ -0,0 +1,218 @@
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "ups_report.h"
+#include "ups_report_schema.h"
+
+#define UPS_REPORT_IMAGE_SIZE sizeof(ups_report_image_t)
+
+// 按报告ID直接索引的报告表，由结构表生成
+#define UPS_SCHEMA_ENTRY_STR(id, page, usage, str, feat) \
+    [id] = { .len = 1, .offset = offsetof(ups_report_image_t, r_##id) },
+#define UPS_SCHEMA_ENTRY_FEAT(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    [id] = { .len = (bits) / 8, .offset = offsetof(ups_report_image_t, r_##id) },
+#define UPS_SCHEMA_ENTRY_INFEAT(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    [id] = { .len = (bits) / 8, .offset = offsetof(ups_report_image_t, r_##id) },
+
+static const ups_report_entry_t report_table[UPS_REPORT_ID_MAX + 1] = {
+    [HID_PD_PRESENTSTATUS] = {
+        .len = UPS_PRESENT_STATUS_LEN,
+        .offset = offsetof(ups_report_image_t, r_HID_PD_PRESENTSTATUS),
+    },
+    UPS_REPORT_SCHEMA(UPS_SCHEMA_ENTRY_STR, UPS_SCHEMA_ENTRY_FEAT, UPS_SCHEMA_ENTRY_INFEAT)
+};
+
+// 所有报告负载都必须放得进 UPS_REPORT_MAX_LEN
+#define UPS_SCHEMA_CHECK_LEN(id, bits) \
+    _Static_assert((bits) % 8 == 0 && (bits) / 8 <= UPS_REPORT_MAX_LEN, "report " #id " size");
+#define UPS_SCHEMA_CHECK_FEAT(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    UPS_SCHEMA_CHECK_LEN(id, bits)
+#define UPS_SCHEMA_CHECK_INFEAT(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    UPS_SCHEMA_CHECK_LEN(id, bits)
+#define UPS_SCHEMA_CHECK_STR(id, page, usage, str, feat)
+UPS_REPORT_SCHEMA(UPS_SCHEMA_CHECK_STR, UPS_SCHEMA_CHECK_FEAT, UPS_SCHEMA_CHECK_INFEAT)
+_Static_assert(UPS_PRESENT_STATUS_LEN <= UPS_REPORT_MAX_LEN, "PresentStatus size");
+
+// 请求时编码器（按单实例ID，所有实例共用）
+static ups_report_encoder_t report_encoders[UPS_REPORT_ID_MAX + 1];
+
+// 写者私有暂存区，每个实例一份
+static uint8_t report_staging[UPS_INSTANCE_COUNT][UPS_REPORT_IMAGE_SIZE];
+
+// 已发布的双缓冲快照：读者读取 report_bank[seq & 1]，
+// 写者总是先切换序列号再改写另一份，读者不会看到写了一半的数据
+static uint8_t report_bank[2][UPS_INSTANCE_COUNT][UPS_REPORT_IMAGE_SIZE];
+static atomic_uint report_seq = 0;
+
+// 报告描述符，第一次调用 ups_report_descriptor() 时生成（ups_report_init 中，早于 USB 安装）
+static uint8_t report_descriptor[UPS_HID_REPORT_DESCRIPTOR_LEN];
+static uint16_t report_descriptor_len;
+
+static uint8_t* desc_bytes(uint8_t* p, const uint8_t* bytes, size_t len) {
+    memcpy(p, bytes, len);
+    return p + len;
+}
+
+// 短条目：size 为 1/2/4 字节，前缀低两位为 1/2/3
+static uint8_t* desc_item(uint8_t* p, uint8_t tag, uint32_t value, uint8_t size) {
+    *p++ = tag | (size == 4 ? 3 : size);
+    for (uint8_t i = 0; i < size; i++) {
+        *p++ = (value >> (8 * i)) & 0xFF;
+    }
+    return p;
+}
+
+static uint8_t* desc_globals(uint8_t* p, uint8_t id, uint8_t page, uint8_t bits,
+                             int32_t lmin, int32_t lmax, uint32_t unit, uint8_t exp) {
+    const uint8_t head[] = {
+        0x05, page,                 // USAGE_PAGE
+        0x85, id,                   // REPORT_ID
+        0x75, bits,                 // REPORT_SIZE
+        0x95, 0x01,                 // REPORT_COUNT (1)
+    };
+    p = desc_bytes(p, head, sizeof(head));
+    p = desc_item(p, 0x14, (uint32_t)lmin, HID_SDATA_LEN(lmin));    // LOGICAL_MINIMUM
+    p = desc_item(p, 0x24, (uint32_t)lmax, HID_SDATA_LEN(lmax));    // LOGICAL_MAXIMUM
+    p = desc_item(p, 0x64, unit, HID_UDATA_LEN(unit));              // UNIT
+    *p++ = 0x55;                                                    // UNIT_EXPONENT
+    *p++ = exp;
+    return p;
+}
+
+#define UPS_DESC_STR(id, page, usage, str, feat) \
+    p = desc_globals(p, UPS_INSTANCE_REPORT_ID(n, id), page, 8, 0, 255, HID_UNIT_NONE, 0x00); \
+    p = desc_bytes(p, (const uint8_t[]){ 0x09, (usage), 0x79, (str), 0xB1, (feat) }, 6);
+#define UPS_DESC_FEAT(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    p = desc_globals(p, UPS_INSTANCE_REPORT_ID(n, id), page, bits, lmin, lmax, unit, exp); \
+    p = desc_bytes(p, (const uint8_t[]){ 0x09, (usage), 0xB1, (feat) }, 4);
+#define UPS_DESC_INFEAT(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    p = desc_globals(p, UPS_INSTANCE_REPORT_ID(n, id), page, bits, lmin, lmax, unit, exp); \
+    p = desc_bytes(p, (const uint8_t[]){ 0x09, (usage), 0x81, (in), 0x09, (usage), 0xB1, (feat) }, 8);
+#define UPS_DESC_BIT(page, usage, in, feat) \
+    0x05, (page), 0x09, (usage), 0x81, (in), 0x09, (usage), 0xB1, (feat),
+
+// 每个实例一个应用集合，各实例只有报告ID不同
+static void report_build_descriptor(void) {
+    static const uint8_t head[] = { UPS_DESC_INSTANCE_HEAD };
+    static const uint8_t status_head[] = { UPS_DESC_STATUS_HEAD };
+    static const uint8_t status_bits[] = {
+        UPS_DESC_STATUS_GLOBALS
+        UPS_PRESENT_STATUS_SCHEMA(UPS_DESC_BIT)
+        UPS_DESC_INSTANCE_TAIL
+    };
+    uint8_t* p = report_descriptor;
+
+    for (uint8_t n = 0; n < UPS_INSTANCE_COUNT; n++) {
+        p = desc_bytes(p, head, sizeof(head));
+        UPS_REPORT_SCHEMA(UPS_DESC_STR, UPS_DESC_FEAT, UPS_DESC_INFEAT)
+        p = desc_bytes(p, status_head, sizeof(status_head));
+        *p++ = UPS_INSTANCE_REPORT_ID(n, HID_PD_PRESENTSTATUS);
+        p = desc_bytes(p, status_bits, sizeof(status_bits));
+    }
+    report_descriptor_len = (uint16_t)(p - report_descriptor);
+}
+
+const uint8_t* ups_report_descriptor(uint16_t* len) {
+    if (report_descriptor_len == 0) {
+        report_build_descriptor();
+    }
+    if (len != NULL) {
+        *len = report_descriptor_len;
+    }
+    return report_descriptor;
+}
+
+// 带实例号的报告ID -> 表项，实例号或ID超出范围、描述符中没有该报告时返回 NULL
+static const ups_report_entry_t* report_lookup(uint8_t report_id, uint8_t* instance)
+{
+    uint8_t id = UPS_REPORT_LOCAL_ID(report_id);
+
+    *instance = UPS_REPORT_INSTANCE(report_id);
+    if (*instance >= UPS_INSTANCE_COUNT || id > UPS_REPORT_ID_MAX || report_table[id].len == 0) {
+        return NULL;
+    }
+    return &report_table[id];
+}
+
+void ups_report_init(void)
+{
+#define UPS_SCHEMA_INIT_STR(id, page, usage, str, feat) \
+    ups_report_set(UPS_INSTANCE_REPORT_ID(instance, id), str);
+#define UPS_SCHEMA_INIT_FEAT(id, page, usage, bits, lmin, lmax, unit, exp, feat, def) \
+    ups_report_set(UPS_INSTANCE_REPORT_ID(instance, id), def);
+#define UPS_SCHEMA_INIT_INFEAT(id, page, usage, bits, lmin, lmax, unit, exp, in, feat, def) \
+    ups_report_set(UPS_INSTANCE_REPORT_ID(instance, id), def);
+    for (uint8_t instance = 0; instance < UPS_INSTANCE_COUNT; instance++) {
+        UPS_REPORT_SCHEMA(UPS_SCHEMA_INIT_STR, UPS_SCHEMA_INIT_FEAT, UPS_SCHEMA_INIT_INFEAT)
+    }
+
+    ups_report_publish();
+    ups_report_descriptor(NULL);
+}
+
+void ups_report_set_encoder(uint8_t report_id, ups_report_encoder_t encode)
+{
+    if (report_id <= UPS_REPORT_ID_MAX && report_table[report_id].len != 0) {
+        report_encoders[report_id] = encode;
+    }
+}
+
+void ups_report_set(uint8_t report_id, uint32_t value)
+{
+    uint8_t instance;
+    const ups_report_entry_t* entry = report_lookup(report_id, &instance);
+    if (entry == NULL) {
+        return;
+    }
+
+    uint8_t* data = &report_staging[instance][entry->offset];
+    for (uint8_t i = 0; i < entry->len; i++) {
+        data[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+void ups_report_publish(void)
+{
+    unsigned seq = atomic_load_explicit(&report_seq, memory_order_relaxed);
+
+    // 读者切到 bank[1]，改写 bank[0]
+    atomic_store_explicit(&report_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(report_bank[0], report_staging, sizeof(report_staging));
+
+    // 读者切回 bank[0]，改写 bank[1]
+    atomic_store_explicit(&report_seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(report_bank[1], report_staging, sizeof(report_staging));
+}
+
+uint8_t ups_report_len(uint8_t report_id)
+{
+    uint8_t instance;
+    const ups_report_entry_t* entry = report_lookup(report_id, &instance);
+    return entry == NULL ? 0 : entry->len;
+}
+
+uint16_t ups_report_get(uint8_t report_id, uint8_t* buffer, uint16_t reqlen)
+{
+    uint8_t instance;
+    const ups_report_entry_t* entry = report_lookup(report_id, &instance);
+    if (entry == NULL || reqlen < entry->len) {
+        return 0;
+    }
+
+    ups_report_encoder_t encode = report_encoders[UPS_REPORT_LOCAL_ID(report_id)];
+    if (encode) {
+        return encode(report_id, buffer, reqlen);
+    }
+
+    // 读取期间若有新的发布则重试，不加锁
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&report_seq, memory_order_acquire);
+        memcpy(buffer, &report_bank[seq & 1][instance][entry->offset], entry->len);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&report_seq, memory_order_relaxed) != seq);
+
+    return entry->len;
+}
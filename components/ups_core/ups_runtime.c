@@ -0,0 +1,150 @@
+#include <math.h>
+#include <string.h>
+#include "ups_instance.h"
+#include "ups_battery.h"
+#include "ups_runtime.h"
+
+// 平滑电流为 Q16（mA），系数取 2^-shift：时间常数 ≈ 2^shift / 采样频率
+#define EMA_FRAC_BITS 16
+#define EMA_MAX_SHIFT 20
+
+// 折算表的倒数（Q12，≥4096）：以该倍率放电时每 mA 相当于额定倍率下的 mA 数
+static uint16_t penalty_table[UPS_RUNTIME_DERATE_POINTS];
+static uint32_t rated_inverse;              // 2^24 / 额定电流，采样路径用乘法代替除法
+static uint8_t fast_shift;
+static uint8_t slow_shift;
+
+// 负载电流与折算到额定倍率的等效电流各做两级平滑（约2分钟/约10分钟），
+// 等效电流先逐个采样查表再平均，突发负载也不会因先平均再查表而高估。
+// 另外累计本次放电以来的负载和等效电流，已放出的电量按二者之比折算到额定倍率。
+// 折算表和时间常数所有实例共用，每个实例只有自己的平滑值和累计值
+typedef struct {
+    int64_t load_fast;
+    int64_t load_slow;
+    int64_t equiv_fast;
+    int64_t equiv_slow;
+    uint64_t drawn_load;                // 上次充满以来的采样累计（mA·采样周期）
+    uint64_t drawn_equiv;
+} runtime_state_t;
+
+static runtime_state_t runtimes[UPS_INSTANCE_COUNT];
+
+// 时间常数换算为（对数意义上）最接近的2的幂次采样数
+static uint8_t runtime_tau_to_shift(uint32_t tau_ms) {
+    uint32_t samples = (uint32_t)((uint64_t)tau_ms * UPS_BATTERY_SAMPLE_HZ / 1000);
+    if (samples <= 1) {
+        return 0;
+    }
+    uint8_t shift = (uint8_t)(31 - __builtin_clz(samples));
+    if ((uint64_t)samples * samples > (uint64_t)2 << (2 * shift)) {
+        shift++;
+    }
+    return shift > EMA_MAX_SHIFT ? EMA_MAX_SHIFT : shift;
+}
+
+void ups_runtime_init(const ups_runtime_config_t* config) {
+    uint16_t derate[UPS_RUNTIME_DERATE_POINTS];
+    uint32_t rated = config->rated_current_ma > 0 ? config->rated_current_ma : 1;
+
+    rated_inverse = (1u << 24) / rated;
+    fast_shift = runtime_tau_to_shift(config->tau_fast_ms);
+    slow_shift = runtime_tau_to_shift(config->tau_slow_ms);
+
+    if (config->derate_table != NULL) {
+        memcpy(derate, config->derate_table, sizeof(derate));
+    } else {
+        // Peukert：以 n 倍额定电流放电时可用容量为 n^-(k-1)，低于额定电流不加成
+        float exponent = (config->peukert_x100 - 100) / 100.0f;
+        for (int i = 0; i < UPS_RUNTIME_DERATE_POINTS; i++) {
+            float ratio = i * 0.5f;
+            derate[i] = ratio <= 1.0f ? UPS_RUNTIME_Q12
+                                      : (uint16_t)(UPS_RUNTIME_Q12 * powf(ratio, -exponent) + 0.5f);
+        }
+    }
+    for (int i = 0; i < UPS_RUNTIME_DERATE_POINTS; i++) {
+        uint32_t d = derate[i] > 0 ? derate[i] : 1;
+        uint32_t penalty = (UPS_RUNTIME_Q12 * UPS_RUNTIME_Q12 + d / 2) / d;
+        penalty_table[i] = penalty > 0xFFFF ? 0xFFFF : (uint16_t)penalty;
+    }
+
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        runtime_state_t* r = &runtimes[i];
+        r->load_fast = (int64_t)config->initial_load_ma << EMA_FRAC_BITS;
+        r->load_slow = r->load_fast;
+        r->equiv_fast = (int64_t)ups_runtime_equivalent_ma(config->initial_load_ma) << EMA_FRAC_BITS;
+        r->equiv_slow = r->equiv_fast;
+        r->drawn_load = 0;
+        r->drawn_equiv = 0;
+    }
+}
+
+uint32_t ups_runtime_equivalent_ma(uint32_t load_ma) {
+    // 以半倍额定电流为单位的倍率（Q9），整数部分为下标，低9位为插值系数
+    uint32_t ratio_q9 = (uint32_t)(((uint64_t)load_ma * rated_inverse) >> 14);
+    uint32_t index = ratio_q9 >> 9;
+    uint32_t penalty;
+
+    if (index >= UPS_RUNTIME_DERATE_POINTS - 1) {
+        penalty = penalty_table[UPS_RUNTIME_DERATE_POINTS - 1];
+    } else {
+        int32_t lo = penalty_table[index];
+        int32_t hi = penalty_table[index + 1];
+        penalty = (uint32_t)(lo + (((hi - lo) * (int32_t)(ratio_q9 & 0x1FF)) >> 9));
+    }
+    return (uint32_t)(((uint64_t)load_ma * penalty) >> 12);
+}
+
+void ups_runtime_sample(uint8_t instance, uint32_t load_ma) {
+    runtime_state_t* r = &runtimes[instance];
+    int64_t x = (int64_t)load_ma << EMA_FRAC_BITS;
+    uint32_t equiv = ups_runtime_equivalent_ma(load_ma);
+    int64_t e = (int64_t)equiv << EMA_FRAC_BITS;
+
+    r->load_fast += (x - r->load_fast) >> fast_shift;
+    r->load_slow += (x - r->load_slow) >> slow_shift;
+    r->equiv_fast += (e - r->equiv_fast) >> fast_shift;
+    r->equiv_slow += (e - r->equiv_slow) >> slow_shift;
+    r->drawn_load += load_ma;
+    r->drawn_equiv += equiv;
+}
+
+uint32_t ups_runtime_load_ma(uint8_t instance) {
+    return (uint32_t)(runtimes[instance].load_fast >> EMA_FRAC_BITS);
+}
+
+// 充满容量按额定倍率计。已放出的电量（充满容量 - 剩余电量）按本次放电的负载组合折算为额定倍率下的电量，
+// 剩下的额定倍率电量按平滑后的等效电流放完所需的时间即运行时间
+static uint16_t runtime_seconds(uint32_t remaining_mah, uint32_t full_charge_mah, uint32_t drawn_q12, int64_t equiv) {
+    if (equiv <= 0) {
+        return 65535;
+    }
+    uint32_t used_mah = full_charge_mah > remaining_mah ? full_charge_mah - remaining_mah : 0;
+    int64_t available = (int64_t)full_charge_mah * UPS_RUNTIME_Q12 - (int64_t)used_mah * drawn_q12;
+    if (available <= 0) {
+        return 0;
+    }
+    // available 为 mAh·Q12，equiv 为 mA·Q16
+    uint64_t seconds = ((uint64_t)available * 3600 << (EMA_FRAC_BITS - 12)) / (uint64_t)equiv;
+    return seconds > 65535 ? 65535 : (uint16_t)seconds;
+}
+
+void ups_runtime_estimate(uint8_t instance, uint32_t remaining_mah, uint32_t full_charge_mah,
+                          uint16_t* runtime_to_empty, uint16_t* avg_time_to_empty) {
+    runtime_state_t* r = &runtimes[instance];
+    uint32_t drawn_q12;
+
+    // 充满时重新开始累计；还没有放电记录时按当前平滑值的折算比例
+    if (remaining_mah >= full_charge_mah) {
+        r->drawn_load = 0;
+        r->drawn_equiv = 0;
+    }
+    if (r->drawn_load > 0) {
+        drawn_q12 = (uint32_t)(r->drawn_equiv * UPS_RUNTIME_Q12 / r->drawn_load);
+    } else if (r->load_slow > 0) {
+        drawn_q12 = (uint32_t)(r->equiv_slow * UPS_RUNTIME_Q12 / r->load_slow);
+    } else {
+        drawn_q12 = UPS_RUNTIME_Q12;
+    }
+    *runtime_to_empty = runtime_seconds(remaining_mah, full_charge_mah, drawn_q12, r->equiv_fast);
+    *avg_time_to_empty = runtime_seconds(remaining_mah, full_charge_mah, drawn_q12, r->equiv_slow);
+}
@@ -0,0 +1,148 @@
+#include <string.h>
+#include "ups_dsp.h"
+#include "ups_seqbuf.h"
+#include "ups_mains.h"
+#include "ups_sense.h"
+
+#define SENSE_SLOT_NONE 0xFF
+
+// 直流通道：FIR 抽取8倍后再经 5Hz 二阶低通，滤掉市电及其倍频纹波
+#define SENSE_DECIM       8
+#define SENSE_LOWPASS_HZ  5
+// 市电通道：10Hz 二阶高通去掉直流偏置，有效值按 100ms 窗口（50/60Hz 均为整周期）累计
+#define SENSE_AC_HIGHPASS_HZ 10
+#define SENSE_AC_WINDOW_DIV  10
+
+// 抽取器抗混叠低通：32抽头 Hamming 窗，截止频率为采样率的 1/20，直流增益 1
+static const int16_t sense_fir_coeffs[32] = {
+    -54, -64, -82, -97, -93, -47, 66, 266, 562, 951, 1411, 1909, 2396, 2821, 3136, 3302,
+    3302, 3136, 2821, 2396, 1909, 1411, 951, 562, 266, 66, -47, -93, -97, -82, -64, -54,
+};
+
+// ADC 通道号 -> 信号下标
+static uint8_t sense_slot[16];
+static ups_sense_config_t sense_config;
+
+// 消费任务私有：滤波器状态、分通道样本和最近一次换算的结果
+static ups_dsp_fir_t sense_fir[UPS_SENSE_CHANNELS];
+static ups_dsp_biquad_t sense_filter[UPS_SENSE_CHANNELS];
+static int16_t sense_samples[UPS_SENSE_CHANNELS][UPS_SENSE_MAX_BLOCK_SAMPLES];
+static int16_t sense_decimated[UPS_SENSE_MAX_BLOCK_SAMPLES / SENSE_DECIM + 1];
+static ups_sense_reading_t sense_current;
+static uint64_t sense_ac_sum;
+static uint32_t sense_ac_count;
+static uint8_t sense_primed;            // 已用首个样本初始化滤波器的通道（位图）
+
+// 已发布的结果，消费任务是唯一的写者（见 ups_seqbuf.h）
+static ups_sense_reading_t sense_bank[2];
+static ups_seqbuf_t sense_published;
+
+void ups_sense_init(const ups_sense_config_t* config) {
+    sense_config = *config;
+    memset(sense_slot, SENSE_SLOT_NONE, sizeof(sense_slot));
+    for (int i = 0; i < UPS_SENSE_CHANNELS; i++) {
+        sense_slot[config->adc_channel[i] & 0x0F] = (uint8_t)i;
+        ups_dsp_fir_init(&sense_fir[i], sense_fir_coeffs, 32, SENSE_DECIM);
+        if (i == UPS_SENSE_AC) {
+            ups_dsp_biquad_highpass(&sense_filter[i], SENSE_AC_HIGHPASS_HZ, config->channel_rate_hz);
+        } else {
+            ups_dsp_biquad_lowpass(&sense_filter[i], SENSE_LOWPASS_HZ, config->channel_rate_hz / SENSE_DECIM);
+        }
+    }
+    memset(&sense_current, 0, sizeof(sense_current));
+    sense_ac_sum = 0;
+    sense_ac_count = 0;
+    sense_primed = 0;
+    ups_seqbuf_init(&sense_published, sense_bank, sizeof(sense_bank[0]));
+
+    // Q15 计数 -> 市电厘伏：检测端 mV 为 gain/16，乘变比再换成厘伏（/10）
+    ups_mains_set_input(config->channel_rate_hz,
+                        (int32_t)((int64_t)config->gain_q16[UPS_SENSE_AC] * config->ac_line_ratio / 160));
+}
+
+// 样本为 Q15：原始计数居中后左移4位，换算时先还原为原始计数的16倍
+static int32_t sense_scale(ups_sense_channel_t ch, int32_t q15) {
+    int32_t raw_x16 = q15 + 2048 * 16;
+    return (int32_t)(((int64_t)(raw_x16 - sense_config.offset_raw[ch] * 16) * sense_config.gain_q16[ch]) >> 20);
+}
+
+static void sense_publish(void) {
+    ups_seqbuf_publish(&sense_published, &sense_current);
+}
+
+// 直流通道：抽取 + 低通，取最后一个输出
+static bool sense_filter_dc(ups_sense_channel_t ch, uint32_t count, int32_t* value) {
+    uint32_t n = ups_dsp_fir_decimate(&sense_fir[ch], sense_samples[ch], sense_decimated, count);
+    if (n == 0) {
+        return false;
+    }
+    ups_dsp_biquad_process(&sense_filter[ch], sense_decimated, sense_decimated, n);
+    *value = sense_scale(ch, sense_decimated[n - 1]);
+    return true;
+}
+
+static void sense_process_chunk(const uint8_t* data, uint32_t samples) {
+    uint32_t count[UPS_SENSE_CHANNELS] = {0};
+    int32_t value;
+
+    // 逐样本只做解包和分通道，滤波按块进行
+    for (uint32_t i = 0; i < samples; i++) {
+        const uint8_t* p = &data[i * UPS_SENSE_SAMPLE_BYTES];
+        uint32_t word = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        uint8_t slot = sense_slot[(word >> 13) & 0x0F];
+        if (slot == SENSE_SLOT_NONE) {
+            continue;
+        }
+        sense_samples[slot][count[slot]++] = (int16_t)(((int32_t)(word & 0x0FFF) - 2048) * 16);
+    }
+
+    // 上电后第一块：滤波器从首个样本的稳态开始，第一次发布的结果就是准确的
+    for (int ch = 0; ch < UPS_SENSE_CHANNELS; ch++) {
+        if (count[ch] && !(sense_primed & (1u << ch))) {
+            ups_dsp_fir_prime(&sense_fir[ch], sense_samples[ch][0]);
+            ups_dsp_biquad_prime(&sense_filter[ch], sense_samples[ch][0]);
+            sense_primed |= 1u << ch;
+        }
+    }
+
+    if (count[UPS_SENSE_BATTERY_V] && sense_filter_dc(UPS_SENSE_BATTERY_V, count[UPS_SENSE_BATTERY_V], &value)) {
+        sense_current.battery_mv = value < 0 ? 0 : value > 65535 ? 65535 : (uint16_t)value;
+    }
+    if (count[UPS_SENSE_BATTERY_I] && sense_filter_dc(UPS_SENSE_BATTERY_I, count[UPS_SENSE_BATTERY_I], &value)) {
+        sense_current.battery_ma = value;
+    }
+    if (count[UPS_SENSE_LOAD_I] && sense_filter_dc(UPS_SENSE_LOAD_I, count[UPS_SENSE_LOAD_I], &value)) {
+        sense_current.load_ma = value < 0 ? 0 : (uint32_t)value;
+    }
+    if (count[UPS_SENSE_AC]) {
+        int16_t* ac = sense_samples[UPS_SENSE_AC];
+        ups_dsp_biquad_process(&sense_filter[UPS_SENSE_AC], ac, ac, count[UPS_SENSE_AC]);
+        ups_mains_process(ac, count[UPS_SENSE_AC]);
+        sense_ac_sum += ups_dsp_sum_squares(ac, count[UPS_SENSE_AC]);
+        sense_ac_count += count[UPS_SENSE_AC];
+        if (sense_ac_count >= sense_config.channel_rate_hz / SENSE_AC_WINDOW_DIV) {
+            uint32_t rms = ups_dsp_isqrt(sense_ac_sum / sense_ac_count);
+            sense_current.ac_rms_mv = (uint32_t)(((uint64_t)rms * (uint32_t)sense_config.gain_q16[UPS_SENSE_AC]) >> 20);
+            sense_ac_sum = 0;
+            sense_ac_count = 0;
+        }
+    }
+}
+
+void ups_sense_process(const uint8_t* data, uint32_t len) {
+    uint32_t samples = len / UPS_SENSE_SAMPLE_BYTES;
+
+    while (samples > 0) {
+        uint32_t chunk = samples < UPS_SENSE_MAX_BLOCK_SAMPLES ? samples : UPS_SENSE_MAX_BLOCK_SAMPLES;
+        sense_process_chunk(data, chunk);
+        data += chunk * UPS_SENSE_SAMPLE_BYTES;
+        samples -= chunk;
+    }
+
+    sense_current.blocks++;
+    sense_publish();
+}
+
+bool ups_sense_latest(ups_sense_reading_t* reading) {
+    return ups_seqbuf_read(&sense_published, reading) != 0;
+}
@@ -0,0 +1,29 @@
+#include <string.h>
+#include "ups_seqbuf.h"
+
+void ups_seqbuf_init(ups_seqbuf_t* buf, void* banks, size_t size) {
+    buf->banks = banks;
+    buf->size = size;
+    atomic_store(&buf->seq, 0);
+}
+
+unsigned ups_seqbuf_publish(ups_seqbuf_t* buf, const void* value) {
+    unsigned seq = atomic_load_explicit(&buf->seq, memory_order_relaxed) + 1;
+    memcpy((uint8_t*)buf->banks + (seq & 1) * buf->size, value, buf->size);
+    atomic_store_explicit(&buf->seq, seq, memory_order_release);
+    return seq;
+}
+
+unsigned ups_seqbuf_read(ups_seqbuf_t* buf, void* value) {
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&buf->seq, memory_order_acquire);
+        if (seq == 0) {
+            return 0;
+        }
+        memcpy(value, (const uint8_t*)buf->banks + (seq & 1) * buf->size, buf->size);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&buf->seq, memory_order_relaxed) == seq) {
+            return seq;
+        }
+    }
+}
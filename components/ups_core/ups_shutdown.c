@@ -0,0 +1,241 @@
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_event.h"
+#include "ups_shutdown.h"
+
+static const char *TAG = "SHUTDOWN";
+
+enum {
+    OUTPUT_ON = 0,
+    OUTPUT_OFF_STAY,                    // 关机：等市电断开后恢复
+    OUTPUT_OFF_REBOOT,                  // 重启：等 restore_at
+    OUTPUT_OFF_WAIT_AC,                 // 重启：关闭时间已到，等市电
+};
+
+// 每个实例一组倒计时和输出状态
+typedef struct {
+    // 截止时间（ups_port_millis），0 表示没有倒计时。USB回调写入，定时器回调到期时用 CAS 清零
+    atomic_uint shutdown_at;
+    atomic_uint reboot_at;
+
+    // 只在定时器回调中修改
+    atomic_uint output_mode;
+    uint32_t restore_at;
+    bool imminent_reported;
+
+    atomic_bool ac_outage;              // 关机后出现过市电断开
+} shutdown_instance_t;
+
+static shutdown_instance_t shutdown_instances[UPS_INSTANCE_COUNT];
+
+// 状态任务写入，所有实例共用同一路市电
+static atomic_bool ac_present;
+
+static atomic_uint change_count;
+
+static bool shutdown_due(uint32_t at, uint32_t now) {
+    return (int32_t)(now - at) >= 0;
+}
+
+// 0 保留为“没有倒计时”
+static uint32_t shutdown_deadline(uint32_t now, uint32_t ms) {
+    uint32_t at = now + ms;
+    return at != 0 ? at : 1;
+}
+
+// 剩余毫秒，没有倒计时返回 -1
+static int32_t shutdown_remaining(atomic_uint* deadline, uint32_t now) {
+    uint32_t at = atomic_load_explicit(deadline, memory_order_acquire);
+    if (at == 0) {
+        return -1;
+    }
+    int32_t left = (int32_t)(at - now);
+    return left > 0 ? left : 0;
+}
+
+// GET_REPORT：按请求时刻计算剩余秒数（向上取整），没有倒计时为 -1
+static uint16_t shutdown_encode(atomic_uint* deadline, uint8_t* buffer, uint16_t reqlen) {
+    if (reqlen < 2) {
+        return 0;
+    }
+    int32_t left = shutdown_remaining(deadline, ups_port_millis());
+    int16_t seconds = left < 0 ? -1 : (int16_t)((left + 999) / 1000);
+    buffer[0] = (uint8_t)seconds;
+    buffer[1] = (uint8_t)((uint16_t)seconds >> 8);
+    return 2;
+}
+
+// 报告ID中的实例号由 ups_report 检查过范围
+static uint16_t shutdown_encode_shutdown(uint8_t report_id, uint8_t* buffer, uint16_t reqlen) {
+    return shutdown_encode(&shutdown_instances[UPS_REPORT_INSTANCE(report_id)].shutdown_at, buffer, reqlen);
+}
+
+static uint16_t shutdown_encode_reboot(uint8_t report_id, uint8_t* buffer, uint16_t reqlen) {
+    return shutdown_encode(&shutdown_instances[UPS_REPORT_INSTANCE(report_id)].reboot_at, buffer, reqlen);
+}
+
+void ups_shutdown_init(void) {
+    atomic_store(&ac_present, true);
+    atomic_store(&change_count, 0);
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        shutdown_instance_t* inst = &shutdown_instances[i];
+        atomic_store(&inst->shutdown_at, 0);
+        atomic_store(&inst->reboot_at, 0);
+        atomic_store(&inst->output_mode, OUTPUT_ON);
+        atomic_store(&inst->ac_outage, false);
+        inst->restore_at = 0;
+        inst->imminent_reported = false;
+    }
+    ups_report_set_encoder(HID_PD_DELAYBE4SHUTDOWN, shutdown_encode_shutdown);
+    ups_report_set_encoder(HID_PD_DELAYBE4REBOOT, shutdown_encode_reboot);
+    ups_port_shutdown_timer(UINT32_MAX);
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        ups_port_output_set(i, true);
+    }
+}
+
+void ups_shutdown_set(uint8_t report_id, int16_t seconds) {
+    uint8_t instance = UPS_REPORT_INSTANCE(report_id);
+    if (instance >= UPS_INSTANCE_COUNT) {
+        return;
+    }
+    shutdown_instance_t* inst = &shutdown_instances[instance];
+    atomic_uint* deadline = UPS_REPORT_LOCAL_ID(report_id) == HID_PD_DELAYBE4REBOOT ? &inst->reboot_at
+                                                                                     : &inst->shutdown_at;
+    uint32_t at = seconds < 0 ? 0 : shutdown_deadline(ups_port_millis(), (uint32_t)seconds * 1000);
+
+    atomic_store_explicit(deadline, at, memory_order_release);
+    atomic_fetch_add_explicit(&change_count, 1, memory_order_release);
+    ups_event_post(UPS_EVENT_SHUTDOWN);
+    ups_port_shutdown_kick();
+}
+
+void ups_shutdown_ac(bool present) {
+    bool off = false;
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        if (!present) {
+            atomic_store_explicit(&shutdown_instances[i].ac_outage, true, memory_order_relaxed);
+        }
+        off |= atomic_load_explicit(&shutdown_instances[i].output_mode, memory_order_relaxed) != OUTPUT_ON;
+    }
+    if (atomic_exchange_explicit(&ac_present, present, memory_order_relaxed) != present && off) {
+        ups_port_shutdown_kick();
+    }
+}
+
+void ups_shutdown_status(uint8_t instance, bool* requested, bool* imminent) {
+    shutdown_instance_t* inst = &shutdown_instances[instance];
+    uint32_t now = ups_port_millis();
+    int32_t shutdown_left = shutdown_remaining(&inst->shutdown_at, now);
+    int32_t reboot_left = shutdown_remaining(&inst->reboot_at, now);
+    int32_t left = shutdown_left < 0 ? reboot_left
+                 : reboot_left < 0 ? shutdown_left
+                 : shutdown_left < reboot_left ? shutdown_left : reboot_left;
+
+    *requested = left >= 0;
+    *imminent = (left >= 0 && left <= UPS_SHUTDOWN_IMMINENT_MS) ||
+                atomic_load_explicit(&inst->output_mode, memory_order_relaxed) != OUTPUT_ON;
+}
+
+bool ups_shutdown_output_on(uint8_t instance) {
+    return atomic_load_explicit(&shutdown_instances[instance].output_mode, memory_order_relaxed) == OUTPUT_ON;
+}
+
+uint32_t ups_shutdown_changes(void) {
+    return atomic_load_explicit(&change_count, memory_order_acquire);
+}
+
+static void shutdown_output(uint8_t instance, unsigned mode) {
+    unsigned old = atomic_exchange_explicit(&shutdown_instances[instance].output_mode, mode, memory_order_relaxed);
+    if ((old == OUTPUT_ON) != (mode == OUTPUT_ON)) {
+        ups_port_output_set(instance, mode == OUTPUT_ON);
+        UPS_LOGI(TAG, "Output %u %s", instance, mode == OUTPUT_ON ? "on" : "off");
+    }
+}
+
+// 到期的倒计时：CAS 清零，期间主机重新写入时保留新的截止时间
+static bool shutdown_expired(atomic_uint* deadline, uint32_t now) {
+    uint32_t at = atomic_load_explicit(deadline, memory_order_acquire);
+    return at != 0 && shutdown_due(at, now) && atomic_compare_exchange_strong(deadline, &at, 0);
+}
+
+// 下一个需要醒来的时刻：倒计时进入即将关机、倒计时到期、重启后恢复输出
+static void shutdown_next(uint32_t* next, uint32_t at, uint32_t now) {
+    if (at == 0) {
+        return;
+    }
+    if ((int32_t)(at - now) <= 0) {
+        *next = 0;                      // 已到期但被新的写入抢先，立即再处理一次
+        return;
+    }
+    uint32_t left = at - now;
+    if (left > UPS_SHUTDOWN_IMMINENT_MS && left - UPS_SHUTDOWN_IMMINENT_MS < *next) {
+        *next = left - UPS_SHUTDOWN_IMMINENT_MS;
+    } else if (left <= UPS_SHUTDOWN_IMMINENT_MS && left < *next) {
+        *next = left;
+    }
+}
+
+// 处理一个实例，返回状态变化数，并把该实例下一个需要醒来的时刻合并到 next
+static uint32_t shutdown_instance_timer(uint8_t instance, uint32_t now, bool ac, uint32_t* next) {
+    shutdown_instance_t* inst = &shutdown_instances[instance];
+    uint32_t changes = 0;
+
+    if (shutdown_expired(&inst->shutdown_at, now)) {
+        atomic_store_explicit(&inst->ac_outage, !ac, memory_order_relaxed);
+        shutdown_output(instance, OUTPUT_OFF_STAY);
+        changes++;
+    }
+    if (shutdown_expired(&inst->reboot_at, now)) {
+        inst->restore_at = shutdown_deadline(now, UPS_SHUTDOWN_REBOOT_OFF_MS);
+        shutdown_output(instance, OUTPUT_OFF_REBOOT);
+        changes++;
+    }
+
+    unsigned mode = atomic_load_explicit(&inst->output_mode, memory_order_relaxed);
+    if (mode == OUTPUT_OFF_REBOOT && shutdown_due(inst->restore_at, now)) {
+        mode = ac ? OUTPUT_ON : OUTPUT_OFF_WAIT_AC;
+        shutdown_output(instance, mode);
+        changes++;
+    } else if ((mode == OUTPUT_OFF_WAIT_AC && ac) ||
+               (mode == OUTPUT_OFF_STAY && ac && atomic_load_explicit(&inst->ac_outage, memory_order_relaxed))) {
+        mode = OUTPUT_ON;
+        shutdown_output(instance, mode);
+        changes++;
+    }
+
+    bool requested, imminent;
+    ups_shutdown_status(instance, &requested, &imminent);
+    if (imminent != inst->imminent_reported) {
+        inst->imminent_reported = imminent;
+        changes++;
+    }
+
+    shutdown_next(next, atomic_load_explicit(&inst->shutdown_at, memory_order_acquire), now);
+    shutdown_next(next, atomic_load_explicit(&inst->reboot_at, memory_order_acquire), now);
+    if (mode == OUTPUT_OFF_REBOOT) {
+        uint32_t left = (uint32_t)(int32_t)(inst->restore_at - now);
+        if (left < *next) {
+            *next = left;
+        }
+    }
+    return changes;
+}
+
+// 所有实例共用一个单次定时器，按最早的时刻安排
+void ups_shutdown_timer(void) {
+    uint32_t now = ups_port_millis();
+    bool ac = atomic_load_explicit(&ac_present, memory_order_relaxed);
+    uint32_t changes = 0;
+    uint32_t next = UINT32_MAX;
+
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        changes += shutdown_instance_timer(i, now, ac, &next);
+    }
+    if (changes) {
+        atomic_fetch_add_explicit(&change_count, changes, memory_order_release);
+        ups_event_post(UPS_EVENT_SHUTDOWN);
+    }
+    ups_port_shutdown_timer(next);
+}
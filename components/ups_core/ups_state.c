@@ -0,0 +1,456 @@
+#include <stdint.h>
+#include "ups_port.h"
+#include "ups_report.h"
+#include "ups_notify.h"
+#include "ups_battery.h"
+#include "ups_runtime.h"
+#include "ups_sense.h"
+#include "ups_mains.h"
+#include "ups_boot.h"
+#include "ups_store.h"
+#include "ups_history.h"
+#include "ups_journal.h"
+#include "ups_shutdown.h"
+#include "ups_event.h"
+#include "ups_hid.h"
+#include "ups_state.h"
+
+static const char *TAG = "UPS";
+
+// 每个实例的状态，实例0的初值也是其他实例上电时的初值（ups_state_init 中复制）
+ups_instance_state_t ups_instances[UPS_INSTANCE_COUNT] = {
+    [0] = {
+        .status = {
+            .Charging = 1,                      // 充电中
+            .Discharging = 0,                    // 放电中
+            .ACPresent = 1,                      // AC电源存在
+            .BatteryPresent = 1,                 // 电池存在
+            .BelowRemainingCapacityLimit = 0,    // 低于容量限制
+            .RemainingTimeLimitExpired = 0,      // 时间限制到期
+            .NeedReplacement = 0,                // 需要更换电池
+            .VoltageNotRegulated = 0,            // 电压未调节
+            .FullyCharged = 0,                   // 电池充满
+            .FullyDischarged = 0,                // 电池放空
+            .ShutdownRequested = 0,              // 关机请求
+            .ShutdownImminent = 0,               // 即将关机
+            .CommunicationLost = 0,              // 通信丢失
+            .Overload = 0,                       // 过载
+            .unused1 = 0,                        // 保留位
+            .unused2 = 0                         // 保留位
+        },
+        .voltage = 11850,                     // 当前电压, 指数5 = 10^-5伏, 示例值：118.50V
+        .current = 0,                         // 电池电流（厘安，充电为正）
+        .remaining_capacity = 60,             // 剩余容量, 示例值：85.00%
+        .full_charge_capacity = 100,          // 充满电容量（单位：%，与设计容量相同）, 示例值：100%
+        .remaining_capacity_limit = 10,       // 剩余容量限制,示例值：10.00%
+        .runtime_to_empty = 3600,             // 运行至空的时间, 示例值：60分钟
+        .avg_time_to_full = 7200,             // 平均充满时间（秒）, 示例值：2小时
+        .avg_time_to_empty = 14400,           // 平均放空时间（秒）, 示例值：4小时
+    },
+};
+
+// 所有实例共用：同一台设备、同一路市电
+uint16_t manufacture_date = 12345;      // 生产日期（自1990-01-01的天数）
+uint16_t config_voltage = 12000;        // 配置电压, 指数5 = 10^-5伏  示例值：120.00V   
+uint8_t config_frequency = 50;          // 配置频率（Hz）, 有市电检测时按实测自动选择
+uint8_t warring_capacity_limit = 20;    // 警告容量限制,示例值：20.00%
+uint16_t design_capacity = 100;         // 设计容量（单位：%）, 示例值：100.00%
+
+// 电池参数：12V 7Ah 铅酸电池
+static const ups_battery_config_t battery_config = {
+    .design_capacity_mah = 7000,
+    .full_voltage_mv = 13600,           // 浮充电压
+    .taper_current_ma = 100,            // 0.014C
+    .empty_voltage_mv = 10500,          // 带载截止电压
+    .charge_efficiency = 95,
+};
+
+// 运行时间估算：20小时率 350mA，铅酸 Peukert 指数 1.2
+static const ups_runtime_config_t runtime_config = {
+    .tau_fast_ms = 120000,
+    .tau_slow_ms = 600000,
+    .rated_current_ma = 350,
+    .peukert_x100 = 120,
+    .derate_table = NULL,
+    .initial_load_ma = 1500,
+};
+
+// 市电判定：标称电压/频率锁定后按实测自动选择（50/60Hz，100~240V）
+static const ups_mains_config_t mains_config = {
+    .nominal_cv = 0,
+    .nominal_hz = 0,
+    .outage_pct = 50,
+    .brownout_pct = 80,
+    .surge_pct = 115,
+    .frequency_tol_pct = 5,
+    .recover_half_cycles = 4,
+};
+
+// 学习参数持久化：容量变化1%或内阻变化5%才算有意义，至少间隔10分钟；微小漂移6小时写一次
+static const ups_store_config_t store_config = {
+    .design_capacity_mah = 7000,
+    .capacity_step_pct = 1,
+    .resistance_step_pct = 5,
+    .min_interval_ms = 10 * 60 * 1000,
+    .max_interval_ms = 6 * 60 * 60 * 1000,
+};
+
+// 模拟电池采样（没有实际采集电路时使用）
+#define SIM_CHARGE_CURRENT_MA  700      // 0.1C 恒流充电
+#define SIM_LOAD_CURRENT_MA    1500     // 放电负载（实例 n 为 1/(n+1)）
+
+// 将全局变量序列化到报告表并整体发布（状态变化后调用）
+// 全局状态只在本任务中修改，TinyUSB任务只读取已发布的快照
+static void ups_reports_sync(void) {
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        const ups_instance_state_t* inst = &ups_instances[i];
+#define SET(id, value) ups_report_set(UPS_INSTANCE_REPORT_ID(i, id), value)
+        SET(HID_PD_PRESENTSTATUS, PresentStatus_to_uint16(&inst->status));
+        SET(HID_PD_MANUFACTUREDATE, manufacture_date);
+        SET(HID_PD_CONFIGVOLTAGE, config_voltage);
+        SET(HID_PD_CONFIGFREQUENCY, config_frequency);
+        SET(HID_PD_VOLTAGE, inst->voltage);
+        SET(HID_PD_CURRENT, (uint16_t)inst->current);
+        SET(HID_PD_REMAININGCAPACITY, inst->remaining_capacity);
+        SET(HID_PD_RUNTIMETOEMPTY, inst->runtime_to_empty);
+        SET(HID_PD_FULLCHARGECAPACITY, inst->full_charge_capacity);
+        SET(HID_PD_DESIGNCAPACITY, design_capacity);
+        SET(HID_PD_AVERAGETIME2FULL, inst->avg_time_to_full);
+        SET(HID_PD_AVERAGETIME2EMPTY, inst->avg_time_to_empty);
+#undef SET
+    }
+    ups_report_publish();
+}
+
+// 最近一次电池采样，由 ups_state_update 发布
+static int32_t sample_current_ma[UPS_INSTANCE_COUNT];
+static uint16_t sample_voltage_mv[UPS_INSTANCE_COUNT];
+static bool sample_sensed;              // 实例0已经用上ADC实测数据
+
+// 模拟采样用的粗略电量，ups_state_init 时取各实例的初值
+static uint8_t sim_percent[UPS_INSTANCE_COUNT];
+static uint16_t sim_ticks[UPS_INSTANCE_COUNT];
+
+// 没有采集数据时按AC状态和模型电量模拟电流与电压
+static uint32_t ups_state_simulate(uint8_t instance, int32_t* current_ma, uint16_t* voltage_mv) {
+    uint32_t load_ma = SIM_LOAD_CURRENT_MA / (instance + 1u);
+    uint8_t percent = sim_percent[instance];
+
+    if (ups_instances[instance].status.ACPresent) {
+        // 90%以上进入恒压段，充电电流线性减小到截止电流以下
+        *current_ma = percent < 90 ? SIM_CHARGE_CURRENT_MA
+                                   : SIM_CHARGE_CURRENT_MA * (100 - percent) / 10;
+        *voltage_mv = percent < 90 ? 12600 + percent * 10 : battery_config.full_voltage_mv;
+    } else {
+        *current_ma = -(int32_t)load_ma;
+        *voltage_mv = battery_config.empty_voltage_mv - 100 + percent * 18;
+    }
+
+    // 模拟电压只需要粗略的电量，每秒刷新一次
+    if (++sim_ticks[instance] >= UPS_BATTERY_SAMPLE_HZ) {
+        ups_battery_status_t battery;
+        ups_battery_get_status(instance, &battery);
+        sim_percent[instance] = battery.remaining_capacity;
+        sim_ticks[instance] = 0;
+    }
+    return load_ma;
+}
+
+// 最近一次已发布的市电状态变化计数、关机编排状态变化计数
+static uint32_t mains_events;
+static uint32_t shutdown_changes;
+
+// 电池采样：按 UPS_BATTERY_SAMPLE_HZ 调用，优先使用ADC采集的最新结果
+bool ups_state_sample(void) {
+    ups_sense_reading_t sense;
+    ups_mains_status_t mains;
+    uint32_t load_ma;
+    bool first_sample = false;
+
+    // 实例0使用ADC采集，其他实例没有采集电路，按模拟数据
+    if (ups_sense_latest(&sense)) {
+        sample_current_ma[0] = sense.battery_ma;
+        sample_voltage_mv[0] = sense.battery_mv;
+        load_ma = sense.load_ma;
+        if (!sample_sensed) {
+            // 第一份实测数据：立即发布，替换上电时的默认值
+            sample_sensed = true;
+            ups_boot_mark(UPS_BOOT_FIRST_SAMPLE);
+            first_sample = true;
+        }
+    } else {
+        load_ma = ups_state_simulate(0, &sample_current_ma[0], &sample_voltage_mv[0]);
+    }
+    ups_battery_sample(0, sample_current_ma[0], sample_voltage_mv[0]);
+    ups_runtime_sample(0, load_ma);
+    for (uint8_t i = 1; i < UPS_INSTANCE_COUNT; i++) {
+        uint32_t sim_load_ma = ups_state_simulate(i, &sample_current_ma[i], &sample_voltage_mv[i]);
+        ups_battery_sample(i, sample_current_ma[i], sample_voltage_mv[i]);
+        ups_runtime_sample(i, sim_load_ma);
+    }
+
+    // 历史记录只有实例0
+    bool mains_valid = ups_mains_latest(&mains);
+    ups_history_sample_t history = {
+        .battery_mv = sample_voltage_mv[0],
+        .battery_ma = (int16_t)(sample_current_ma[0] > INT16_MAX ? INT16_MAX
+                              : sample_current_ma[0] < INT16_MIN ? INT16_MIN : sample_current_ma[0]),
+        .load_ma = (uint16_t)(load_ma > UINT16_MAX ? UINT16_MAX : load_ma),
+        .mains_dv = mains_valid ? mains.rms_cv / 10 : 0,
+        .status = PresentStatus_to_uint16(&UPS),
+    };
+    ups_history_sample(&history);
+
+    // 第一份实测数据、市电状态变化和关机倒计时的状态变化需要立即发布，不等下一个更新周期
+    return first_sample || (mains_valid && mains.events != mains_events) ||
+           ups_shutdown_changes() != shutdown_changes;
+}
+
+// 设置AC状态，所有实例的充放电状态随之切换
+static void ups_state_set_ac(bool present) {
+    if (UPS.ACPresent == present) {
+        return;
+    }
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        struct PresentStatus* status = &ups_instances[i].status;
+        status->ACPresent = present;
+        status->Charging = present;
+        status->Discharging = !present;
+    }
+    if (present) {
+        UPS_LOGI(TAG, "AC Connected - Charging");
+    } else {
+        UPS_LOGI(TAG, "AC Disconnected - Discharging");
+    }
+}
+
+// 按市电检测结果刷新 ACPresent、VoltageNotRegulated 和配置电压/频率；
+// 还没有检测结果时返回 false
+static bool ups_state_mains(void) {
+    ups_mains_status_t mains;
+
+    if (!ups_mains_latest(&mains)) {
+        return false;
+    }
+    mains_events = mains.events;
+    if (mains.state == UPS_MAINS_UNKNOWN) {
+        return false;
+    }
+    ups_state_set_ac(mains.state != UPS_MAINS_OUTAGE);
+    bool not_regulated = mains.state == UPS_MAINS_BROWNOUT || mains.state == UPS_MAINS_SURGE ||
+                         (mains.state == UPS_MAINS_NORMAL && !mains.frequency_ok);
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        ups_instances[i].status.VoltageNotRegulated = not_regulated;
+    }
+    if (mains.nominal_cv) {
+        config_voltage = mains.nominal_cv;
+        config_frequency = mains.nominal_hz;
+    }
+    return true;
+}
+
+// 持久化：加载完成后恢复学习参数，之后提交当前参数（由 ups_store 决定是否写入）。只保存实例0
+static void ups_state_store(const ups_battery_status_t* battery) {
+    ups_store_data_t data;
+
+    if (ups_store_take_loaded(&data)) {
+        manufacture_date = data.manufacture_date;
+        ups_battery_restore(0, data.full_charge_mah, data.cycle_count, data.resistance_mohm);
+        return;
+    }
+    data.manufacture_date = manufacture_date;
+    data.full_charge_mah = battery->full_charge_mah;
+    data.cycle_count = battery->cycle_count;
+    data.resistance_mohm = battery->resistance_mohm;
+
+    // 放电中低于剩余容量限制或已放空：随时可能掉电，立即写入
+    bool urgent = (UPS.Discharging && UPS.BelowRemainingCapacityLimit) || UPS.FullyDischarged;
+    ups_store_update(&data, urgent, ups_port_millis());
+}
+
+// 写入事件日志的 PresentStatus 位：市电、电量告警、关机请求、过载等（充放电状态随之变化，不单独记录）
+#define JOURNAL_STATUS_MASK ((1u << 2) | (1u << 4) | (1u << 5) | (1u << 6) | (1u << 7) | \
+                             (1u << 9) | (1u << 10) | (1u << 11) | (1u << 12) | (1u << 13))
+
+// 最近一次记录的 PresentStatus
+static uint16_t journal_status;
+
+// 实例0的 PresentStatus 变化的位逐个放入事件日志
+static void ups_state_journal(void) {
+    uint16_t status = PresentStatus_to_uint16(&UPS);
+    uint16_t changed = (status ^ journal_status) & JOURNAL_STATUS_MASK;
+
+    for (uint8_t bit = 0; changed != 0; bit++, changed >>= 1) {
+        if (changed & 1) {
+            uint8_t detail = bit | ((status >> bit) & 1 ? UPS_JOURNAL_STATUS_SET : 0);
+            ups_journal_post(UPS_JOURNAL_STATUS, detail, status, sample_voltage_mv[0]);
+        }
+    }
+    journal_status = status;
+}
+
+// 市电检测输入（GPIO），没有配置时返回 false
+static bool ups_state_ac_sense(void) {
+    bool present;
+
+    if (!ups_port_ac_sense(&present)) {
+        return false;
+    }
+    ups_state_set_ac(present);
+    return true;
+}
+
+// 没有市电检测时模拟AC电源断开/连接：60秒切换一次，按键立即切换
+static uint32_t sim_ac_at;
+static bool sim_ac_toggle;
+
+// 总线挂起期间出现时需要唤醒主机的电源事件：市电断开，低于剩余容量限制、剩余时间耗尽、电池放空、即将关机
+#define WAKEUP_ALARM_SET_MASK ((1u << 4) | (1u << 5) | (1u << 9) | (1u << 11))
+
+static uint16_t ups_state_alarms(uint16_t status) {
+    return (~status & (1u << 2)) | (status & WAKEUP_ALARM_SET_MASK);
+}
+
+// 由电池模型和关机编排刷新一个实例
+static void ups_state_update_instance(uint8_t instance, ups_battery_status_t* battery) {
+    ups_instance_state_t* inst = &ups_instances[instance];
+    struct PresentStatus* status = &inst->status;
+
+    // 电池采样值（厘伏/厘安）
+    inst->voltage = sample_voltage_mv[instance] / 10;
+    inst->current = (int16_t)(sample_current_ma[instance] / 10);
+
+    // 电池模型输出
+    ups_battery_get_status(instance, battery);
+    inst->remaining_capacity = battery->remaining_capacity;
+    inst->full_charge_capacity = battery->full_charge_capacity;
+    ups_runtime_estimate(instance, battery->remaining_mah, battery->full_charge_mah,
+                         &inst->runtime_to_empty, &inst->avg_time_to_empty);
+    inst->avg_time_to_full = battery->avg_time_to_full;
+    status->FullyCharged = battery->fully_charged;
+    status->FullyDischarged = battery->fully_discharged;
+    status->Charging = status->ACPresent && !battery->fully_charged;
+    status->BelowRemainingCapacityLimit = inst->remaining_capacity < inst->remaining_capacity_limit;
+
+    // 关机编排：倒计时由定时器驱动，这里只同步状态位
+    bool requested, imminent;
+    ups_shutdown_status(instance, &requested, &imminent);
+    status->ShutdownRequested = requested;
+    status->ShutdownImminent = imminent;
+}
+
+// 更新UPS状态，event_us 为触发这次更新的事件的投递时刻
+static void ups_state_update_at(uint32_t event_us) {
+    uint16_t alarms_before[UPS_INSTANCE_COUNT];
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        alarms_before[i] = ups_state_alarms(PresentStatus_to_uint16(&ups_instances[i].status));
+    }
+
+    if (!ups_state_mains() && !ups_state_ac_sense() &&
+        (sim_ac_toggle || ups_port_millis() - sim_ac_at > 60000)) {
+        ups_state_set_ac(!UPS.ACPresent);   //每次翻转
+        sim_ac_at = ups_port_millis();
+    }
+    sim_ac_toggle = false;
+
+    // 关机编排使用共同的市电状态
+    shutdown_changes = ups_shutdown_changes();
+    ups_shutdown_ac(UPS.ACPresent);
+
+    // 倒序处理，最后是实例0，battery 即实例0的模型输出
+    ups_battery_status_t battery;
+    for (uint8_t i = UPS_INSTANCE_COUNT; i-- > 0;) {
+        ups_state_update_instance(i, &battery);
+    }
+    ups_state_store(&battery);
+    ups_state_journal();
+
+    // 刷新报告表，并推送变化的Input报告（挂起期间留在待发集合中）
+    ups_reports_sync();
+    ups_notify_check();
+
+    // 报告已经待发，再唤醒主机：恢复后第一个中断报告就是新的 PresentStatus。任一实例出现告警都唤醒一次
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT && ups_hid_suspended(); i++) {
+        uint16_t status = PresentStatus_to_uint16(&ups_instances[i].status);
+        if (ups_state_alarms(status) & ~alarms_before[i]) {
+            ups_hid_remote_wakeup(status, event_us);
+            break;
+        }
+    }
+    if (sample_sensed) {
+        ups_boot_mark(UPS_BOOT_FIRST_PUBLISH);
+    }
+
+    UPS_LOGI(TAG, "ACPresent: %d, Charging: %d, Discharging: %d, FullyCharged: %d, RemainingCapacity: %d%%",
+        UPS.ACPresent, UPS.Charging, UPS.Discharging, UPS.FullyCharged, ups_instances[0].remaining_capacity);
+    for (uint8_t i = 1; i < UPS_INSTANCE_COUNT; i++) {
+        UPS_LOGI(TAG, "Instance %u: Charging: %d, FullyCharged: %d, RemainingCapacity: %d%%",
+            i, ups_instances[i].status.Charging, ups_instances[i].status.FullyCharged,
+            ups_instances[i].remaining_capacity);
+    }
+}
+
+void ups_state_update(void) {
+    ups_state_update_at(ups_port_micros());
+}
+
+#define DISPATCH_SAMPLE_MS   (1000 / UPS_BATTERY_SAMPLE_HZ)
+#define BUTTON_DEBOUNCE_MS   200
+
+// 需要立即发布的事件
+#define DISPATCH_IMMEDIATE (UPS_EVENT_BIT(UPS_EVENT_MAINS) | UPS_EVENT_BIT(UPS_EVENT_AC_GPIO) | \
+                            UPS_EVENT_BIT(UPS_EVENT_BUTTON) | UPS_EVENT_BIT(UPS_EVENT_USB) |   \
+                            UPS_EVENT_BIT(UPS_EVENT_SHUTDOWN) | UPS_EVENT_BIT(UPS_EVENT_STORE) | \
+                            UPS_EVENT_BIT(UPS_EVENT_TICK))
+
+// 下一个待补齐的采样时刻、上一次处理按键的时刻
+static uint32_t sample_due;
+static uint32_t button_at;
+
+void ups_state_dispatch(uint32_t events) {
+    uint32_t now = ups_port_millis();
+    bool urgent = false;
+
+    while ((int32_t)(now - sample_due) >= 0) {
+        urgent |= ups_state_sample();
+        sample_due += DISPATCH_SAMPLE_MS;
+    }
+    if (events & UPS_EVENT_BIT(UPS_EVENT_BUTTON)) {
+        if (now - button_at >= BUTTON_DEBOUNCE_MS) {
+            sim_ac_toggle = true;
+            button_at = now;
+        } else {
+            events &= ~UPS_EVENT_BIT(UPS_EVENT_BUTTON);     // 抖动
+        }
+    }
+    if (urgent || (events & DISPATCH_IMMEDIATE)) {
+        ups_state_update_at(ups_event_first_posted_us(events));
+        ups_event_published(events);
+    }
+}
+
+void ups_state_init(void) {
+    ups_event_init();
+    sample_due = ups_port_millis();
+    button_at = sample_due - BUTTON_DEBOUNCE_MS;
+    sim_ac_at = 0;
+    sim_ac_toggle = false;
+    ups_mains_init(&mains_config);
+    for (uint8_t i = 0; i < UPS_INSTANCE_COUNT; i++) {
+        if (i > 0) {
+            ups_instances[i] = ups_instances[0];
+        }
+        ups_battery_init(i, &battery_config, ups_instances[i].remaining_capacity);
+        sim_percent[i] = ups_instances[i].remaining_capacity;
+        sim_ticks[i] = 0;
+    }
+    ups_runtime_init(&runtime_config);
+    ups_store_init(&store_config);
+    ups_history_init();
+    ups_journal_init();
+    journal_status = PresentStatus_to_uint16(&UPS);
+    ups_report_init();
+    ups_shutdown_init();
+    ups_reports_sync();
+    ups_notify_init();
+}
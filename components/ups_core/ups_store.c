@@ -0,0 +1,165 @@
+#include <stdatomic.h>
+#include "ups_port.h"
+#include "ups_seqbuf.h"
+#include "ups_store.h"
+#include "ups_event.h"
+
+static const char *TAG = "STORE";
+
+// 加载结果交接（后端 -> 状态任务）
+enum {
+    STORE_LOADING = 0,
+    STORE_LOADED_EMPTY,
+    STORE_LOADED,
+    STORE_TAKEN,
+};
+
+static ups_store_config_t store_config;
+
+// 状态任务私有
+static bool store_ready;                    // 已取走加载结果，可以暂存
+static bool store_urgent;                   // 处于紧急状态（本次已暂存）
+static ups_store_data_t store_baseline;     // 最近一次暂存（或加载）的内容
+static uint32_t store_stage_ms;
+
+static atomic_int store_load_state;
+static ups_store_data_t store_load_data;
+
+// 待写快照：状态任务是唯一的写者（见 ups_seqbuf.h），写入任务只取最新一份
+static ups_store_data_t store_bank[2];
+static ups_seqbuf_t store_staged;
+static atomic_uint store_written;
+static atomic_bool store_failed;
+static atomic_uint store_commit_count;
+static atomic_uint store_failure_count;
+
+void ups_store_init(const ups_store_config_t* config) {
+    store_config = *config;
+    store_ready = false;
+    store_urgent = false;
+    atomic_store(&store_load_state, STORE_LOADING);
+    ups_seqbuf_init(&store_staged, store_bank, sizeof(store_bank[0]));
+    atomic_store(&store_written, 0);
+    atomic_store(&store_failed, false);
+    atomic_store(&store_commit_count, 0);
+    atomic_store(&store_failure_count, 0);
+}
+
+void ups_store_loaded(const ups_store_data_t* data) {
+    if (data != NULL && data->version == UPS_STORE_VERSION) {
+        store_load_data = *data;
+        atomic_store_explicit(&store_load_state, STORE_LOADED, memory_order_release);
+    } else {
+        atomic_store_explicit(&store_load_state, STORE_LOADED_EMPTY, memory_order_release);
+    }
+    ups_event_post(UPS_EVENT_STORE);
+}
+
+bool ups_store_take_loaded(ups_store_data_t* data) {
+    int state = atomic_load_explicit(&store_load_state, memory_order_acquire);
+    if (state == STORE_LOADING || state == STORE_TAKEN) {
+        return false;
+    }
+    atomic_store_explicit(&store_load_state, STORE_TAKEN, memory_order_relaxed);
+
+    // 基线为闪存中的内容，没有数据时全零（第一次有意义的变化后写入）
+    store_ready = true;
+    store_stage_ms = ups_port_millis();
+    if (state == STORE_LOADED) {
+        store_baseline = store_load_data;
+        *data = store_load_data;
+        UPS_LOGI(TAG, "Loaded: %u mAh, %u cycles, %u mOhm, date %u", (unsigned)data->full_charge_mah,
+                 data->cycle_count, data->resistance_mohm, data->manufacture_date);
+        return true;
+    }
+    store_baseline = (ups_store_data_t){ 0 };
+    UPS_LOGI(TAG, "No stored battery data");
+    return false;
+}
+
+static uint32_t store_diff(uint32_t a, uint32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+// 生产日期、循环次数变化，或容量/内阻变化超过阈值
+static bool store_meaningful(const ups_store_data_t* a, const ups_store_data_t* b) {
+    if (a->manufacture_date != b->manufacture_date || a->cycle_count != b->cycle_count) {
+        return true;
+    }
+    if (store_diff(a->full_charge_mah, b->full_charge_mah) * 100 >=
+        store_config.design_capacity_mah * store_config.capacity_step_pct) {
+        return true;
+    }
+    if (b->resistance_mohm == 0) {
+        return a->resistance_mohm != 0;
+    }
+    return store_diff(a->resistance_mohm, b->resistance_mohm) * 100 >=
+           (uint32_t)b->resistance_mohm * store_config.resistance_step_pct;
+}
+
+static bool store_differs(const ups_store_data_t* a, const ups_store_data_t* b) {
+    return a->manufacture_date != b->manufacture_date || a->cycle_count != b->cycle_count ||
+           a->full_charge_mah != b->full_charge_mah || a->resistance_mohm != b->resistance_mohm;
+}
+
+static void store_stage(const ups_store_data_t* data, uint32_t now_ms) {
+    ups_seqbuf_publish(&store_staged, data);
+
+    store_baseline = *data;
+    store_stage_ms = now_ms;
+    ups_port_store_kick();
+}
+
+void ups_store_update(const ups_store_data_t* data, bool urgent, uint32_t now_ms) {
+    if (!store_ready) {
+        return;
+    }
+
+    ups_store_data_t current = *data;
+    current.version = UPS_STORE_VERSION;
+
+    // 写入失败：按有意义的变化处理，最小间隔后重试
+    bool failed = atomic_exchange_explicit(&store_failed, false, memory_order_relaxed);
+    if (failed) {
+        store_baseline.version = 0;
+    }
+    bool differs = store_baseline.version == 0 || store_differs(&current, &store_baseline);
+    bool meaningful = store_baseline.version == 0 ? differs : store_meaningful(&current, &store_baseline);
+    uint32_t elapsed = now_ms - store_stage_ms;
+
+    if (urgent && !store_urgent && differs) {
+        store_stage(&current, now_ms);
+    } else if (meaningful && elapsed >= store_config.min_interval_ms) {
+        store_stage(&current, now_ms);
+    } else if (differs && elapsed >= store_config.max_interval_ms) {
+        store_stage(&current, now_ms);
+    }
+    store_urgent = urgent;
+}
+
+bool ups_store_pending(ups_store_data_t* data, uint32_t* seq) {
+    unsigned s = ups_seqbuf_read(&store_staged, data);
+    if (s == atomic_load_explicit(&store_written, memory_order_relaxed)) {
+        return false;
+    }
+    *seq = s;
+    return true;
+}
+
+void ups_store_done(uint32_t seq, bool ok) {
+    atomic_store_explicit(&store_written, seq, memory_order_relaxed);
+    if (ok) {
+        atomic_fetch_add_explicit(&store_commit_count, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&store_failure_count, 1, memory_order_relaxed);
+        atomic_store_explicit(&store_failed, true, memory_order_relaxed);
+    }
+}
+
+uint32_t ups_store_commits(void) {
+    return atomic_load_explicit(&store_commit_count, memory_order_relaxed);
+}
+
+uint32_t ups_store_failures(void) {
+    return atomic_load_explicit(&store_failure_count, memory_order_relaxed);
+}
@@ -4,11 +4,24 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_err.h"
-#include "nvs_flash.h"
+#include "esp_system.h"
 #include "tusb.h"
 #include "class/hid/hid.h"
 #include "tinyusb.h"
 #include "device/usbd.h"
+#include "ups_report_schema.h"
+#include "ups_hid.h"
+#include "ups_state.h"
+#include "ups_bench.h"
+#include "ups_log.h"
+#include "ups_journal.h"
+#include "ups_battery.h"
+#include "ups_adc_esp.h"
+#include "ups_store_esp.h"
+#include "ups_console_esp.h"
+#include "ups_event_esp.h"
+#include "ups_power_esp.h"
+#include "ups_boot.h"
 
 static const char *TAG = "UPS";
 
@@ -16,594 +29,19 @@ static const char *TAG = "UPS";
 #define LO8(x) ((x) & 0xFF)
 #define HI8(x) ((x) >> 8)
 
-// 报告ID定义
-#define HID_PD_IPRODUCT              0x01 // FEATURE ONLY
-#define HID_PD_SERIAL                0x02 // FEATURE ONLY
-#define HID_PD_MANUFACTURER          0x03 // FEATURE ONLY
-#define IDEVICECHEMISTRY             0x04
-#define IOEMVENDOR                   0x05
-
-#define HID_PD_RECHARGEABLE          0x06 // FEATURE ONLY
-#define HID_PD_PRESENTSTATUS         0x07 // INPUT OR FEATURE(required by Windows)
-#define HID_PD_REMAINTIMELIMIT       0x08
-#define HID_PD_MANUFACTUREDATE       0x09
-#define HID_PD_CONFIGVOLTAGE         0x0A // 10 FEATURE ONLY
-#define HID_PD_VOLTAGE               0x0B // 11 INPUT (NA) OR FEATURE(implemented)
-#define HID_PD_REMAININGCAPACITY     0x0C // 12 INPUT OR FEATURE(required by Windows)
-#define HID_PD_RUNTIMETOEMPTY        0x0D 
-#define HID_PD_FULLCHARGECAPACITY    0x0E // 14 FEATURE ONLY. Last Full Charge Capacity 
-#define HID_PD_WARNCAPACITYLIMIT     0x0F
-#define HID_PD_CPCTYGRANULARITY1     0x10
-#define HID_PD_REMNCAPACITYLIMIT     0x11
-#define HID_PD_DELAYBE4SHUTDOWN      0x12 // 18 FEATURE ONLY
-#define HID_PD_DELAYBE4REBOOT        0x13
-#define HID_PD_AUDIBLEALARMCTRL      0x14 // 20 INPUT OR FEATURE
-#define HID_PD_CURRENT               0x15 // 21 FEATURE ONLY
-#define HID_PD_CAPACITYMODE          0x16
-#define HID_PD_DESIGNCAPACITY        0x17
-#define HID_PD_CPCTYGRANULARITY2     0x18
-#define HID_PD_AVERAGETIME2FULL      0x1A
-#define HID_PD_AVERAGECURRENT        0x1B
-#define HID_PD_AVERAGETIME2EMPTY     0x1C
-
-#define HID_PD_IDEVICECHEMISTRY      0x1F // Feature
-#define HID_PD_IOEMINFORMATION       0x20 // Feature
-
-
-
-// 字符串索引定义
-#define IMANUFACTURER               0x01
-#define IPRODUCT                    0x02
-#define ISERIAL                     0x03
-#define IDEVICECHEMISTRY            0x04
-
-// HID 协议类型定义
-#define HID_PROTOCOL_NONE 0
-
-
-// 电源状态结构体
-struct PresentStatus {
-  uint8_t Charging : 1;                   // bit 0x00
-  uint8_t Discharging : 1;                // bit 0x01
-  uint8_t ACPresent : 1;                  // bit 0x02
-  uint8_t BatteryPresent : 1;             // bit 0x03
-  uint8_t BelowRemainingCapacityLimit : 1;// bit 0x04
-  uint8_t RemainingTimeLimitExpired : 1;  // bit 0x05
-  uint8_t NeedReplacement : 1;            // bit 0x06
-  uint8_t VoltageNotRegulated : 1;        // bit 0x07
-  
-  uint8_t FullyCharged : 1;               // bit 0x08
-  uint8_t FullyDischarged : 1;            // bit 0x09
-  uint8_t ShutdownRequested : 1;          // bit 0x0A
-  uint8_t ShutdownImminent : 1;           // bit 0x0B
-  uint8_t CommunicationLost : 1;          // bit 0x0C
-  uint8_t Overload : 1;                   // bit 0x0D
-  uint8_t unused1 : 1;
-  uint8_t unused2 : 1;
-};
-
-// 将PresentStatus结构体转换为uint16_t
-static inline uint16_t PresentStatus_to_uint16(const struct PresentStatus* ps) {
-    return *(const uint16_t*)(ps);
-}
-
-// 全局状态变量
-static struct PresentStatus UPS = {
-    .Charging = 1,                      // 充电中
-    .Discharging = 0,                    // 放电中
-    .ACPresent = 1,                      // AC电源存在
-    .BatteryPresent = 1,                 // 电池存在
-    .BelowRemainingCapacityLimit = 0,    // 低于容量限制
-    .RemainingTimeLimitExpired = 0,      // 时间限制到期
-    .NeedReplacement = 0,                // 需要更换电池
-    .VoltageNotRegulated = 0,            // 电压未调节
-    .FullyCharged = 0,                   // 电池充满
-    .FullyDischarged = 0,                // 电池放空
-    .ShutdownRequested = 0,              // 关机请求
-    .ShutdownImminent = 0,               // 即将关机
-    .CommunicationLost = 0,              // 通信丢失
-    .Overload = 0,                       // 过载
-    .unused1 = 0,                        // 保留位
-    .unused2 = 0                         // 保留位
-};
-
-uint16_t manufacture_date = 12345;      // 生产日期（自1990-01-01的天数）
-uint16_t config_voltage = 12000;        // 配置电压, 指数5 = 10^-5伏  示例值：120.00V   
-uint16_t voltage = 11850;               // 当前电压, 指数5 = 10^-5伏, 示例值：118.50V  
-uint8_t remaining_capacity = 60;        // 剩余容量, 示例值：85.00%
-uint16_t runtime_to_empty = 3600;       // 运行至空的时间, 示例值：60分钟
-uint16_t full_charge_capacity = 10000;  // 充满电容量, 示例值：100.00%
-uint8_t warring_capacity_limit = 20;    // 警告容量限制,示例值：20.00%
-uint8_t remaining_capacity_limit = 10;  // 剩余容量限制,示例值：10.00%
-int16_t delay_before_shutdown = 300;    // 关机前延迟（秒）,示例值：300秒
-int16_t delay_before_reboot = 60;       // 重启前延迟（秒）, 示例值：60秒
-uint16_t design_capacity = 100;         // 设计容量（单位：%）, 示例值：100.00%
-uint16_t avg_time_to_full = 7200;       // 平均充满时间（秒）, 示例值：2小时
-uint16_t avg_time_to_empty = 14400;     // 平均放空时间（秒）, 示例值：4小时
-
-// A.6 Report Descriptorr  报告描述符 
-const uint8_t hid_report_descriptor_github[] = {
-
-    0x05, 0x84, // USAGE_PAGE (Power Device)
-    0x09, 0x04, // USAGE (UPS)
-    0xA1, 0x01, // COLLECTION (Application)
-
-        0x09, 0x24, //   USAGE (Sink)
-        0xA1, 0x02, //   COLLECTION (Logical)
-        0x75, 0x08, //     REPORT_SIZE (8)
-        0x95, 0x01, //     REPORT_COUNT (1)
-        0x15, 0x00, //     LOGICAL_MINIMUM (0)
-        0x26, 0xFF, 0x00, //     LOGICAL_MAXIMUM (255)
-        0x85, HID_PD_IPRODUCT, //     REPORT_ID (1)
-        0x09, 0xFE, //     USAGE (iProduct)
-        0x79, IPRODUCT, //     STRING INDEX (2)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_SERIAL, //     REPORT_ID (2)
-        0x09, 0xFF, //     USAGE (iSerialNumber)
-        0x79, ISERIAL, //  STRING INDEX (3)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_MANUFACTURER, //     REPORT_ID (3)
-        0x09, 0xFD, //     USAGE (iManufacturer)
-        0x79, IMANUFACTURER, //     STRING INDEX (1)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x05, 0x85, //     USAGE_PAGE (Battery System) ====================
-        0x85, HID_PD_RECHARGEABLE, //     REPORT_ID (6)
-        0x09, 0x8B, //     USAGE (Rechargable)                  
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_IDEVICECHEMISTRY, //     REPORT_ID (31)
-        0x09, 0x89, //     USAGE (iDeviceChemistry)
-        0x79, IDEVICECHEMISTRY, //     STRING INDEX (4)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_IOEMINFORMATION,  //     REPORT_ID (32)
-        0x09, 0x8F, //     USAGE (iOEMInformation)
-        0x79, IOEMVENDOR, //     STRING INDEX (5)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_CAPACITYMODE, //     REPORT_ID (22)
-        0x09, 0x2C, //     USAGE (CapacityMode)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_CPCTYGRANULARITY1, //     REPORT_ID (16)
-        0x09, 0x8D, //     USAGE (CapacityGranularity1)
-        0x26, 0x64,0x00, //     LOGICAL_MAXIMUM (100)    
-        0xB1, 0x22, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_CPCTYGRANULARITY2, //     REPORT_ID (24)
-        0x09, 0x8E, //     USAGE (CapacityGranularity2)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_FULLCHARGECAPACITY, //     REPORT_ID (14)        
-        0x09, 0x67, //     USAGE (FullChargeCapacity)
-        0xB1, 0x83, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_DESIGNCAPACITY, //     REPORT_ID (23)
-        0x09, 0x83, //     USAGE (DesignCapacity)
-        0xB1, 0x83, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_REMAININGCAPACITY, //     REPORT_ID (12)
-        0x09, 0x66, //     USAGE (RemainingCapacity)
-        0x81, 0xA3, //     INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x66, //     USAGE (RemainingCapacity)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_WARNCAPACITYLIMIT, //     REPORT_ID (15)
-        0x09, 0x8C, //     USAGE (WarningCapacityLimit)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_REMNCAPACITYLIMIT, //     REPORT_ID (17)
-        0x09, 0x29, //     USAGE (RemainingCapacityLimit)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_MANUFACTUREDATE, //     REPORT_ID (9)
-        0x09, 0x85, //     USAGE (ManufacturerDate)
-        0x75, 0x10, //     REPORT_SIZE (16)
-        0x27, 0xFF, 0xFF, 0x00, 0x00, //     LOGICAL_MAXIMUM (65534)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_AVERAGETIME2FULL, //     REPORT_ID (26)
-        0x09, 0x6A, //     USAGE (AverageTimeToFull)
-        0x27, 0xFF, 0xFF, 0x00, 0x00, //     LOGICAL_MAXIMUM (65534)
-        0x66, 0x01, 0x10, //     UNIT (Seconds)
-        0x55, 0x00, //     UNIT_EXPONENT (0)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield) 
-        0x85, HID_PD_AVERAGETIME2EMPTY, //     REPORT_ID (28)
-        0x09, 0x69, //     USAGE (AverageTimeToEmpty)  
-        0x81, 0xA3, //     INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x69, //     USAGE (AverageTimeToEmpty)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_RUNTIMETOEMPTY, //     REPORT_ID (13)    
-        0x09, 0x68, //     USAGE (RunTimeToEmpty)  
-        0x81, 0xA3, //     INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x68, //     USAGE (RunTimeToEmpty)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)      
-        0x85, HID_PD_REMAINTIMELIMIT, //     REPORT_ID (8)
-        0x09, 0x2A, //     USAGE (RemainingTimeLimit)
-        0x75, 0x10, //     REPORT_SIZE (16)
-        0x27, 0x64, 0x05, 0x00, 0x00, //     LOGICAL_MAXIMUM (1380)
-        0x16, 0x78, 0x00, //     LOGICAL_MINIMUM (120)
-        0x81, 0x22, //     INPUT (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x2A, //     USAGE (RemainingTimeLimit)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x05, 0x84, //     USAGE_PAGE (Power Device) ====================
-        0x85, HID_PD_DELAYBE4SHUTDOWN, //     REPORT_ID (18)
-        0x09, 0x57, //     USAGE (DelayBeforeShutdown)
-        0x16, 0x00, 0x80, //     LOGICAL_MINIMUM (-32768)
-        0x27, 0xFF, 0x7F, 0x00, 0x00, //     LOGICAL_MAXIMUM (32767)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_DELAYBE4REBOOT, //     REPORT_ID (19)
-        0x09, 0x55, //     USAGE (DelayBeforeReboot)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_CONFIGVOLTAGE, //     REPORT_ID (10)
-        0x09, 0x40, //     USAGE (ConfigVoltage)
-        0x15, 0x00, //     LOGICAL_MINIMUM (0)
-        0x27, 0xFF, 0xFF, 0x00, 0x00, //     LOGICAL_MAXIMUM (65535)
-        0x67, 0x21, 0xD1, 0xF0, 0x00, //     UNIT (Centivolts)
-        0x55, 0x05, //     UNIT_EXPONENT (5)
-        0xB1, 0x23, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Nonvolatile, Bitfield)
-        0x85, HID_PD_VOLTAGE, //     REPORT_ID (11)
-        0x09, 0x30, //     USAGE (Voltage)
-        0x81, 0xA3, //     INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x30, //     USAGE (Voltage)
-        0xB1, 0xA3, //     FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x85, HID_PD_AUDIBLEALARMCTRL, //     REPORT_ID (20)
-        0x09, 0x5A, //     USAGE (AudibleAlarmControl)
-        0x75, 0x08, //     REPORT_SIZE (8)
-        0x15, 0x01, //     LOGICAL_MINIMUM (1)
-        0x25, 0x03, //     LOGICAL_MAXIMUM (3)
-        0x65, 0x00, //     UNIT (0)
-        0x55, 0x00, //     UNIT_EXPONENT (0)
-        0x81, 0x22, //     INPUT (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x5A, //     USAGE (AudibleAlarmControl)
-        0xB1, 0xA2, //     FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x02, //     USAGE (PresentStatus)
-        0xA1, 0x02, //     COLLECTION (Logical)
-        0x85, HID_PD_PRESENTSTATUS, //       REPORT_ID (7)
-        0x05, 0x85, //       USAGE_PAGE (Battery System) =================
-        0x09, 0x44, //       USAGE (Charging)
-        0x75, 0x01, //       REPORT_SIZE (1)
-        0x15, 0x00, //       LOGICAL_MINIMUM (0)
-        0x25, 0x01, //       LOGICAL_MAXIMUM (1)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x44, //       USAGE (Charging)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x45, //       USAGE (Discharging)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x45, //       USAGE (Discharging)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0xD0, //       USAGE (ACPresent)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0xD0, //       USAGE (ACPresent)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0xD1, //       USAGE (BatteryPresent)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0xD1, //       USAGE (BatteryPresent)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x42, //       USAGE (BelowRemainingCapacityLimit)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x42, //       USAGE (BelowRemainingCapacityLimit)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x43, //       USAGE (RemainingTimeLimitExpired)
-        0x81, 0xA2, //       INPUT (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x43, //       USAGE (RemainingTimeLimitExpired)
-        0xB1, 0xA2, //       FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)  
-        0x09, 0x4B, //       USAGE (NeedReplacement)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x4B, //       USAGE (NeedReplacement)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)    
-        0x09, 0xDB, //       USAGE (VoltageNotRegulated)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0xDB, //       USAGE (VoltageNotRegulated)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x46, //       USAGE (FullyCharged)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x46, //       USAGE (FullyCharged)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x47, //       USAGE (FullyDischarged)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x47, //       USAGE (FullyDischarged)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)    
-        0x05, 0x84, //       USAGE_PAGE (Power Device) =================
-        0x09, 0x68, //       USAGE (ShutdownRequested)
-        0x81, 0xA2, //       INPUT (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x68, //       USAGE (ShutdownRequested)
-        0xB1, 0xA2, //       FEATURE (Data, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x69, //       USAGE (ShutdownImminent)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x69, //       USAGE (ShutdownImminent)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x73, //       USAGE (CommunicationLost)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x73, //       USAGE (CommunicationLost)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x09, 0x65, //       USAGE (Overload)
-        0x81, 0xA3, //       INPUT (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Bitfield)
-        0x09, 0x65, //       USAGE (Overload)
-        0xB1, 0xA3, //       FEATURE (Constant, Variable, Absolute, No Wrap, Linear, No Preferred, No Null Position, Volatile, Bitfield)
-        0x95, 0x02, //       REPORT_COUNT (2) // padding bits to make the report byte aligned
-        0x81, 0x01, //       INPUT (Constant, Array, Absolute)
-        0xB1, 0x01, //       FEATURE (Constant, Array, Absolute, No Wrap, Linear, Preferred State, No Null Position, Nonvolatile, Bitfield)
-        0xC0,       //     END_COLLECTION
-        0xC0,       //   END_COLLECTION
-    0xC0        // END_COLLECTION
-};
-
 // A.6 Report Descriptor  报告描述符
-const uint8_t hid_report_descriptor[] = {
-    // ==================== 根集合：定义整个设备 ====================
-    0x05, 0x84, // USAGE_PAGE (Power Device)  // 主用途页面：电源设备
-    0x09, 0x04, // USAGE (UPS)                // 具体用途：不间断电源 (UPS)
-    0xA1, 0x01, // COLLECTION (Application)   // 开始一个应用集合（根集合）
-
-    // ==================== 逻辑集合：信息类特性 ====================
-    // 这个集合主要包含设备标识和静态信息，使用字符串索引
-    0x09, 0x24, //   USAGE (Sink)             // 用途：接收器（表示此设备消耗电源）
-    0xA1, 0x02, //   COLLECTION (Logical)     // 开始一个逻辑集合
-        0x75, 0x08, //     REPORT_SIZE (8)    // 每个字段大小为8位（1字节）
-        0x95, 0x01, //     REPORT_COUNT (1)   // 字段数量为1
-        0x15, 0x00, //     LOGICAL_MINIMUM (0) // 逻辑最小值：0
-        0x26, 0xFF, 0x00, // LOGICAL_MAXIMUM (255) // 逻辑最大值：255
-
-        // --- 产品字符串 (Report ID 1) ---
-        0x85, HID_PD_IPRODUCT, //     REPORT_ID (1) // 报告ID：1
-        0x09, 0xFE, //     USAGE (iProduct)        // 用途：产品字符串
-        0x79, IPRODUCT, //     STRING INDEX (2)    // 字符串描述符索引：2
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 序列号字符串 (Report ID 2) ---
-        0x85, HID_PD_SERIAL, //     REPORT_ID (2) // 报告ID：2
-        0x09, 0xFF, //     USAGE (iSerialNumber)   // 用途：序列号字符串
-        0x79, ISERIAL, //  STRING INDEX (3)        // 字符串描述符索引：3
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 制造商字符串 (Report ID 3) ---
-        0x85, HID_PD_MANUFACTURER, // REPORT_ID (3) // 报告ID：3
-        0x09, 0xFD, //     USAGE (iManufacturer)   // 用途：制造商字符串
-        0x79, IMANUFACTURER, // STRING INDEX (1)   // 字符串描述符索引：1
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-    // ==================== 电池系统特性 ====================
-    // 切换用途页面到电池系统，定义电池相关特性
-        0x05, 0x85, //     USAGE_PAGE (Battery System) // 用途页面：电池系统
-
-        // --- 是否可充电 (Report ID 6) ---
-        0x85, HID_PD_RECHARGEABLE, // REPORT_ID (6) // 报告ID：6
-        0x09, 0x8B, //     USAGE (Rechargable)      // 用途：可充电
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 电池化学类型字符串 (Report ID 31) ---
-        0x85, HID_PD_IDEVICECHEMISTRY, // REPORT_ID (31) // 报告ID：31
-        0x09, 0x89, //     USAGE (iDeviceChemistry) // 用途：电池化学类型字符串
-        0x79, IDEVICECHEMISTRY, // STRING INDEX (4) // 字符串描述符索引：4
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- OEM信息字符串 (Report ID 32) ---
-        0x85, HID_PD_IOEMINFORMATION,  // REPORT_ID (32) // 报告ID：32
-        0x09, 0x8F, //     USAGE (iOEMInformation)  // 用途：OEM信息字符串
-        0x79, IOEMVENDOR, // STRING INDEX (5)       // 字符串描述符索引：5
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 容量模式 (Report ID 22) ---
-        0x85, HID_PD_CAPACITYMODE, // REPORT_ID (22) // 报告ID：22
-        0x09, 0x2C, //     USAGE (CapacityMode)     // 用途：容量模式（如mAh/mWh）
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 容量粒度1 (Report ID 16) ---
-        0x85, HID_PD_CPCTYGRANULARITY1, // REPORT_ID (16) // 报告ID：16
-        0x09, 0x8D, //     USAGE (CapacityGranularity1) // 用途：容量粒度（步进值）
-        0x26, 0x64,0x00, // LOGICAL_MAXIMUM (100)    // 逻辑最大值：100
-        0xB1, 0x22, //     FEATURE (Data, Var, Abs, NonVol) // 特性报告（数据，非易失）
-
-        // --- 容量粒度2 (Report ID 24) ---
-        0x85, HID_PD_CPCTYGRANULARITY2, // REPORT_ID (24) // 报告ID：24
-        0x09, 0x8E, //     USAGE (CapacityGranularity2) // 用途：容量粒度2
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 充满电容量 (Report ID 14) ---
-        0x85, HID_PD_FULLCHARGECAPACITY, // REPORT_ID (14) // 报告ID：14
-        0x09, 0x67, //     USAGE (FullChargeCapacity) // 用途：充满电容量
-        0xB1, 0x83, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失-可能变化）
-
-        // --- 设计容量 (Report ID 23) ---
-        0x85, HID_PD_DESIGNCAPACITY, // REPORT_ID (23) // 报告ID：23
-        0x09, 0x83, //     USAGE (DesignCapacity)    // 用途：设计容量（标称值）
-        0xB1, 0x83, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-    // ==================== 电池容量与状态数据 ====================
-        // --- 剩余容量 (Report ID 12) ---
-        0x85, HID_PD_REMAININGCAPACITY, // REPORT_ID (12) // 报告ID：12
-        0x09, 0x66, //     USAGE (RemainingCapacity) // 用途：剩余容量
-        0x81, 0xA3, //     INPUT (Const, Var, Abs)   // 输入报告（常量）
-        0x09, 0x66, //     USAGE (RemainingCapacity)
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 警告容量限制 (Report ID 15) ---
-        0x85, HID_PD_WARNCAPACITYLIMIT, // REPORT_ID (15) // 报告ID：15
-        0x09, 0x8C, //     USAGE (WarningCapacityLimit) // 用途：低电量警告阈值
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-        // --- 剩余容量限制 (Report ID 17) ---
-        0x85, HID_PD_REMNCAPACITYLIMIT, // REPORT_ID (17) // 报告ID：17
-        0x09, 0x29, //     USAGE (RemainingCapacityLimit) // 用途：剩余容量限制阈值
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-    // ==================== 时间相关数据 ====================
-        // --- 生产日期 (Report ID 9) ---
-        0x85, HID_PD_MANUFACTUREDATE, // REPORT_ID (9) // 报告ID：9
-        0x09, 0x85, //     USAGE (ManufacturerDate)  // 用途：生产日期
-        0x75, 0x10, //     REPORT_SIZE (16)         // 字段大小改为16位
-        0x27, 0xFF, 0xFF, 0x00, 0x00, // LOGICAL_MAXIMUM (65534) // 逻辑最大值
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 平均充满时间 (Report ID 26) ---
-        0x85, HID_PD_AVERAGETIME2FULL, // REPORT_ID (26) // 报告ID：26
-        0x09, 0x6A, //     USAGE (AverageTimeToFull) // 用途：预估充满所需时间
-        0x27, 0xFF, 0xFF, 0x00, 0x00, // LOGICAL_MAXIMUM (65534) // 逻辑最大值
-        0x66, 0x01, 0x10, //     UNIT (Seconds)      // 单位：秒
-        0x55, 0x00, //     UNIT_EXPONENT (0)         // 单位指数：0 (10^0 = 1)
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 平均耗尽时间 (Report ID 28) ---
-        0x85, HID_PD_AVERAGETIME2EMPTY, // REPORT_ID (28) // 报告ID：28
-        0x09, 0x69, //     USAGE (AverageTimeToEmpty)  // 用途：预估耗尽所需时间
-        0x81, 0xA3, //     INPUT (Const, Var, Abs)    // 输入报告（常量）
-        0x09, 0x69, //     USAGE (AverageTimeToEmpty)
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 运行至耗尽时间 (Report ID 13) ---
-        0x85, HID_PD_RUNTIMETOEMPTY, // REPORT_ID (13) // 报告ID：13
-        0x09, 0x68, //     USAGE (RunTimeToEmpty)     // 用途：运行至耗尽时间
-        0x81, 0xA3, //     INPUT (Const, Var, Abs)    // 输入报告（常量）
-        0x09, 0x68, //     USAGE (RunTimeToEmpty)
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 剩余时间限制 (Report ID 8) ---
-        0x85, HID_PD_REMAINTIMELIMIT, // REPORT_ID (8) // 报告ID：8
-        0x09, 0x2A, //     USAGE (RemainingTimeLimit) // 用途：剩余时间限制（可设置）
-        0x75, 0x10, //     REPORT_SIZE (16)          // 字段大小：16位
-        0x27, 0x64, 0x05, 0x00, 0x00, // LOGICAL_MAXIMUM (1380) // 逻辑最大值：1380分钟（23小时）
-        0x16, 0x78, 0x00, //     LOGICAL_MINIMUM (120) // 逻辑最小值：120分钟（2小时）
-        0x81, 0x22, //     INPUT (Data, Var, Abs)     // 输入报告（数据，可设置）
-        0x09, 0x2A, //     USAGE (RemainingTimeLimit)
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-    // ==================== 电源设备控制与状态 ====================
-    // 切换回电源设备用途页面，定义UPS特定控制
-        0x05, 0x84, //     USAGE_PAGE (Power Device) // 用途页面：电源设备
-
-        // --- 关机前延迟 (Report ID 18) ---
-        0x85, HID_PD_DELAYBE4SHUTDOWN, // REPORT_ID (18) // 报告ID：18
-        0x09, 0x57, //     USAGE (DelayBeforeShutdown) // 用途：关机前延迟时间
-        0x16, 0x00, 0x80, // LOGICAL_MINIMUM (-32768) // 逻辑最小值：-32768
-        0x27, 0xFF, 0x7F, 0x00, 0x00, // LOGICAL_MAXIMUM (32767) // 逻辑最大值：32767
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-        // --- 重启前延迟 (Report ID 19) ---
-        0x85, HID_PD_DELAYBE4REBOOT, // REPORT_ID (19) // 报告ID：19
-        0x09, 0x55, //     USAGE (DelayBeforeReboot)  // 用途：重启前延迟时间
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-        // --- 配置电压 (Report ID 10) ---
-        0x85, HID_PD_CONFIGVOLTAGE, // REPORT_ID (10) // 报告ID：10
-        0x09, 0x40, //     USAGE (ConfigVoltage)      // 用途：配置/额定电压
-        0x15, 0x00, //     LOGICAL_MINIMUM (0)       // 逻辑最小值：0
-        0x27, 0xFF, 0xFF, 0x00, 0x00, // LOGICAL_MAXIMUM (65535) // 逻辑最大值：65535
-        0x67, 0x21, 0xD1, 0xF0, 0x00, // UNIT (Centivolts) // 单位：百分之一伏特 (cV)
-        0x55, 0x05, //     UNIT_EXPONENT (5)         // 单位指数：5 (10^5, 结合单位cV，实际为V * 1000)
-        0xB1, 0x23, //     FEATURE (Const, Var, Abs, NonVol) // 特性报告（常量，非易失）
-
-        // --- 当前电压 (Report ID 11) ---
-        0x85, HID_PD_VOLTAGE, // REPORT_ID (11) // 报告ID：11
-        0x09, 0x30, //     USAGE (Voltage)           // 用途：当前电压
-        0x81, 0xA3, //     INPUT (Const, Var, Abs)   // 输入报告（常量）
-        0x09, 0x30, //     USAGE (Voltage)
-        0xB1, 0xA3, //     FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        // --- 声音警报控制 (Report ID 20) ---
-        0x85, HID_PD_AUDIBLEALARMCTRL, // REPORT_ID (20) // 报告ID：20
-        0x09, 0x5A, //     USAGE (AudibleAlarmControl) // 用途：声音警报控制
-        0x75, 0x08, //     REPORT_SIZE (8)           // 字段大小改回8位
-        0x15, 0x01, //     LOGICAL_MINIMUM (1)       // 逻辑最小值：1
-        0x25, 0x03, //     LOGICAL_MAXIMUM (3)       // 逻辑最大值：3（可能代表关/开/静音等状态）
-        0x65, 0x00, //     UNIT (0)                  // 单位：无
-        0x55, 0x00, //     UNIT_EXPONENT (0)         // 单位指数：0
-        0x81, 0x22, //     INPUT (Data, Var, Abs)    // 输入报告（数据，可设置）
-        0x09, 0x5A, //     USAGE (AudibleAlarmControl)
-        0xB1, 0xA2, //     FEATURE (Data, Var, Abs, Vol) // 特性报告（数据，易失-可设置）
-
-    // ==================== 状态位集合 (重要！) ====================
-    // 这是一个位图集合，每个位代表一个不同的状态标志
-        0x09, 0x02, //     USAGE (PresentStatus)     // 用途：当前状态
-        0xA1, 0x02, //     COLLECTION (Logical)     // 开始一个逻辑集合（状态位集合）
-        0x85, HID_PD_PRESENTSTATUS, // REPORT_ID (7) // 报告ID：7
-        0x05, 0x85, //       USAGE_PAGE (Battery System) // 用途页面：电池系统（用于电池状态位）
-        0x75, 0x01, //       REPORT_SIZE (1)        // 每个字段大小为1位（标志位）
-        0x15, 0x00, //       LOGICAL_MINIMUM (0)    // 逻辑最小值：0 (False)
-        0x25, 0x01, //       LOGICAL_MAXIMUM (1)    // 逻辑最大值：1 (True)
-
-        // 以下每个USAGE定义一个状态标志位，INPUT和FEATURE报告各有一个
-        0x09, 0x44, //       USAGE (Charging)        // 正在充电
-        0x81, 0xA3, //       INPUT (Const, Var, Abs) // 输入报告（常量）
-        0x09, 0x44, //       USAGE (Charging)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol) // 特性报告（常量，易失）
-
-        0x09, 0x45, //       USAGE (Discharging)     // 正在放电
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x45, //       USAGE (Discharging)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0xD0, //       USAGE (ACPresent)       // AC电源 present/连接
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0xD0, //       USAGE (ACPresent)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0xD1, //       USAGE (BatteryPresent)  // 电池 present/安装
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0xD1, //       USAGE (BatteryPresent)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x42, //       USAGE (BelowRemainingCapacityLimit) // 低于剩余容量限制
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x42, //       USAGE (BelowRemainingCapacityLimit)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x43, //       USAGE (RemainingTimeLimitExpired) // 剩余时间限制已过期
-        0x81, 0xA2, //       INPUT (Data, Var, Abs)  // 注意：这个是Data，可能主机可写？
-        0x09, 0x43, //       USAGE (RemainingTimeLimitExpired)
-        0xB1, 0xA2, //       FEATURE (Data, Var, Abs, Vol)
-
-        0x09, 0x4B, //       USAGE (NeedReplacement) // 需要更换电池
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x4B, //       USAGE (NeedReplacement)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0xDB, //       USAGE (VoltageNotRegulated) // 电压未调节（异常）
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0xDB, //       USAGE (VoltageNotRegulated)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x46, //       USAGE (FullyCharged)    // 已充满
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x46, //       USAGE (FullyCharged)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x47, //       USAGE (FullyDischarged) // 已放空
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x47, //       USAGE (FullyDischarged)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        // 切换回电源设备用途页面（用于UPS特定状态位）
-        0x05, 0x84, //       USAGE_PAGE (Power Device)
-
-        0x09, 0x68, //       USAGE (ShutdownRequested) // 已请求关机
-        0x81, 0xA2, //       INPUT (Data, Var, Abs)    // 数据（可能由主机触发）
-        0x09, 0x68, //       USAGE (ShutdownRequested)
-        0xB1, 0xA2, //       FEATURE (Data, Var, Abs, Vol)
-
-        0x09, 0x69, //       USAGE (ShutdownImminent) // 关机即将发生（最终警告）
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x69, //       USAGE (ShutdownImminent)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x73, //       USAGE (CommunicationLost) // 与UPS通信丢失
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x73, //       USAGE (CommunicationLost)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        0x09, 0x65, //       USAGE (Overload)         // 过载
-        0x81, 0xA3, //       INPUT (Const, Var, Abs)
-        0x09, 0x65, //       USAGE (Overload)
-        0xB1, 0xA3, //       FEATURE (Const, Var, Abs, Vol)
-
-        // --- 填充位和对齐 ---
-        // 前面的状态位可能不是8的整数倍，这里添加填充位使整个报告按字节对齐
-        0x95, 0x02, //       REPORT_COUNT (2)        // 2个填充位
-        0x81, 0x01, //       INPUT (Constant, Array) // 输入报告（常量，数组-填充用）
-        0xB1, 0x01, //       FEATURE (Constant, Array, NonVol) // 特性报告（常量，数组，非易失-填充用）
-
-        0xC0,       //     END_COLLECTION // 结束 状态位逻辑集合
-    // ==================== 结束集合 ====================
-        0xC0,       //   END_COLLECTION // 结束 信息类逻辑集合
-    0xC0        // END_COLLECTION // 结束 根应用集合
-};
+// 由 ups_report_schema.h 的结构表生成（ups_report_descriptor()，ups_report_init 中生成），与报告负载长度同源，
+// 长度 UPS_HID_REPORT_DESCRIPTOR_LEN 是编译期常量。
+// CONFIG_UPS_INSTANCE_COUNT 个电池实例各占一个应用集合、按报告ID分段，共用这一个 HID 接口和中断端点
 
 // A.1 Device Descriptor  USB设备描述符 
 tusb_desc_device_t descriptor_dev = {
     .bLength = sizeof(tusb_desc_device_t),  //Numeric expression specifying the size of this descriptor.
     .bDescriptorType = TUSB_DESC_DEVICE,   //Device descriptor type (assigned by USB).
     .bcdUSB = 0x0200,       //USB HID Specification Release 1.0
-    .bDeviceClass = 0x00,   //Class code (assigned by USB). Note that the HID class is defined in the Interface descriptor.
-    .bDeviceSubClass = 0x00,  //Subclass code (assigned by USB). These codes are qualified by the value of the bDeviceClass field.
-    .bDeviceProtocol = 0x00,  //Protocol code. These codes are qualified by the value of the bDeviceSubclass field
+    .bDeviceClass = TUSB_CLASS_MISC,    //Class code: Miscellaneous，复合设备（HID + CDC），CDC 的两个接口由 IAD 关联
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,  //Subclass code: Common Class
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,     //Protocol code: Interface Association Descriptor
     .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,  //Maximum packet size for endpoint zero (only 8, 16, 32, or 64 are valid).
     .idVendor = 0x04d8,    //Vendor ID (assigned by USB).
     .idProduct = 0xd005,   //Product ID (assigned by manufacturer).
@@ -636,8 +74,8 @@ const uint8_t hid_interface_desc[] = {
     0x00,                    // bCountryCode, Hardware target country.
     0x01,                    // bNumDescriptors, Number of HID class descriptors to follow
     0x22,                    // bDescriptorType (Report),Report descriptor type.
-    LO8(sizeof(hid_report_descriptor)),  // wDescriptorLength (low), Total length of Report descriptor.
-    HI8(sizeof(hid_report_descriptor)),  // wDescriptorLength (high)
+    LO8(UPS_HID_REPORT_DESCRIPTOR_LEN),  // wDescriptorLength (low), Total length of Report descriptor.
+    HI8(UPS_HID_REPORT_DESCRIPTOR_LEN),  // wDescriptorLength (high)
     
     // A.4 Endpoint Descriptor
     0x07,                    // bLength, Size of this descriptor in bytes.
@@ -661,8 +99,16 @@ const uint8_t hid_interface_desc[] = {
     0x0A                     // bInterval (10ms) , Interval for polling endpoint for data transfers, expressed in milliseconds.
 };
 
+// CDC-ACM 控制台（接口1-2）：通知端点 0x82，数据端点 OUT 0x03 / IN 0x83。
+// ESP32-S3 最多5个 IN 端点（含 EP0），HID + 一个 CDC 已用4个，控制台和遥测导出共用这一个 CDC
+#define ICDC_CONSOLE                0x06
+#define ITF_NUM_CDC_CONSOLE         1
+#define EPNUM_CDC_CONSOLE_NOTIF     0x82
+#define EPNUM_CDC_CONSOLE_OUT       0x03
+#define EPNUM_CDC_CONSOLE_IN        0x83
+
 // A.2 Configuration Descriptor  配置描述符
-#define TUSB_DESC_TOTAL_LEN (TUD_CONFIG_DESC_LEN + sizeof(hid_interface_desc))
+#define TUSB_DESC_TOTAL_LEN (TUD_CONFIG_DESC_LEN + sizeof(hid_interface_desc) + TUD_CDC_DESC_LEN)
 uint8_t const desc_configuration[] = {
 
     // 配置描述符，具体配置顺序由宏自行调配
@@ -670,7 +116,7 @@ uint8_t const desc_configuration[] = {
         // bLength          由宏自动生成
         // bDescriptorType  由宏自动生成
         1,      // bConfigurationValue , Value to use as an argument to Set Configuration to select this configuration.
-        1,      // bNumInterfaces ,Number of interfaces supported by this configuration.
+        3,      // bNumInterfaces ,Number of interfaces supported by this configuration. HID + CDC（控制+数据）
         0,      // iConfiguration , Index of string descriptor describing this configuration.
         TUSB_DESC_TOTAL_LEN, // wTotalLength 
         // Total length of data returned for this configuration.
@@ -696,7 +142,11 @@ uint8_t const desc_configuration[] = {
     hid_interface_desc[15], hid_interface_desc[16], hid_interface_desc[17],
     hid_interface_desc[18], hid_interface_desc[19], hid_interface_desc[20],
     hid_interface_desc[21], hid_interface_desc[22], hid_interface_desc[23],
-    hid_interface_desc[24]
+    hid_interface_desc[24],
+
+    // CDC-ACM 控制台（IAD + 控制接口 + 数据接口）
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_CONSOLE, ICDC_CONSOLE, EPNUM_CDC_CONSOLE_NOTIF, 8,
+                       EPNUM_CDC_CONSOLE_OUT, EPNUM_CDC_CONSOLE_IN, 64)
 };
 
 // 字符串描述符
@@ -706,13 +156,14 @@ const char* descriptor_str[] = {
     [IPRODUCT] = "DHG.UPS",
     [ISERIAL] = "383503417",
     [IDEVICECHEMISTRY] = "Li-ion",
-    [IOEMVENDOR] = "DHG"
+    [IOEMVENDOR] = "DHG",
+    [ICDC_CONSOLE] = "DHG.UPS Console"
 };
 
 // TinyUSB回调函数
 uint8_t const* tud_hid_descriptor_report_cb(uint8_t instance) {
     // ESP_LOGI(TAG, "return hid_report_descriptor;");
-    return hid_report_descriptor;
+    return ups_report_descriptor(NULL);
 }
 
 
@@ -732,302 +183,42 @@ uint8_t const* tud_hid_descriptor_report_cb(uint8_t instance) {
 uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id,
                                hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen) 
 {
-    // ESP_LOGI(TAG, "Get report: ID=0x%02X, Type=%d, ReqLen=%d", report_id, report_type, reqlen);
-
-    // 只处理Feature Report（类型3）
-    if (report_type != HID_REPORT_TYPE_FEATURE) {
-        ESP_LOGW(TAG, "Unsupported report type: %d", report_type);
-        return 0;
-    }
-
-    // 根据报告ID返回相应的数据
-    switch (report_id) {
-        case HID_PD_IPRODUCT: // REPORT_ID (1)
-            if (reqlen >= 1) {
-                buffer[0] = IPRODUCT; // 字符串索引
-                return 1;
-            }
-            break;
-
-        case HID_PD_SERIAL: // REPORT_ID (2)
-            if (reqlen >= 1) {
-                buffer[0] = ISERIAL; // 字符串索引
-                return 1;
-            }
-            break;
-
-        case HID_PD_MANUFACTURER: // REPORT_ID (3)
-            if (reqlen >= 1) {
-                buffer[0] = IMANUFACTURER; // 字符串索引
-                return 1;
-            }
-            break;
-
-        case HID_PD_RECHARGEABLE: // REPORT_ID (6)
-            if (reqlen >= 1) {
-                buffer[0] = 0x01; // 可充电：是
-                return 1;
-            }
-            break;
-        
-        // [0x07] - [Every 2s] 当前状态 (PresentStatus)
-        case HID_PD_PRESENTSTATUS: // REPORT_ID (7)
-            if (reqlen >= 2) {
-                // 当前状态（位字段）
-                // UPS.Charging = 1;        // 充电状态
-                // UPS.Discharging = 0;     // 放电状态
-                // UPS.ACPresent = 1;       // AC状态
-                // UPS.BatteryPresent = 1;  // 电池存在状态
-                // UPS.FullyCharged = 0;    // 充满状态
-                
-                // 将结构体内容拷贝到缓冲区
-                memcpy(buffer, &UPS, 2);
-                return 2;
-            }
-            break;
-
-        case HID_PD_MANUFACTUREDATE: // REPORT_ID (9)
-            if (reqlen >= 2) {
-                // 生产日期（自1990-01-01的天数）
-                buffer[0] = manufacture_date & 0xFF;
-                buffer[1] = (manufacture_date >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        case HID_PD_CONFIGVOLTAGE: // REPORT_ID (10)
-            if (reqlen >= 2) {
-                // 配置电压（单位：厘伏，指数5 = 10^-5伏）
-                buffer[0] = config_voltage & 0xFF;
-                buffer[1] = (config_voltage >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-        
-        // [0x0B] - [Every 2s] 电压测量 (Voltage)
-        case HID_PD_VOLTAGE: // REPORT_ID (11)
-            if (reqlen >= 2) {
-                // 当前电压（单位：厘伏，指数5 = 10^-5伏）
-                buffer[0] = voltage & 0xFF;
-                buffer[1] = (voltage >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        // [0x0C] - [Every 2s] 剩余容量 (RemainingCapacity) 
-        case HID_PD_REMAININGCAPACITY: // REPORT_ID (12)
-            if (reqlen >= 1) {
-                // 剩余容量（单位：%）
-                buffer[0] = remaining_capacity;
-                return 1;
-            }
-            break;
-        
-        // [0x0D] - [Every 2s] 运行至空时间 (RunTimeToEmpty) 
-        case HID_PD_RUNTIMETOEMPTY: // REPORT_ID (13)
-            if (reqlen >= 2) {
-                // 运行至空的时间（分钟）
-                buffer[0] = runtime_to_empty & 0xFF;
-                buffer[1] = (runtime_to_empty >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        case HID_PD_FULLCHARGECAPACITY: // REPORT_ID (14)
-            if (reqlen >= 2) {
-                // 充满电容量（单位：%）
-                buffer[0] = full_charge_capacity & 0xFF;
-                buffer[1] = (full_charge_capacity >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        // [0x0F] - [Every 30s] 警告容量限制 (WarningCapacityLimit)
-        case HID_PD_WARNCAPACITYLIMIT: // REPORT_ID (15)
-            if (reqlen >= 1) {
-                // 警告容量限制（百分比）
-                buffer[0] = 20; // 示例值：20%
-                return 1;
-            }
-            break;
-
-        case HID_PD_CPCTYGRANULARITY1: // REPORT_ID (16)
-            if (reqlen >= 1) {
-                // 容量粒度1（百分比）
-                buffer[0] = 1; // 示例值：1%
-                return 1;
-            }
-            break;
-        
-        // [0x11] - [Every 2s] 剩余容量限制 (RemainingCapacityLimit)
-        case HID_PD_REMNCAPACITYLIMIT: // REPORT_ID (17)
-            if (reqlen >= 1) {
-                // 剩余容量限制（百分比）
-                buffer[0] = 10; // 示例值：10%
-                return 1;
-            }
-            break;
-
-        case HID_PD_DELAYBE4SHUTDOWN: // REPORT_ID (18)
-            if (reqlen >= 2) {
-                // 关机前延迟（秒）
-                buffer[0] = delay_before_shutdown & 0xFF;
-                buffer[1] = (delay_before_shutdown >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        case HID_PD_DELAYBE4REBOOT: // REPORT_ID (19)
-            if (reqlen >= 2) {
-                // 重启前延迟（秒）
-                buffer[0] = delay_before_reboot & 0xFF;
-                buffer[1] = (delay_before_reboot >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        case HID_PD_AUDIBLEALARMCTRL: // REPORT_ID (20)
-            if (reqlen >= 1) {
-                // 声音报警控制（1-3）
-                buffer[0] = 2; // 示例值：启用
-                return 1;
-            }
-            break;
-
-        case HID_PD_CAPACITYMODE: // REPORT_ID (22)
-            if (reqlen >= 1) {
-                // 容量模式
-                buffer[0] = 0x01; // 示例值：相对模式
-                return 1;
-            }
-            break;
-        
-        // [0x17] - [Only Init] 设计容量 (DesignCapacity)
-        case HID_PD_DESIGNCAPACITY: // REPORT_ID (23)
-            if (reqlen >= 1) {
-                // 设计容量（单位：%）
-                buffer[0] = design_capacity;
-                return 1;
-            }
-            break;
-
-        case HID_PD_CPCTYGRANULARITY2: // REPORT_ID (24)
-            if (reqlen >= 1) {
-                // 容量粒度2
-                buffer[0] = 0x00; // 示例值：未定义
-                return 1;
-            }
-            break;
-
-        case HID_PD_AVERAGETIME2FULL: // REPORT_ID (26)
-            if (reqlen >= 2) {
-                // 平均充满时间（秒）
-                buffer[0] = avg_time_to_full & 0xFF;
-                buffer[1] = (avg_time_to_full >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        case HID_PD_AVERAGETIME2EMPTY: // REPORT_ID (28)
-            if (reqlen >= 2) {
-                // 平均放空时间（秒）
-                buffer[0] = avg_time_to_empty & 0xFF;
-                buffer[1] = (avg_time_to_empty >> 8) & 0xFF;
-                return 2;
-            }
-            break;
-
-        // [0x1F] - [Only Init] 设备化学类型 (iDeviceChemistry) 
-        case HID_PD_IDEVICECHEMISTRY: // REPORT_ID (31)
-            if (reqlen >= 1) {
-                // 设备化学类型字符串索引
-                buffer[0] = IDEVICECHEMISTRY;
-                return 1;
-            }
-            break;
-
-        // [0x20] - OEM信息 (iOEMInformation) [Every 30s]
-        case HID_PD_IOEMINFORMATION: // REPORT_ID (32)
-            if (reqlen >= 1) {
-                // OEM信息字符串索引
-                buffer[0] = IOEMVENDOR;
-                return 1;
-            }
-            break;
-
-        default:
-            ESP_LOGW(TAG, "Unknown feature report ID: 0x%02X", report_id);
-            return 0;
-    }
-
-    ESP_LOGW(TAG, "Request length too short for report ID: 0x%02X", report_id);
-    return 0;
+    return ups_hid_get_report(instance, report_id, report_type, buffer, reqlen);
 }
 
 void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id,
                            hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize) 
 {
-    ESP_LOGI(TAG, "Set report: ID=0x%02X, Type=%u, Size=%u", report_id, report_type, bufsize);
+    ups_hid_set_report(instance, report_id, report_type, buffer, bufsize);
+}
 
-    if (report_type != HID_REPORT_TYPE_FEATURE || bufsize < 1) {
-        return;
-    }
+// TinyUSB回调：中断IN传输完成
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_t len) {
+    ups_hid_report_complete(instance);
+}
 
-    uint8_t const* data = buffer + 1;
-    uint16_t data_size = bufsize - 1;
-
-    switch(report_id) {
-        // ==================== Report ID 1: 主交流输入配置 ====================
-        case 0x01: // 主交流输入配置
-            if (data_size >= 4) {
-                uint8_t config_voltage = data[2];
-                uint8_t config_frequency = data[3];
-                ESP_LOGI(TAG, "AC Input Config - Voltage:%dV, Frequency:%dHz", 
-                        config_voltage * 128, config_frequency);
-                // 硬件控制代码
-            }
-            break;
-
-        // ==================== Report ID 2: 备份直流流配置 ====================
-        case 0x02: // 备份直流流配置
-            if (data_size >= 5) {
-                uint16_t config_voltage = (data[3] << 8) | data[2];
-                ESP_LOGI(TAG, "DC Backup Config - Voltage:%dmV", config_voltage * 32);
-                // 硬件控制代码
-            }
-            break;
-
-        case 0x03: // 输出交流流配置
-            if (data_size >= 6) {
-                uint8_t config_voltage = data[2];
-                uint8_t config_frequency = data[3];
-                uint16_t config_apparent_power = (data[5] << 8) | data[4];
-                ESP_LOGI(TAG, "AC Output Config - Voltage:%dV, Freq:%dHz, Power:%dVA", 
-                        config_voltage * 128, config_frequency, config_apparent_power * 128);
-                // 硬件控制代码
-            }
-            break;
+// TinyUSB回调：设备枚举完成
+void tud_mount_cb(void) {
+    ups_power_resume();
+    ups_hid_mount();
+}
 
-        case 0x06: // 电池配置
-            if (data_size >= 11) {
-                uint16_t config_voltage = (data[6] << 8) | data[5];
-                ESP_LOGI(TAG, "Battery Config - Voltage:%dmV", config_voltage * 32);
-                // 硬件控制代码
-            }
-            break;
+// TinyUSB回调：设备断开
+void tud_umount_cb(void) {
+    ups_power_resume();
+    ups_hid_unmount();
+}
 
-        case 0x0B: // 电源摘要配置
-            if (data_size >= 28) {
-                uint16_t config_voltage = (data[16] << 8) | data[15];
-                ESP_LOGI(TAG, "Power Summary Config - Voltage:%dmV", config_voltage * 32);
-                // 硬件控制代码
-            }
-            break;
+// TinyUSB回调：总线挂起（主机休眠或选择性挂起），释放电源锁后空闲时进入 light sleep
+void tud_suspend_cb(bool remote_wakeup_en) {
+    ups_hid_suspend(remote_wakeup_en);
+    ups_power_suspend();
+}
 
-        default:
-            ESP_LOGW(TAG, "Unknown report ID: 0x%02X", report_id);
-            break;
-    }
+// TinyUSB回调：总线恢复（主机唤醒或远程唤醒之后）
+void tud_resume_cb(void) {
+    ups_power_resume();
+    ups_hid_resume();
 }
 
 uint8_t tud_hid_get_protocol_cb(uint8_t instance) {
@@ -1035,65 +226,51 @@ uint8_t tud_hid_get_protocol_cb(uint8_t instance) {
 }
 
 void tud_hid_set_protocol_cb(uint8_t instance, uint8_t protocol) {
-    ESP_LOGI(TAG, "Protocol set to: %u", protocol);
+    ups_hid_set_protocol(instance, protocol);
 }
 
-// 更新UPS状态
-static void update_ups_state(void) {
-    // 模拟AC电源断开/连接（60秒切换一次）
-    static uint32_t ac_timer = 0;
-    if (xTaskGetTickCount() - ac_timer > pdMS_TO_TICKS(60000)) {
-        UPS.ACPresent ^= 1;   //每次翻转
-        ac_timer = xTaskGetTickCount();
-        
-        if (UPS.ACPresent) {
-            UPS.Charging = 1;
-            UPS.Discharging = 0;
-            ESP_LOGI(TAG, "AC Connected - Charging");
-        } else {
-            UPS.Charging = 0;
-            UPS.Discharging = 1;
-            ESP_LOGI(TAG, "AC Disconnected - Discharging");
+// 延迟日志任务：格式化并输出USB回调写入的二进制记录
+static void log_task(void* arg) {
+    ups_log_record_t record;
+    char line[112];
+    uint32_t dropped_reported = 0;
+    bool boot_reported = false;
+
+    while (1) {
+        // 启动计时：各阶段到齐（或10秒后仍没有主机）时输出一次
+        if (!boot_reported && (ups_boot_complete() || pdTICKS_TO_MS(xTaskGetTickCount()) > 10000)) {
+            uint32_t valid_us;
+            ups_boot_format(line, sizeof(line));
+            if (ups_boot_time_us(UPS_BOOT_FIRST_VALID_REPORT, &valid_us) && valid_us <= UPS_BOOT_BUDGET_MS * 1000) {
+                ESP_LOGI(TAG, "Boot: %s", line);
+            } else {
+                ESP_LOGW(TAG, "Boot: %s (budget %d ms)", line, UPS_BOOT_BUDGET_MS);
+            }
+            boot_reported = true;
         }
-    }
 
-    // 模拟电池容量变化
-    if (UPS.Charging && remaining_capacity < 100) {
-        remaining_capacity++;
-        if (remaining_capacity >= 100) {
-            UPS.FullyCharged = 1;
-            UPS.Charging = 0;
+        while (ups_log_pop(&record)) {
+            ups_log_format(&record, line, sizeof(line));
+            if (record.event == UPS_LOG_SET || record.event == UPS_LOG_SET_PROTOCOL ||
+                record.event == UPS_LOG_MOUNT || record.event == UPS_LOG_UNMOUNT ||
+                record.event == UPS_LOG_SUSPEND || record.event == UPS_LOG_RESUME ||
+                record.event == UPS_LOG_REMOTE_WAKEUP) {
+                ESP_LOGI(TAG, "%s", line);
+            } else {
+                ESP_LOGW(TAG, "%s", line);
+            }
         }
-    } else if (UPS.Discharging && remaining_capacity > 0) {
-        remaining_capacity--;
-        UPS.FullyCharged = 0;
-        if (remaining_capacity <= 15) {
-            UPS.FullyDischarged = 15;
+
+        uint32_t dropped = ups_log_dropped();
+        if (dropped != dropped_reported) {
+            ESP_LOGW(TAG, "Log ring dropped %u records", (unsigned)(dropped - dropped_reported));
+            dropped_reported = dropped;
         }
+        vTaskDelay(pdMS_TO_TICKS(100));
     }
-
-    // 更新剩余时间
-    runtime_to_empty = (remaining_capacity * 72) ;
-
-    ESP_LOGI(TAG, "ACPresent: %d, Charging: %d, Discharging: %d, FullyCharged: %d, RemainingCapacity: %d%%",
-        UPS.ACPresent, UPS.Charging, UPS.Discharging, UPS.FullyCharged, remaining_capacity);
-
-// uint16_t manufacture_date = 12345;      // 生产日期（自1990-01-01的天数）
-// uint16_t config_voltage = 12000;        // 配置电压, 指数5 = 10^-5伏  示例值：120.00V   
-// uint16_t voltage = 11850;               // 当前电压, 指数5 = 10^-5伏, 示例值：118.50V  
-// uint8_t remaining_capacity = 85;        // 剩余容量, 示例值：85.00%
-// uint16_t runtime_to_empty = 3600;       // 运行至空的时间, 示例值：60分钟
-// uint16_t full_charge_capacity = 10000;  // 充满电容量, 示例值：100.00%
-// uint8_t warring_capacity_limit = 20;    // 警告容量限制,示例值：20.00%
-// uint8_t remaining_capacity_limit = 10;  // 剩余容量限制,示例值：10.00%
-// int16_t delay_before_shutdown = 300;    // 关机前延迟（秒）,示例值：300秒
-// int16_t delay_before_reboot = 60;       // 重启前延迟（秒）, 示例值：60秒
-// uint16_t design_capacity = 100;         // 设计容量（单位：%）, 示例值：100.00%
-// uint16_t avg_time_to_full = 7200;       // 平均充满时间（秒）, 示例值：2小时
-// uint16_t avg_time_to_empty = 14400;     // 平均放空时间（秒）, 示例值：4小时
 }
 
-// USB HID初始化
+// USB HID初始化：只安装驱动，不等待枚举，挂载/断开由 tud_mount_cb/tud_umount_cb 处理
 static void usb_hid_init(void) {
     const tinyusb_config_t tusb_cfg = {
         .device_descriptor = &descriptor_dev,
@@ -1104,34 +281,44 @@ static void usb_hid_init(void) {
     };
 
     ESP_ERROR_CHECK(tinyusb_driver_install(&tusb_cfg));
-    ESP_LOGI(TAG, "TinyUSB initialized");
-
-    while (!tud_mounted()) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-    ESP_LOGI(TAG, "USB connected");
+    ups_boot_mark(UPS_BOOT_USB_INSTALLED);
 }
 
 // 主函数
+// 启动顺序按首份有效报告的关键路径排列：报告表 -> ADC -> USB，NVS和日志在后台并行
 void app_main(void) {
-    ESP_LOGI(TAG, "UPS Device starting");
+    ups_boot_mark(UPS_BOOT_APP_START);
 
-    // 初始化NVS
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
-        ESP_ERROR_CHECK(nvs_flash_erase());
-        ret = nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(ret);
+    // 初始化UPS状态和报告表（主机枚举后立即可读）
+    ups_state_init();
+    ups_journal_post(UPS_JOURNAL_BOOT, (uint8_t)esp_reset_reason(), PresentStatus_to_uint16(&UPS), 0);
+
+#if CONFIG_UPS_BENCH_ON_BOOT
+    // 回调基准测试（在USB初始化之前运行，不受主机请求干扰）
+    ups_bench_run(CONFIG_UPS_BENCH_ROUNDS);
+#endif
+
+    // 电源管理：调频范围和总线活动锁，在USB驱动安装之前持有
+    ups_power_start();
 
-    // 初始化USB HID
+    // ADC采集（未启用时使用模拟电池数据），第一帧在USB枚举期间就绪
+    ups_adc_start();
+
+    // 初始化USB HID，枚举与后面的初始化并行进行
     usb_hid_init();
-    
-    // 主循环
-    while (1) {
-        update_ups_state();
-        vTaskDelay(pdMS_TO_TICKS(2000));
-    }
+
+    // CDC 控制台（含遥测导出），低优先级任务处理命令
+    ups_console_start();
+
+    // NVS在后台初始化，加载电池学习参数后负责持久化写入
+    ups_store_start();
+
+    // 低优先级日志任务
+    xTaskCreate(log_task, "ups_log", 3072, NULL, tskIDLE_PRIORITY + 1, NULL);
+
+    // 事件驱动的状态任务：ADC 新数据、市电变化、GPIO、USB枚举、关机编排和2秒定时器投递事件，
+    // 空闲时无限期阻塞。第一份实测采样到达后立即发布，主机枚举后读到的就是实测快照
+    ups_event_start();
 }
 
 
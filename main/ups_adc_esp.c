@@ -0,0 +1,122 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "ups_port.h"
+#include "ups_sense.h"
+#include "ups_mains.h"
+#include "ups_event.h"
+#include "ups_adc_esp.h"
+
+#if CONFIG_UPS_ADC_SENSE
+#include "esp_adc/adc_continuous.h"
+
+static const char *TAG = "UPS_ADC";
+
+// 每帧128个采样（每通道32个，是抽取倍数的整数倍）。帧长决定市电检测的附加延迟，
+// 20kHz 时为 6.4ms，小于半个周期；驱动内部缓存两帧，DMA写一帧的同时消费任务处理另一帧（乒乓）
+#define ADC_FRAME_SAMPLES   128
+#define ADC_FRAME_BYTES     (ADC_FRAME_SAMPLES * UPS_SENSE_SAMPLE_BYTES)
+
+// ADC 满量程约 3100mV（12dB 衰减）
+#define ADC_FULL_SCALE_MV   3100
+#define ADC_MV_Q16(num, den) ((int32_t)(((int64_t)(num) << 16) / (den)))
+
+// 采集电路：电池电压 1/6 分压；电流检测 100mV/A，以 1650mV 为零点；市电检测为隔离后的交流信号
+static const ups_sense_config_t sense_config = {
+    .adc_channel = {
+        CONFIG_UPS_ADC_CH_BATTERY_V,
+        CONFIG_UPS_ADC_CH_BATTERY_I,
+        CONFIG_UPS_ADC_CH_LOAD_I,
+        CONFIG_UPS_ADC_CH_AC,
+    },
+    .offset_raw = { 0, 1650 * 4095 / ADC_FULL_SCALE_MV, 1650 * 4095 / ADC_FULL_SCALE_MV, 0 },
+    .gain_q16 = {
+        ADC_MV_Q16(ADC_FULL_SCALE_MV * 6, 4095),     // mV
+        ADC_MV_Q16(ADC_FULL_SCALE_MV * 10, 4095),    // mA
+        ADC_MV_Q16(ADC_FULL_SCALE_MV * 10, 4095),    // mA
+        ADC_MV_Q16(ADC_FULL_SCALE_MV, 4095),         // mV（检测端）
+    },
+    .channel_rate_hz = CONFIG_UPS_ADC_SAMPLE_FREQ_HZ / UPS_SENSE_CHANNELS,
+    .ac_line_ratio = CONFIG_UPS_ADC_AC_LINE_RATIO,
+};
+
+static adc_continuous_handle_t adc_handle;
+static TaskHandle_t adc_task_handle;
+
+// 一帧转换完成（中断上下文），只唤醒消费任务
+static bool IRAM_ATTR adc_conv_done(adc_continuous_handle_t handle,
+                                    const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(adc_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+// 消费任务：每次唤醒取走所有已完成的帧，整块交给 ups_sense 抽取。
+// 市电状态变化立即投递事件，新数据按 UPS_EVENT_SAMPLE_MS 合并投递
+static void adc_task(void *arg) {
+    static uint8_t frame[ADC_FRAME_BYTES];
+    uint32_t len = 0;
+    uint32_t mains_events = 0;
+    uint32_t sample_posted = ups_port_millis();
+    ups_mains_status_t mains;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (adc_continuous_read(adc_handle, frame, sizeof(frame), &len, 0) == ESP_OK) {
+            ups_sense_process(frame, len);
+        }
+        if (ups_mains_latest(&mains) && mains.events != mains_events) {
+            mains_events = mains.events;
+            ups_event_post(UPS_EVENT_MAINS);
+        }
+        if (ups_port_millis() - sample_posted >= UPS_EVENT_SAMPLE_MS) {
+            sample_posted = ups_port_millis();
+            ups_event_post(UPS_EVENT_SAMPLE);
+        }
+    }
+}
+
+void ups_adc_start(void) {
+    ups_sense_init(&sense_config);
+
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = ADC_FRAME_BYTES * 2,
+        .conv_frame_size = ADC_FRAME_BYTES,
+    };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc_handle));
+
+    adc_digi_pattern_config_t pattern[UPS_SENSE_CHANNELS];
+    for (int i = 0; i < UPS_SENSE_CHANNELS; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_12;
+        pattern[i].channel = sense_config.adc_channel[i];
+        pattern[i].unit = ADC_UNIT_1;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    adc_continuous_config_t dig_config = {
+        .pattern_num = UPS_SENSE_CHANNELS,
+        .adc_pattern = pattern,
+        .sample_freq_hz = CONFIG_UPS_ADC_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &dig_config));
+
+    // 消费任务放在 CPU0，与 TinyUSB 任务（CPU1）分开
+    xTaskCreatePinnedToCore(adc_task, "ups_adc", 3072, NULL, 5, &adc_task_handle, 0);
+
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_conv_done = adc_conv_done,
+    };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_handle, &callbacks, NULL));
+    ESP_ERROR_CHECK(adc_continuous_start(adc_handle));
+    ESP_LOGI(TAG, "ADC continuous sampling started: %d Hz", CONFIG_UPS_ADC_SAMPLE_FREQ_HZ);
+}
+
+#else
+
+void ups_adc_start(void) {
+}
+
+#endif
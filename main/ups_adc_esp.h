@@ -0,0 +1,6 @@
+#pragma once
+
+// ADC 连续转换（DMA）采集，结果由 ups_sense 换算后供状态任务读取
+
+// 配置 ADC 并启动消费任务（CONFIG_UPS_ADC_SENSE 关闭时为空操作）
+void ups_adc_start(void);
@@ -0,0 +1,80 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/stream_buffer.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "tinyusb.h"
+#include "tusb_cdc_acm.h"
+#include "ups_console.h"
+#include "ups_console_esp.h"
+
+static const char *TAG = "UPS_CONSOLE";
+
+// 一次生成一个 USB 满速包，导出编码器直接读环形缓冲和映射的闪存，不复制整份数据
+#define CONSOLE_CHUNK      64
+#define CONSOLE_FLUSH_MS   1000     // 主机停止读取时丢弃本次输出
+#define CONSOLE_RX_BUFSIZE 64
+
+static TaskHandle_t console_task_handle;
+static StreamBufferHandle_t console_rx;
+static ups_console_t console;
+
+// TinyUSB 任务中调用：只把收到的字节转入流缓冲并通知控制台任务，不解析命令
+static void console_rx_cb(int itf, cdcacm_event_t* event) {
+    uint8_t buf[16];
+    size_t rx_size;
+
+    while (tinyusb_cdcacm_read(itf, buf, sizeof(buf), &rx_size) == ESP_OK && rx_size > 0) {
+        xStreamBufferSend(console_rx, buf, rx_size, 0);
+    }
+    xTaskNotifyGive(console_task_handle);
+}
+
+// 控制台任务：优先级 1，低于状态任务（4）和 TinyUSB 任务（5），并固定在 CPU0（TinyUSB 在 CPU1），
+// 命令执行和输出生成不会推迟状态发布和 HID 控制传输的处理；发送 FIFO 满时阻塞等主机取走
+static void console_task(void* arg) {
+    uint8_t buf[CONSOLE_CHUNK];
+
+    while (1) {
+        if (!ups_console_busy(&console)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        // 输出进行中也处理输入（Ctrl-C 中止）
+        size_t got;
+        while ((got = xStreamBufferReceive(console_rx, buf, sizeof(buf), 0)) > 0) {
+            for (size_t i = 0; i < got; i++) {
+                ups_console_input(&console, buf[i]);
+            }
+        }
+        if (!ups_console_busy(&console)) {
+            continue;
+        }
+
+        size_t room = tud_cdc_n_write_available(TINYUSB_CDC_ACM_0);
+        if (room > 0) {
+            size_t n = ups_console_read(&console, buf, room < sizeof(buf) ? room : sizeof(buf));
+            tinyusb_cdcacm_write_queue(TINYUSB_CDC_ACM_0, buf, n);
+            if (ups_console_busy(&console)) {
+                continue;
+            }
+        }
+        if (tinyusb_cdcacm_write_flush(TINYUSB_CDC_ACM_0, pdMS_TO_TICKS(CONSOLE_FLUSH_MS)) != ESP_OK) {
+            tud_cdc_n_write_clear(TINYUSB_CDC_ACM_0);
+            ups_console_init(&console);
+            ESP_LOGW(TAG, "Host not reading, output dropped");
+        }
+    }
+}
+
+void ups_console_start(void) {
+    ups_console_init(&console);
+    console_rx = xStreamBufferCreate(CONSOLE_RX_BUFSIZE, 1);
+    xTaskCreatePinnedToCore(console_task, "ups_console", 3072, NULL, tskIDLE_PRIORITY + 1, &console_task_handle, 0);
+
+    const tinyusb_config_cdcacm_t acm_cfg = {
+        .usb_dev = TINYUSB_USBDEV_0,
+        .cdc_port = TINYUSB_CDC_ACM_0,
+        .callback_rx = console_rx_cb,
+    };
+    ESP_ERROR_CHECK(tusb_cdc_acm_init(&acm_cfg));
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// USB CDC-ACM 控制台（ups_console.h 的命令行，含遥测导出）。
+// 主机工具：components/ups_core/host/ups_export_main.c（导出）、ups_hidlat_main.c（CDC 满负载下的 HID 延迟）
+
+// 注册 CDC 接收回调并创建控制台任务（在 USB 驱动安装之后调用）
+void ups_console_start(void);
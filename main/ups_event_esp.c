@@ -0,0 +1,106 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "sdkconfig.h"
+#include "ups_port.h"
+#include "ups_event.h"
+#include "ups_state.h"
+#include "ups_event_esp.h"
+#include "ups_power_esp.h"
+
+// 句柄写入前的唤醒会丢掉（ADC、存储任务和 USB 回调在状态任务启动前就可能投递），
+// 这些事件位仍留在集合中。ups_event_post 只在集合由空变非空时唤醒，
+// 所以状态任务必须先取事件、集合为空时才阻塞，否则启动前的事件会让它永远等不到唤醒
+static TaskHandle_t volatile state_task_handle;
+static esp_timer_handle_t tick_timer;
+
+void ups_port_event_wake(void) {
+    TaskHandle_t task = state_task_handle;
+    if (task == NULL) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(task);
+    }
+}
+
+bool ups_port_ac_sense(bool* present) {
+#if CONFIG_UPS_AC_SENSE_GPIO >= 0
+#if CONFIG_UPS_AC_SENSE_ACTIVE_LOW
+    *present = gpio_get_level(CONFIG_UPS_AC_SENSE_GPIO) == 0;
+#else
+    *present = gpio_get_level(CONFIG_UPS_AC_SENSE_GPIO) != 0;
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 周期定时器按启动时刻的整数倍到期，回调时刻与预定时刻之差即唤醒延迟（light sleep 退出加调度）
+static int64_t tick_due;
+
+static void tick_cb(void* arg) {
+    int64_t now = esp_timer_get_time();
+    ups_power_timer_fired(now > tick_due ? (uint32_t)(now - tick_due) : 0);
+    tick_due += (int64_t)UPS_STATE_PUBLISH_MS * 1000;
+    ups_event_post(UPS_EVENT_TICK);
+}
+
+#if CONFIG_UPS_AC_SENSE_GPIO >= 0 || CONFIG_UPS_BUTTON_GPIO >= 0
+// GPIO 中断服务不带 ESP_INTR_FLAG_IRAM，闪存操作期间推迟执行，可以调用闪存中的代码
+static void gpio_isr(void* arg) {
+    ups_event_post((ups_event_t)(uintptr_t)arg);
+}
+
+static void event_gpio_config(int gpio, gpio_int_type_t type, ups_event_t event) {
+    const gpio_config_t config = {
+        .pin_bit_mask = 1ULL << gpio,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .intr_type = type,
+    };
+    ESP_ERROR_CHECK(gpio_config(&config));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(gpio, gpio_isr, (void*)(uintptr_t)event));
+}
+#endif
+
+// 状态任务：空闲时无限期阻塞，没有轮询周期
+static void state_task(void* arg) {
+    state_task_handle = xTaskGetCurrentTaskHandle();
+    ups_event_post(UPS_EVENT_TICK);     // 启动后立即发布一次
+    while (1) {
+        uint32_t events = ups_event_take();
+        if (events == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        ups_state_dispatch(events);
+    }
+}
+
+void ups_event_start(void) {
+    const esp_timer_create_args_t tick_args = { .callback = tick_cb, .name = "ups_tick" };
+    ESP_ERROR_CHECK(esp_timer_create(&tick_args, &tick_timer));
+    tick_due = esp_timer_get_time() + (int64_t)UPS_STATE_PUBLISH_MS * 1000;
+    ESP_ERROR_CHECK(esp_timer_start_periodic(tick_timer, (uint64_t)UPS_STATE_PUBLISH_MS * 1000));
+
+#if CONFIG_UPS_AC_SENSE_GPIO >= 0 || CONFIG_UPS_BUTTON_GPIO >= 0
+    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+#endif
+#if CONFIG_UPS_AC_SENSE_GPIO >= 0
+    event_gpio_config(CONFIG_UPS_AC_SENSE_GPIO, GPIO_INTR_ANYEDGE, UPS_EVENT_AC_GPIO);
+#endif
+#if CONFIG_UPS_BUTTON_GPIO >= 0
+    event_gpio_config(CONFIG_UPS_BUTTON_GPIO, GPIO_INTR_NEGEDGE, UPS_EVENT_BUTTON);
+#endif
+
+    // 优先级低于 ADC 和 TinyUSB 任务（5），高于控制台和日志任务，CDC 满负载时不推迟发布
+    xTaskCreatePinnedToCore(state_task, "ups_state", 4096, NULL, 4, NULL, 0);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// 事件驱动的状态任务（ups_event.h）：周期定时器、市电检测输入和 BOOT 按键的 GPIO 中断投递事件，
+// 状态任务无限期阻塞等待，被唤醒后交给 ups_state_dispatch() 处理
+
+// 配置事件源并创建状态任务（其他模块初始化之后调用，之前投递的事件在任务启动时处理）
+void ups_event_start(void);
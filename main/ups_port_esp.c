@@ -0,0 +1,116 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "tusb.h"
+#include "ups_port.h"
+#include "ups_instance.h"
+#include "ups_shutdown.h"
+#include "ups_power_esp.h"
+
+// ups_core 平台接口的 ESP-IDF/TinyUSB 实现
+
+uint32_t ups_port_millis(void) {
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+uint32_t ups_port_micros(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+uint32_t ups_port_cycles(void) {
+    return esp_cpu_get_cycle_count();
+}
+
+uint32_t ups_port_cycles_per_us(void) {
+    return esp_rom_get_cpu_ticks_per_us();
+}
+
+const char* ups_port_cycles_unit(void) {
+    return "cycles";
+}
+
+bool ups_port_hid_mounted(void) {
+    return tud_mounted();
+}
+
+bool ups_port_hid_ready(void) {
+    return tud_hid_ready();
+}
+
+bool ups_port_hid_send(uint8_t report_id, const void* data, uint16_t len) {
+    return tud_hid_report(report_id, data, len);
+}
+
+// 先恢复总线时钟再发出恢复信号（K 态 1~15ms）；主机未允许远程唤醒时 TinyUSB 不发出
+bool ups_port_hid_remote_wakeup(void) {
+    if (!tud_suspended()) {
+        return false;
+    }
+    ups_power_resume();
+    return tud_remote_wakeup();
+}
+
+// 各实例的负载输出引脚，-1 为没有输出控制（只更新状态位）
+#ifndef CONFIG_UPS_OUTPUT1_GPIO
+#define CONFIG_UPS_OUTPUT1_GPIO -1
+#endif
+#ifndef CONFIG_UPS_OUTPUT2_GPIO
+#define CONFIG_UPS_OUTPUT2_GPIO -1
+#endif
+#ifndef CONFIG_UPS_OUTPUT3_GPIO
+#define CONFIG_UPS_OUTPUT3_GPIO -1
+#endif
+
+static const int8_t output_gpio[UPS_INSTANCE_MAX] = {
+    CONFIG_UPS_OUTPUT_GPIO, CONFIG_UPS_OUTPUT1_GPIO, CONFIG_UPS_OUTPUT2_GPIO, CONFIG_UPS_OUTPUT3_GPIO,
+};
+
+void ups_port_output_set(uint8_t instance, bool on) {
+    static bool configured[UPS_INSTANCE_COUNT];
+    int gpio = output_gpio[instance];
+
+    if (gpio < 0) {
+        return;
+    }
+    if (!configured[instance]) {
+        gpio_reset_pin(gpio);
+        gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+        configured[instance] = true;
+    }
+#if CONFIG_UPS_OUTPUT_ACTIVE_LOW
+    gpio_set_level(gpio, !on);
+#else
+    gpio_set_level(gpio, on);
+#endif
+}
+
+// 关机编排定时器：两个 esp_timer 都在 esp_timer 任务中回调，彼此串行。
+// 第一次调用来自 ups_shutdown_init()（app_main，其他任务启动前），在这里创建
+static esp_timer_handle_t shutdown_timer;
+static esp_timer_handle_t shutdown_kick_timer;
+
+static void shutdown_timer_cb(void* arg) {
+    ups_shutdown_timer();
+}
+
+void ups_port_shutdown_timer(uint32_t delay_ms) {
+    if (shutdown_timer == NULL) {
+        const esp_timer_create_args_t timer_args = { .callback = shutdown_timer_cb, .name = "ups_shutdown" };
+        const esp_timer_create_args_t kick_args = { .callback = shutdown_timer_cb, .name = "ups_shutdown_kick" };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &shutdown_timer));
+        ESP_ERROR_CHECK(esp_timer_create(&kick_args, &shutdown_kick_timer));
+    }
+    esp_timer_stop(shutdown_timer);
+    if (delay_ms != UINT32_MAX) {
+        esp_timer_start_once(shutdown_timer, (uint64_t)delay_ms * 1000);
+    }
+}
+
+// 已经在排队时 start_once 返回 ESP_ERR_INVALID_STATE，回调本来就会运行
+void ups_port_shutdown_kick(void) {
+    esp_timer_start_once(shutdown_kick_timer, 0);
+}
@@ -0,0 +1,146 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "sdkconfig.h"
+#include "ups_port.h"
+#include "ups_power_esp.h"
+
+#if CONFIG_PM_ENABLE
+
+static const char *TAG = "UPS_PM";
+
+#if CONFIG_UPS_PM_SUSPEND_LIGHT_SLEEP
+#define POWER_LIGHT_SLEEP true
+#else
+#define POWER_LIGHT_SLEEP false
+#endif
+
+// 总线活动期间持有：USB 控制器要求 APB 保持最高频率，同时阻止 light sleep。
+// ADC 连续转换驱动运行时也持有同类锁，启用 ADC 采集时挂起期间只降频、不进入 light sleep
+static esp_pm_lock_handle_t usb_lock;
+static portMUX_TYPE power_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// TinyUSB 任务和状态任务（远程唤醒前）在 power_mux 中修改
+static bool suspended;
+static int64_t suspended_at;
+static uint32_t suspends;
+static uint64_t suspended_us;
+
+// light sleep 退出回调（IRAM，中断关闭）累加
+static volatile uint64_t sleep_us;
+static volatile uint32_t sleeps;
+
+// esp_timer 任务写入
+static uint32_t wakes;
+static uint32_t wake_max_us;
+static uint64_t wake_total_us;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static esp_err_t IRAM_ATTR sleep_exit_cb(int64_t slept_us, void* arg) {
+    sleep_us += (uint64_t)slept_us;
+    sleeps++;
+    return ESP_OK;
+}
+#endif
+
+void ups_power_start(void) {
+    const esp_pm_config_t config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_UPS_PM_MIN_FREQ_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP,
+    };
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "ups_usb", &usb_lock));
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(usb_lock));
+    ESP_ERROR_CHECK(esp_pm_configure(&config));
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t callbacks = {
+        .exit_cb = sleep_exit_cb,
+    };
+    ESP_ERROR_CHECK(esp_pm_light_sleep_register_cbs(&callbacks));
+#endif
+#if CONFIG_UPS_PM_SUSPEND_LIGHT_SLEEP && CONFIG_UPS_PM_USB_RESUME_GPIO >= 0
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+#endif
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep while suspended: %s", CONFIG_UPS_PM_MIN_FREQ_MHZ,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, POWER_LIGHT_SLEEP ? "on" : "off");
+}
+
+// 挂起期间总线为 J 态（D+ 高），主机恢复时先发 K 态（D+ 低）至少 20ms，用低电平唤醒
+void ups_power_suspend(void) {
+    taskENTER_CRITICAL(&power_mux);
+    if (!suspended) {
+        suspended = true;
+        suspends++;
+        suspended_at = esp_timer_get_time();
+#if CONFIG_UPS_PM_SUSPEND_LIGHT_SLEEP && CONFIG_UPS_PM_USB_RESUME_GPIO >= 0
+        gpio_wakeup_enable(CONFIG_UPS_PM_USB_RESUME_GPIO, GPIO_INTR_LOW_LEVEL);
+#endif
+        esp_pm_lock_release(usb_lock);
+    }
+    taskEXIT_CRITICAL(&power_mux);
+}
+
+void ups_power_resume(void) {
+    taskENTER_CRITICAL(&power_mux);
+    if (suspended) {
+        esp_pm_lock_acquire(usb_lock);
+#if CONFIG_UPS_PM_SUSPEND_LIGHT_SLEEP && CONFIG_UPS_PM_USB_RESUME_GPIO >= 0
+        gpio_wakeup_disable(CONFIG_UPS_PM_USB_RESUME_GPIO);
+#endif
+        suspended_us += (uint64_t)(esp_timer_get_time() - suspended_at);
+        suspended = false;
+    }
+    taskEXIT_CRITICAL(&power_mux);
+}
+
+void ups_power_timer_fired(uint32_t late_us) {
+    if (!suspended) {
+        return;
+    }
+    wakes++;
+    wake_total_us += late_us;
+    if (late_us > wake_max_us) {
+        wake_max_us = late_us;
+    }
+}
+
+// 统计由控制台任务读取，允许读到不一致的中间值
+bool ups_port_power(ups_port_power_t* power) {
+    power->cpu_max_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    power->cpu_min_mhz = CONFIG_UPS_PM_MIN_FREQ_MHZ;
+    power->light_sleep = POWER_LIGHT_SLEEP;
+    power->suspended = suspended;
+    power->suspends = suspends;
+    power->suspended_us = suspended_us + (suspended ? (uint64_t)(esp_timer_get_time() - suspended_at) : 0);
+    power->sleep_us = sleep_us;
+    power->sleeps = sleeps;
+    power->wakes = wakes;
+    power->wake_max_us = wake_max_us;
+    power->wake_total_us = wake_total_us;
+    return true;
+}
+
+#else
+
+void ups_power_start(void) {
+}
+
+void ups_power_suspend(void) {
+}
+
+void ups_power_resume(void) {
+}
+
+void ups_power_timer_fired(uint32_t late_us) {
+}
+
+bool ups_port_power(ups_port_power_t* power) {
+    return false;
+}
+
+#endif
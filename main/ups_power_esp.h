@@ -0,0 +1,17 @@
+#pragma once
+
+// 电源管理：总线活动时动态调频（USB 需要 APB 保持最高频率），总线挂起后释放电源锁，
+// 空闲时由 tickless idle 自动进入 light sleep，定时器、主机恢复信号（USB D+）唤醒。
+// 没有启用 CONFIG_PM_ENABLE 时全部为空操作
+
+#include <stdint.h>
+
+// 配置调频范围并持有总线活动锁（在 USB 驱动安装之前调用）
+void ups_power_start(void);
+
+// 总线挂起/恢复（TinyUSB 回调、枚举/断开和远程唤醒前调用，可重复调用）
+void ups_power_suspend(void);
+void ups_power_resume(void);
+
+// 周期定时器回调相对预定时刻的延迟，挂起期间计入唤醒延迟
+void ups_power_timer_fired(uint32_t late_us);
@@ -0,0 +1,146 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_partition.h"
+#include "ups_port.h"
+#include "ups_store.h"
+#include "ups_journal.h"
+#include "ups_boot.h"
+#include "ups_store_esp.h"
+
+static const char *TAG = "UPS_STORE";
+
+#define STORE_NAMESPACE "ups"
+#define STORE_KEY       "battery"
+
+// 事件日志分区（partitions.csv）
+#define JOURNAL_PARTITION_LABEL   "journal"
+#define JOURNAL_PARTITION_SUBTYPE 0x40
+
+static TaskHandle_t store_task_handle;
+static const esp_partition_t* journal_partition;
+static const uint8_t* journal_mapped;       // 分区映射到数据地址空间，读取不经过 SPI 闪存驱动
+
+// 挂载扫描和遥测导出（其他任务）都从映射区直接读取；
+// 擦写后 IDF 会使映射区对应的 cache 失效，读到的总是闪存当前内容
+static bool journal_read(uint32_t offset, void* buffer, uint32_t len) {
+    if (journal_mapped != NULL) {
+        memcpy(buffer, journal_mapped + offset, len);
+        return true;
+    }
+    return esp_partition_read(journal_partition, offset, buffer, len) == ESP_OK;
+}
+
+static bool journal_write(uint32_t offset, const void* data, uint32_t len) {
+    return esp_partition_write(journal_partition, offset, data, len) == ESP_OK;
+}
+
+static bool journal_erase(uint32_t offset) {
+    return esp_partition_erase_range(journal_partition, offset, UPS_JOURNAL_SECTOR_SIZE) == ESP_OK;
+}
+
+static ups_journal_flash_t journal_flash = {
+    .read = journal_read,
+    .write = journal_write,
+    .erase_sector = journal_erase,
+};
+
+static void journal_mount(void) {
+    journal_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                 (esp_partition_subtype_t)JOURNAL_PARTITION_SUBTYPE,
+                                                 JOURNAL_PARTITION_LABEL);
+    if (journal_partition == NULL) {
+        ESP_LOGW(TAG, "No journal partition, power events are not recorded");
+        return;
+    }
+    const void* mapped;
+    esp_partition_mmap_handle_t mmap_handle;
+    if (esp_partition_mmap(journal_partition, 0, journal_partition->size, ESP_PARTITION_MMAP_DATA,
+                           &mapped, &mmap_handle) == ESP_OK) {
+        journal_mapped = mapped;
+    } else {
+        ESP_LOGW(TAG, "Journal mmap failed, reading through flash driver");
+    }
+    journal_flash.size = journal_partition->size;
+    if (!ups_journal_mount(&journal_flash)) {
+        ESP_LOGE(TAG, "Journal mount failed");
+    }
+}
+
+// ups_store 暂存新快照、ups_journal 有新事件时调用（状态任务），只发通知
+void ups_port_store_kick(void) {
+    if (store_task_handle != NULL) {
+        xTaskNotifyGive(store_task_handle);
+    }
+}
+
+static void store_load(nvs_handle_t nvs) {
+    ups_store_data_t data;
+    size_t len = sizeof(data);
+    esp_err_t ret = nvs_get_blob(nvs, STORE_KEY, &data, &len);
+
+    if (ret == ESP_OK && len == sizeof(data)) {
+        ups_store_loaded(&data);
+    } else {
+        if (ret != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Stored data unreadable (%s, %u bytes)", esp_err_to_name(ret), (unsigned)len);
+        }
+        ups_store_loaded(NULL);
+    }
+}
+
+// 写入任务：先把排队的电源事件追加到事件日志，再写最新的学习参数快照
+// （写入期间新暂存的快照合并到下一次）。闪存擦写期间 cache 关闭，本任务优先级低，只在有数据时运行
+static void store_task(void* arg) {
+    // NVS初始化：版本不匹配时擦除可能需要数百毫秒，不能挡住USB枚举
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+    ups_boot_mark(UPS_BOOT_NVS_READY);
+
+    // NVS打不开时不加载也不保存学习参数，事件日志照常写入
+    nvs_handle_t nvs;
+    ret = nvs_open(STORE_NAMESPACE, NVS_READWRITE, &nvs);
+    bool nvs_ok = ret == ESP_OK;
+    if (nvs_ok) {
+        store_load(nvs);
+    } else {
+        ESP_LOGE(TAG, "nvs_open failed: %s", esp_err_to_name(ret));
+    }
+    journal_mount();
+
+    while (1) {
+        // 启动前排队的事件（上电记录）在第一次循环写入
+        if (!ups_journal_flush() && ups_journal_next_seq() != 0) {
+            ESP_LOGW(TAG, "Journal append failed");
+        }
+
+        ups_store_data_t data;
+        uint32_t seq;
+        while (nvs_ok && ups_store_pending(&data, &seq)) {
+            ret = nvs_set_blob(nvs, STORE_KEY, &data, sizeof(data));
+            if (ret == ESP_OK) {
+                ret = nvs_commit(nvs);
+            }
+            ups_store_done(seq, ret == ESP_OK);
+            if (ret == ESP_OK) {
+                ESP_LOGI(TAG, "Saved: %u mAh, %u cycles, %u mOhm (commit %u)", (unsigned)data.full_charge_mah,
+                         data.cycle_count, data.resistance_mohm, (unsigned)ups_store_commits());
+            } else {
+                ESP_LOGW(TAG, "Save failed: %s", esp_err_to_name(ret));
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void ups_store_start(void) {
+    xTaskCreate(store_task, "ups_store", 3072, NULL, tskIDLE_PRIORITY + 2, &store_task_handle);
+}
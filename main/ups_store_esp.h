@@ -0,0 +1,7 @@
+#pragma once
+
+// 闪存持久化后端：后台任务初始化NVS、加载学习参数，写入 ups_store 暂存的快照，
+// 并把 ups_journal 排队的电源事件追加到 journal 分区
+
+// 创建后台任务（NVS初始化也在其中，不挡住USB枚举）
+void ups_store_start(void);